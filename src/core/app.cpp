@@ -1,4 +1,5 @@
 #include "core/app.h"
+#include "core/snapshot.h"
 
 #include "modules/agent_behavoir.h"
 #include "modules/scenario_runner.h"
@@ -6,14 +7,34 @@
 #include "modules/world_port.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <optional>
 
 namespace ecosim {
 
+namespace {
+std::optional<BufferPolicy::Overflow> parseOverflow(const std::string &value) {
+    if (value == "flush-early") {
+        return BufferPolicy::Overflow::FlushEarly;
+    }
+    if (value == "drop-oldest") {
+        return BufferPolicy::Overflow::DropOldest;
+    }
+    if (value == "drop-newest") {
+        return BufferPolicy::Overflow::DropNewest;
+    }
+    if (value == "coalesce") {
+        return BufferPolicy::Overflow::Coalesce;
+    }
+    return std::nullopt;
+}
+} // namespace
+
 Application::Application(Logger &logger)
-    : logger_(logger), context_(logger_, event_bus_, app_config_), module_manager_(registry_, context_) {}
+    : logger_(logger), context_(logger_, event_bus_, app_config_, workers_, tick_arena_), module_manager_(registry_, context_) {}
 
 bool Application::initialize(const std::string &config_path) {
     logger_.log(LogChannel::System, "Loading app config: " + config_path);
@@ -31,6 +52,17 @@ bool Application::initialize(const std::string &config_path) {
             app_config_.output_dir = (config_dir / app_config_.output_dir).string();
         }
     }
+    if (std::filesystem::path(app_config_.checkpoint_dir).is_relative()) {
+        app_config_.checkpoint_dir = (std::filesystem::path(app_config_.output_dir) / app_config_.checkpoint_dir).string();
+    }
+
+    auto worker_threads = app_config_.worker_threads > 0 ? static_cast<std::size_t>(app_config_.worker_threads)
+                                                         : ThreadPool::defaultConcurrency();
+    workers_.start(worker_threads);
+    event_bus_.setDispatchPool(&workers_);
+    if (!configureEventBuffers()) {
+        return false;
+    }
 
     logger_.log(LogChannel::System, "Loading manifests from: " + app_config_.modules_dir);
     registry_.loadManifests(app_config_.modules_dir);
@@ -58,6 +90,9 @@ bool Application::initialize(const std::string &config_path) {
         scenario->setAvailableModules(types);
         scenario->setWorld(world);
     }
+    if (auto behavior = dynamic_cast<AgentBehavoir *>(module_manager_.findModule("agent_behavoir"))) {
+        behavior->setWorld(world);
+    }
 
     registerCoreCommands();
     return true;
@@ -81,21 +116,22 @@ void Application::runHeadless() {
     }
 
     int max_ticks = app_config_.max_ticks.value_or(1000);
-    for (int tick = 0; running_; ++tick) {
-        for (auto module : module_manager_.modules()) {
-            module->onPreTick();
-        }
-        for (auto module : module_manager_.modules()) {
-            module->onTick();
-        }
-        for (auto module : module_manager_.modules()) {
-            module->onPostTick();
-        }
-        event_bus_.deliverBuffered();
-        for (auto module : module_manager_.modules()) {
-            module->onDeliverBufferedEvents();
-        }
+    int first_tick = resume_tick_;
+    resume_tick_ = 0;
+    if (first_tick > 0 && world->shouldStop()) {
+        logger_.log(LogChannel::System, "Stop condition already reached at tick " + std::to_string(first_tick));
+        running_ = false;
+    }
+    for (int tick = first_tick; running_; ++tick) {
+        runPhase(&IModule::onPreTick);
+        runPhase(&IModule::onTick);
+        runPhase(&IModule::onPostTick);
+        deliverEvents();
+        tick_arena_.nextTick();
 
+        if (app_config_.checkpoint_interval > 0 && world->readModel().tick % app_config_.checkpoint_interval == 0) {
+            writeCheckpoint(world->readModel().tick);
+        }
         if (world->shouldStop()) {
             logger_.log(LogChannel::System, "Stop condition reached at tick " + std::to_string(world->readModel().tick));
             running_ = false;
@@ -105,6 +141,132 @@ void Application::runHeadless() {
             running_ = false;
         }
     }
+    logEventStats();
+}
+
+bool Application::saveSnapshot(const std::string &path) {
+    SnapshotWriter writer;
+    for (auto module : module_manager_.modules()) {
+        if (auto snapshotable = dynamic_cast<const ISnapshotable *>(module)) {
+            snapshotable->saveSnapshot(writer);
+        }
+    }
+    std::string error;
+    if (!writer.write(path, error)) {
+        logger_.log(LogChannel::System, "Snapshot failed: " + error);
+        return false;
+    }
+    return true;
+}
+
+bool Application::restoreSnapshot(const std::string &path) {
+    auto world = dynamic_cast<IWorldPort *>(module_manager_.findModule("simulation_world"));
+    SnapshotReader reader;
+    std::string error;
+    if (!world || !reader.open(path, error)) {
+        logger_.log(LogChannel::System, "Cannot resume from " + path + ": " +
+                                            (world ? error : "simulation_world module is required"));
+        return false;
+    }
+    // Dependency order, not config order: simulation_world is restored before the modules depending on
+    // it, whose restore may read its tables.
+    for (auto module : module_manager_.startedModules()) {
+        auto snapshotable = dynamic_cast<ISnapshotable *>(module);
+        if (snapshotable && !snapshotable->restoreSnapshot(reader, error)) {
+            logger_.log(LogChannel::System, "Cannot resume from " + path + ": " + module->typeId() + ": " + error);
+            return false;
+        }
+    }
+    resume_tick_ = world->readModel().tick;
+    logger_.log(LogChannel::System, "Resumed from " + path + " at tick " + std::to_string(resume_tick_));
+    return true;
+}
+
+// Called at a tick boundary, after buffered events were delivered, so no module holds in-flight work.
+void Application::writeCheckpoint(int tick) {
+    std::error_code ignored;
+    std::filesystem::create_directories(app_config_.checkpoint_dir, ignored);
+    char name[32];
+    std::snprintf(name, sizeof(name), "checkpoint_%09d.ecsnap", tick);
+    auto path = (std::filesystem::path(app_config_.checkpoint_dir) / name).string();
+    if (!saveSnapshot(path)) {
+        return;
+    }
+    logger_.log(LogChannel::System, "Checkpoint written: " + path);
+    checkpoints_.push_back(path);
+    while (app_config_.checkpoint_keep > 0 && checkpoints_.size() > static_cast<std::size_t>(app_config_.checkpoint_keep)) {
+        std::filesystem::remove(checkpoints_.front(), ignored);
+        checkpoints_.pop_front();
+    }
+}
+
+bool Application::configureEventBuffers() {
+    for (const auto &buffer : app_config_.event_buffers) {
+        auto overflow = parseOverflow(buffer.overflow);
+        if (!overflow) {
+            logger_.log(LogChannel::System, "Unknown overflow policy for " + buffer.event_type + ": " + buffer.overflow);
+            return false;
+        }
+        if (*overflow == BufferPolicy::Overflow::Coalesce && buffer.key.empty()) {
+            logger_.log(LogChannel::System, "Coalescing buffer for " + buffer.event_type + " requires a key field");
+            return false;
+        }
+        BufferPolicy policy;
+        policy.capacity = buffer.capacity;
+        policy.overflow = *overflow;
+        if (!buffer.key.empty()) {
+            policy.coalesce_key = event_bus_.fieldId(buffer.key);
+        }
+        event_bus_.setBufferPolicy(event_bus_.typeId(buffer.event_type), policy);
+    }
+    return true;
+}
+
+void Application::logEventStats() {
+    const auto &stats = event_bus_.stats();
+    logger_.log(LogChannel::System, "Events: emitted " + std::to_string(stats.emitted) + ", delivered " +
+                                        std::to_string(stats.delivered) + ", dropped " +
+                                        std::to_string(stats.dropped) + ", coalesced " +
+                                        std::to_string(stats.coalesced) + ", early flushes " +
+                                        std::to_string(stats.early_flushes) + ", peak buffered " +
+                                        std::to_string(stats.peak_buffered));
+}
+
+// Reads the published snapshot rather than the live model, so it is consistent whatever the
+// simulation thread is doing.
+void Application::logWorldStats() {
+    auto world = dynamic_cast<IWorldPort *>(module_manager_.findModule("simulation_world"));
+    auto snapshot = world ? world->snapshot() : ReadModelSnapshot();
+    if (!snapshot) {
+        logger_.log(LogChannel::System, "world.stats: no world state published yet");
+        return;
+    }
+    char line[160];
+    std::snprintf(line, sizeof(line), "world v%llu: tick %d, agents %zu, energy %.3f (min %.3f, max %.3f)",
+                  static_cast<unsigned long long>(snapshot.version()), snapshot->tick, snapshot->agent_count,
+                  snapshot->energy_sum, snapshot->energy_min, snapshot->energy_max);
+    logger_.log(LogChannel::System, line);
+    for (std::size_t id = 0; id < snapshot->population.size(); ++id) {
+        logger_.log(LogChannel::System, "  " + snapshot->species.name(static_cast<SpeciesId>(id)) + ": " +
+                                            std::to_string(snapshot->population[id]));
+    }
+}
+
+void Application::runPhase(void (IModule::*phase)()) {
+    const auto &modules = module_manager_.modules();
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        event_bus_.setCurrentProducer(static_cast<std::uint32_t>(i));
+        (modules[i]->*phase)();
+    }
+    event_bus_.setCurrentProducer(0);
+    if (phase != &IModule::onDeliverBufferedEvents && event_bus_.flushRequested()) {
+        deliverEvents();
+    }
+}
+
+void Application::deliverEvents() {
+    event_bus_.deliverBuffered();
+    runPhase(&IModule::onDeliverBufferedEvents);
 }
 
 void Application::runConsoleLoop() {
@@ -156,6 +318,12 @@ void Application::registerCoreCommands() {
     console_.registerCommand("sim.resume", [this](const std::vector<std::string> &) {
         logger_.log(LogChannel::System, "sim.resume is a no-op in headless MVP");
     });
+    console_.registerCommand("bus.stats", [this](const std::vector<std::string> &) {
+        logEventStats();
+    });
+    console_.registerCommand("world.stats", [this](const std::vector<std::string> &) {
+        logWorldStats();
+    });
     console_.registerCommand("sys.quit", [this](const std::vector<std::string> &) {
         running_ = false;
         console_running_ = false;
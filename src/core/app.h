@@ -6,7 +6,10 @@
 #include "core/logger.h"
 #include "core/module_manager.h"
 #include "core/module_registry.h"
+#include "core/thread_pool.h"
+#include "core/tick_arena.h"
 
+#include <deque>
 #include <string>
 
 namespace ecosim {
@@ -21,22 +24,39 @@ public:
     void runConsoleLoop();
     void shutdown();
 
+    // Snapshot of every module implementing ISnapshotable. Restore after startModules(); the next
+    // runHeadless() continues from the restored tick.
+    bool saveSnapshot(const std::string &path);
+    bool restoreSnapshot(const std::string &path);
+
     ModuleManager &moduleManager() { return module_manager_; }
     ModuleRegistry &registry() { return registry_; }
     EventBus &eventBus() { return event_bus_; }
     const AppConfig &config() const { return app_config_; }
     Console &console() { return console_; }
+    TickArena &tickArena() { return tick_arena_; }
 
 private:
     void registerCoreCommands();
+    // Delivers a flush requested by a FlushEarly buffer once every module has finished the phase.
+    void runPhase(void (IModule::*phase)());
+    void deliverEvents();
+    bool configureEventBuffers();
+    void logEventStats();
+    void logWorldStats();
+    void writeCheckpoint(int tick);
 
     Logger &logger_;
+    ModuleRegistry registry_;
+    ThreadPool workers_;
+    TickArena tick_arena_;
     EventBus event_bus_;
     AppConfig app_config_;
-    ModuleRegistry registry_;
     ModuleContext context_;
     ModuleManager module_manager_;
     Console console_;
+    std::deque<std::string> checkpoints_;
+    int resume_tick_ = 0;
     bool running_ = false;
     bool console_running_ = false;
 };
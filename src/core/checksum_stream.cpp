@@ -0,0 +1,140 @@
+#include "core/checksum_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ecosim {
+
+namespace {
+const char kMagic[8] = {'E', 'C', 'S', 'U', 'M', 'v', '1', '\0'};
+
+void putLe(unsigned char *out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+std::uint64_t getLe(const unsigned char *in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+bool readBytes(std::ifstream &file, unsigned char *out, std::size_t size) {
+    file.read(reinterpret_cast<char *>(out), static_cast<std::streamsize>(size));
+    return static_cast<std::size_t>(file.gcount()) == size;
+}
+} // namespace
+
+bool ChecksumStreamWriter::open(const std::string &path, const std::vector<std::string> &subsystems) {
+    file_.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file_.is_open()) {
+        return false;
+    }
+    subsystems_ = subsystems.size();
+    record_.assign(8 + 8 * subsystems_, 0);
+    unsigned char count[4];
+    putLe(count, subsystems_, 4);
+    file_.write(kMagic, sizeof(kMagic));
+    file_.write(reinterpret_cast<const char *>(count), sizeof(count));
+    for (const auto &name : subsystems) {
+        auto length = static_cast<unsigned char>(std::min<std::size_t>(name.size(), 255));
+        file_.put(static_cast<char>(length));
+        file_.write(name.data(), length);
+    }
+    return true;
+}
+
+void ChecksumStreamWriter::write(std::uint64_t tick, const std::uint64_t *digests) {
+    if (!file_.is_open()) {
+        return;
+    }
+    putLe(record_.data(), tick, 8);
+    for (std::size_t i = 0; i < subsystems_; ++i) {
+        putLe(record_.data() + 8 + 8 * i, digests[i], 8);
+    }
+    file_.write(reinterpret_cast<const char *>(record_.data()), static_cast<std::streamsize>(record_.size()));
+}
+
+void ChecksumStreamWriter::close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+bool readChecksumStream(const std::string &path, ChecksumStream &out, std::string &error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    unsigned char header[12];
+    if (!readBytes(file, header, sizeof(header)) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a checksum stream";
+        return false;
+    }
+    out = ChecksumStream();
+    auto count = static_cast<std::size_t>(getLe(header + 8, 4));
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned char length = 0;
+        std::string name;
+        if (!readBytes(file, &length, 1)) {
+            error = path + ": truncated header";
+            return false;
+        }
+        name.resize(length);
+        if (!readBytes(file, reinterpret_cast<unsigned char *>(&name[0]), length)) {
+            error = path + ": truncated header";
+            return false;
+        }
+        out.subsystems.push_back(std::move(name));
+    }
+    std::vector<unsigned char> record(8 + 8 * count);
+    while (readBytes(file, record.data(), record.size())) {
+        out.ticks.push_back(getLe(record.data(), 8));
+        for (std::size_t i = 0; i < count; ++i) {
+            out.digests.push_back(getLe(record.data() + 8 + 8 * i, 8));
+        }
+    }
+    return true;
+}
+
+ChecksumDiff diffChecksumStreams(const ChecksumStream &left, const ChecksumStream &right) {
+    ChecksumDiff diff;
+    if (left.subsystems != right.subsystems) {
+        diff.diverged = true;
+        diff.note = "streams record different subsystems";
+        return diff;
+    }
+    const std::size_t width = left.subsystems.size();
+    const std::size_t rows = std::min(left.ticks.size(), right.ticks.size());
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (left.ticks[row] != right.ticks[row]) {
+            diff.diverged = true;
+            diff.tick = std::min(left.ticks[row], right.ticks[row]);
+            diff.note = "tick sequences differ";
+            return diff;
+        }
+        for (std::size_t i = 0; i < width; ++i) {
+            if (left.digests[row * width + i] != right.digests[row * width + i]) {
+                diff.subsystems.push_back(left.subsystems[i]);
+            }
+        }
+        if (!diff.subsystems.empty()) {
+            diff.diverged = true;
+            diff.tick = left.ticks[row];
+            return diff;
+        }
+    }
+    if (left.ticks.size() != right.ticks.size()) {
+        diff.diverged = true;
+        const auto &longer = left.ticks.size() > right.ticks.size() ? left : right;
+        diff.tick = longer.ticks[rows];
+        diff.note = "one stream ends before the other";
+    }
+    return diff;
+}
+
+} // namespace ecosim
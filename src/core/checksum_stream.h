@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ecosim {
+
+// Binary per-tick checksum stream:
+//   header  "ECSUMv1\0", u32 subsystem count, then per subsystem u8 name length + name bytes;
+//   records u64 tick followed by one u64 digest per subsystem, all little-endian.
+class ChecksumStreamWriter {
+public:
+    bool open(const std::string &path, const std::vector<std::string> &subsystems);
+    bool isOpen() const { return file_.is_open(); }
+    // `digests` holds one value per subsystem, in header order.
+    void write(std::uint64_t tick, const std::uint64_t *digests);
+    void close();
+
+private:
+    std::ofstream file_;
+    std::size_t subsystems_ = 0;
+    std::vector<unsigned char> record_;
+};
+
+struct ChecksumStream {
+    std::vector<std::string> subsystems;
+    std::vector<std::uint64_t> ticks;
+    // ticks.size() rows of subsystems.size() digests.
+    std::vector<std::uint64_t> digests;
+};
+
+bool readChecksumStream(const std::string &path, ChecksumStream &out, std::string &error);
+
+struct ChecksumDiff {
+    bool diverged = false;
+    std::uint64_t tick = 0;
+    // Subsystems that differ at `tick`, in stream order; the first is the earliest in the world update.
+    std::vector<std::string> subsystems;
+    // Set when the streams cannot be compared or one ends before the other.
+    std::string note;
+};
+
+ChecksumDiff diffChecksumStreams(const ChecksumStream &left, const ChecksumStream &right);
+
+} // namespace ecosim
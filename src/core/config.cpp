@@ -74,13 +74,20 @@ std::map<std::string, std::string> parseInlineMap(const std::string &input) {
         auto key = trim(content.substr(pos, key_end - pos));
         pos = key_end + 1;
         bool in_quotes = false;
+        int depth = 0;
         std::size_t value_start = pos;
         for (; pos < content.size(); ++pos) {
             char c = content[pos];
             if (c == '"') {
                 in_quotes = !in_quotes;
             }
-            if (!in_quotes && (c == ',')) {
+            if (!in_quotes && c == '{') {
+                ++depth;
+            }
+            if (!in_quotes && c == '}') {
+                --depth;
+            }
+            if (!in_quotes && depth == 0 && c == ',') {
                 break;
             }
         }
@@ -134,8 +141,20 @@ std::vector<std::map<std::string, std::string>> parseArrayOfTables(const std::st
         if (open == std::string::npos) {
             break;
         }
-        auto close = content.find('}', open);
-        if (close == std::string::npos) {
+        std::size_t close = open;
+        int depth = 0;
+        bool in_quotes = false;
+        for (; close < content.size(); ++close) {
+            char c = content[close];
+            if (c == '"') {
+                in_quotes = !in_quotes;
+            } else if (!in_quotes && c == '{') {
+                ++depth;
+            } else if (!in_quotes && c == '}' && --depth == 0) {
+                break;
+            }
+        }
+        if (close >= content.size()) {
             break;
         }
         auto table = content.substr(open, close - open + 1);
@@ -223,6 +242,41 @@ AppConfig ConfigLoader::loadAppConfig(const std::string &path) {
     if (auto value = findRawValue(content, "max_ticks")) {
         config.max_ticks = std::stoi(*value);
     }
+    if (auto value = findRawValue(content, "worker_threads")) {
+        config.worker_threads = std::stoi(*value);
+    }
+    if (auto value = findRawValue(content, "checkpoint_interval")) {
+        config.checkpoint_interval = std::stoi(*value);
+    }
+    if (auto value = findRawValue(content, "checkpoint_dir")) {
+        config.checkpoint_dir = stripQuotes(*value);
+    }
+    if (auto value = findRawValue(content, "checkpoint_keep")) {
+        config.checkpoint_keep = std::stoi(*value);
+    }
+    if (auto value = findRawValue(content, "event_buffers")) {
+        for (const auto &table : parseArrayOfTables(*value)) {
+            EventBufferConfig buffer;
+            auto type_it = table.find("type");
+            if (type_it == table.end()) {
+                continue;
+            }
+            buffer.event_type = type_it->second;
+            auto capacity_it = table.find("capacity");
+            if (capacity_it != table.end()) {
+                buffer.capacity = static_cast<std::size_t>(std::stoull(capacity_it->second));
+            }
+            auto overflow_it = table.find("overflow");
+            if (overflow_it != table.end()) {
+                buffer.overflow = overflow_it->second;
+            }
+            auto key_it = table.find("key");
+            if (key_it != table.end()) {
+                buffer.key = key_it->second;
+            }
+            config.event_buffers.push_back(buffer);
+        }
+    }
     if (auto value = findRawValue(content, "instances")) {
         auto tables = parseArrayOfTables(*value);
         for (const auto &table : tables) {
@@ -270,6 +324,9 @@ ModuleManifest ConfigLoader::loadManifest(const std::string &path) {
     if (auto value = findRawValue(content, "library")) {
         manifest.library_path = stripQuotes(*value);
     }
+    if (auto value = findRawValue(content, "thread_safe_handlers")) {
+        manifest.thread_safe_handlers = (*value == "true");
+    }
     return manifest;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <map>
 #include <optional>
 #include <string>
@@ -17,6 +18,7 @@ struct ModuleManifest {
     std::vector<std::string> dependencies;
     Criticality criticality = Criticality::Optional;
     std::string library_path;
+    bool thread_safe_handlers = false;
 };
 
 struct ModuleInstanceConfig {
@@ -26,6 +28,13 @@ struct ModuleInstanceConfig {
     std::map<std::string, std::string> params;
 };
 
+struct EventBufferConfig {
+    std::string event_type;
+    std::size_t capacity = 0;
+    std::string overflow = "flush-early";
+    std::string key;
+};
+
 struct AppConfig {
     std::string mode = "headless";
     ErrorPolicy error_policy = ErrorPolicy::FailFast;
@@ -35,6 +44,13 @@ struct AppConfig {
     std::string output_dir = "output";
     double dt = 1.0;
     std::optional<int> max_ticks;
+    int worker_threads = 0;
+    std::vector<EventBufferConfig> event_buffers;
+    // Headless runs write a snapshot every checkpoint_interval ticks (0 = off) into checkpoint_dir
+    // (relative to output_dir), keeping the newest checkpoint_keep files.
+    int checkpoint_interval = 0;
+    std::string checkpoint_dir = "checkpoints";
+    int checkpoint_keep = 2;
 };
 
 struct ScenarioConfig {
@@ -0,0 +1,39 @@
+#include "core/cpu_features.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ECOSIM_CPU_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+namespace ecosim {
+
+CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#if defined(ECOSIM_CPU_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return features;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return features;
+    }
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    features.avx2 = (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+    features.avx512 = (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0;
+#elif defined(ECOSIM_CPU_X86)
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512 = __builtin_cpu_supports("avx512f");
+#endif
+    return features;
+}
+
+} // namespace ecosim
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace ecosim {
+
+// Instruction sets usable by this process: the CPU must support them and the OS must save their
+// register state.
+struct CpuFeatures {
+    bool avx2 = false;
+    bool avx512 = false;
+};
+
+CpuFeatures detectCpuFeatures();
+
+} // namespace ecosim
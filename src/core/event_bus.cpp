@@ -1,35 +1,645 @@
 #include "core/event_bus.h"
 
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <iterator>
+
 namespace ecosim {
 
+namespace {
+bool parseNumeric(const std::string &text, EventValue &value) {
+    if (text.empty()) {
+        return false;
+    }
+    char *end = nullptr;
+    errno = 0;
+    long long as_int = std::strtoll(text.c_str(), &end, 10);
+    if (errno == 0 && end == text.c_str() + text.size()) {
+        value = EventValue::ofInt(as_int);
+        return true;
+    }
+    errno = 0;
+    double as_real = std::strtod(text.c_str(), &end);
+    if (errno == 0 && end == text.c_str() + text.size()) {
+        value = EventValue::ofReal(as_real);
+        return true;
+    }
+    return false;
+}
+
+template <typename T>
+bool compare(const T &left, FieldPredicate::Op op, const T &right) {
+    switch (op) {
+    case FieldPredicate::Op::Equal:
+        return left == right;
+    case FieldPredicate::Op::NotEqual:
+        return left != right;
+    case FieldPredicate::Op::Less:
+        return left < right;
+    case FieldPredicate::Op::LessEqual:
+        return left <= right;
+    case FieldPredicate::Op::Greater:
+        return left > right;
+    case FieldPredicate::Op::GreaterEqual:
+        return left >= right;
+    }
+    return false;
+}
+} // namespace
+
+class EventBus::Filter {
+public:
+    explicit Filter(const SubscribeOptions &options)
+        : stride_(std::max<std::uint32_t>(options.stride, 1)), where_(options.where), on_change_(options.on_change),
+          last_(on_change_.size()), last_present_(on_change_.size(), false) {}
+
+    bool accept(const TypedEvent &event) {
+        for (const auto &predicate : where_) {
+            const auto *field = event.find(predicate.field);
+            if (!field || !predicate.matches(field->value)) {
+                return false;
+            }
+        }
+        if (!on_change_.empty() && has_last_ && !changed(event)) {
+            return false;
+        }
+        if (stride_ > 1) {
+            bool take = passed_ % stride_ == 0;
+            ++passed_;
+            if (!take) {
+                return false;
+            }
+        }
+        if (!on_change_.empty()) {
+            remember(event);
+        }
+        return true;
+    }
+
+    std::vector<std::uint32_t> selection;
+
+private:
+    bool changed(const TypedEvent &event) const {
+        for (std::size_t i = 0; i < on_change_.size(); ++i) {
+            const auto *field = event.find(on_change_[i]);
+            if ((field != nullptr) != last_present_[i] || (field && field->value != last_[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void remember(const TypedEvent &event) {
+        for (std::size_t i = 0; i < on_change_.size(); ++i) {
+            const auto *field = event.find(on_change_[i]);
+            last_present_[i] = field != nullptr;
+            if (field) {
+                last_[i] = field->value;
+            }
+        }
+        has_last_ = true;
+    }
+
+    std::uint32_t stride_;
+    std::uint64_t passed_ = 0;
+    std::vector<FieldPredicate> where_;
+    std::vector<EventFieldId> on_change_;
+    std::vector<EventValue> last_;
+    std::vector<bool> last_present_;
+    bool has_last_ = false;
+};
+
+bool operator==(const EventValue &a, const EventValue &b) {
+    if (a.kind != b.kind) {
+        return false;
+    }
+    switch (a.kind) {
+    case EventValue::Kind::Int:
+        return a.int_value == b.int_value;
+    case EventValue::Kind::Real:
+        return a.real_value == b.real_value;
+    case EventValue::Kind::Species:
+        return a.species_value == b.species_value;
+    }
+    return false;
+}
+
+bool FieldPredicate::matches(const EventValue &candidate) const {
+    if (candidate.kind != EventValue::Kind::Real && value.kind != EventValue::Kind::Real) {
+        return compare(candidate.asInt(), op, value.asInt());
+    }
+    return compare(candidate.asReal(), op, value.asReal());
+}
+
+EventValue EventValue::ofInt(std::int64_t value) {
+    EventValue result;
+    result.kind = Kind::Int;
+    result.int_value = value;
+    return result;
+}
+
+EventValue EventValue::ofReal(double value) {
+    EventValue result;
+    result.kind = Kind::Real;
+    result.real_value = value;
+    return result;
+}
+
+EventValue EventValue::ofSpecies(std::uint32_t species_id) {
+    EventValue result;
+    result.kind = Kind::Species;
+    result.species_value = species_id;
+    return result;
+}
+
+std::int64_t EventValue::asInt() const {
+    switch (kind) {
+    case Kind::Int:
+        return int_value;
+    case Kind::Real:
+        return static_cast<std::int64_t>(real_value);
+    case Kind::Species:
+        return species_value;
+    }
+    return 0;
+}
+
+double EventValue::asReal() const {
+    switch (kind) {
+    case Kind::Int:
+        return static_cast<double>(int_value);
+    case Kind::Real:
+        return real_value;
+    case Kind::Species:
+        return species_value;
+    }
+    return 0.0;
+}
+
+std::string EventValue::toString() const {
+    switch (kind) {
+    case Kind::Int:
+        return std::to_string(int_value);
+    case Kind::Real:
+        return std::to_string(real_value);
+    case Kind::Species:
+        return std::to_string(species_value);
+    }
+    return "";
+}
+
+const EventField *TypedEvent::find(EventFieldId id) const {
+    for (const auto &field : fields) {
+        if (field.id == id) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+EventTypeId EventBus::typeId(const std::string &event_type) {
+    auto it = type_ids_.find(event_type);
+    if (it != type_ids_.end()) {
+        return it->second;
+    }
+    auto id = static_cast<EventTypeId>(type_names_.size());
+    type_ids_.emplace(event_type, id);
+    type_names_.push_back(event_type);
+    ensureType(id);
+    return id;
+}
+
+EventFieldId EventBus::fieldId(const std::string &field_name) {
+    auto it = field_ids_.find(field_name);
+    if (it != field_ids_.end()) {
+        return it->second;
+    }
+    auto id = static_cast<EventFieldId>(field_names_.size());
+    field_ids_.emplace(field_name, id);
+    field_names_.push_back(field_name);
+    return id;
+}
+
+void EventBus::ensureType(EventTypeId id) {
+    if (subscribers_.size() <= id) {
+        subscribers_.resize(id + 1);
+    }
+    if (type_buffers_.size() <= id) {
+        type_buffers_.resize(id + 1);
+    }
+}
+
+void EventBus::addSubscriber(EventTypeId event_type, Subscriber subscriber) {
+    ensureType(event_type);
+    if (subscriber.options.filtered()) {
+        subscriber.filter = std::make_shared<Filter>(subscriber.options);
+    }
+    subscribers_[event_type].push_back(std::move(subscriber));
+    dispatch_dirty_ = true;
+}
+
+void EventBus::rebuildDispatch() {
+    dispatch_.assign(subscribers_.size(), DispatchEntry{});
+    serial_batch_routes_.clear();
+    parallel_routes_.clear();
+    for (std::size_t type = 0; type < dispatch_.size(); ++type) {
+        auto type_id = static_cast<EventTypeId>(type);
+        for (const auto &subscriber : subscribers_[type]) {
+            Route route{type_id, subscriber.handler, subscriber.batch, subscriber.legacy, subscriber.filter.get()};
+            if (subscriber.legacy) {
+                dispatch_[type].serial.push_back(std::move(route));
+                dispatch_[type].has_legacy = true;
+            } else if (subscriber.options.thread_safe) {
+                parallel_routes_.push_back(std::move(route));
+            } else if (subscriber.batch) {
+                serial_batch_routes_.push_back(std::move(route));
+            } else {
+                dispatch_[type].serial.push_back(std::move(route));
+            }
+        }
+    }
+    batches_.resize(dispatch_.size());
+    grouped_ = !serial_batch_routes_.empty() || !parallel_routes_.empty();
+    dispatch_dirty_ = false;
+}
+
+void EventBus::subscribe(EventTypeId event_type, TypedHandler handler) {
+    subscribe(event_type, std::move(handler), subscription_defaults_);
+}
+
+void EventBus::subscribe(EventTypeId event_type, TypedHandler handler, SubscribeOptions options) {
+    addSubscriber(event_type, {std::move(handler), nullptr, nullptr, std::move(options), nullptr});
+}
+
+void EventBus::subscribeBatch(EventTypeId event_type, BatchHandler handler) {
+    subscribeBatch(event_type, std::move(handler), subscription_defaults_);
+}
+
+void EventBus::subscribeBatch(EventTypeId event_type, BatchHandler handler, SubscribeOptions options) {
+    addSubscriber(event_type, {nullptr, std::move(handler), nullptr, std::move(options), nullptr});
+}
+
+void EventBus::emit(TypedEvent event) {
+    const auto sequence = next_sequence_++;
+    enqueue({std::move(event), nullptr, current_producer_, sequence, 0, sequence});
+}
+
 void EventBus::subscribe(const std::string &event_type, Handler handler) {
-    subscribers_[event_type].push_back(std::move(handler));
+    subscribe(event_type, std::move(handler), SubscribeOptions{});
+}
+
+// String handlers always run serially on the main thread; only the filters of the options apply.
+void EventBus::subscribe(const std::string &event_type, Handler handler, SubscribeOptions options) {
+    addSubscriber(typeId(event_type), {nullptr, nullptr, std::move(handler), std::move(options), nullptr});
 }
 
 void EventBus::emit(const SimulationEvent &event) {
-    buffer_.push_back(event);
+    TypedEvent typed;
+    typed.type = typeId(event.type);
+    typed.tick = event.tick;
+    for (const auto &pair : event.payload) {
+        EventValue value;
+        if (parseNumeric(pair.second, value)) {
+            typed.add(fieldId(pair.first), value);
+        }
+    }
+    const auto sequence = next_sequence_++;
+    enqueue({std::move(typed), std::make_shared<const SimulationEvent>(event), current_producer_, sequence, 0,
+             sequence});
+}
+
+void EventBus::enqueue(BufferedEvent entry) {
+    auto type = entry.event.type;
+    ensureType(type);
+    ++stats_.emitted;
+    ++type_buffers_[type].stats.emitted;
+    const auto &policy = type_buffers_[type].policy;
+    if (policy.capacity != 0 && type_buffers_[type].buffered >= policy.capacity) {
+        switch (policy.overflow) {
+        case BufferPolicy::Overflow::FlushEarly:
+            if (!flush_requested_) {
+                flush_requested_ = true;
+                ++stats_.early_flushes;
+                ++type_buffers_[type].stats.early_flushes;
+            }
+            break;
+        case BufferPolicy::Overflow::DropNewest:
+            ++stats_.dropped;
+            ++type_buffers_[type].stats.dropped;
+            return;
+        case BufferPolicy::Overflow::DropOldest:
+        case BufferPolicy::Overflow::Coalesce:
+            if (type_buffers_[type].buffered >= 2 * policy.capacity) {
+                trim(type);
+            }
+            break;
+        }
+    }
+    buffer_.push_back(std::move(entry));
+    auto &state = type_buffers_[type];
+    ++state.buffered;
+    state.stats.peak_buffered = std::max(state.stats.peak_buffered, state.buffered);
+    stats_.peak_buffered = std::max(stats_.peak_buffered, buffer_.size());
+}
+
+// Drops events of the type from buffer_ according to its policy; keeps the order of the rest.
+void EventBus::trim(EventTypeId type) {
+    auto &state = type_buffers_[type];
+    const auto &policy = state.policy;
+    std::size_t live = state.buffered;
+    if (policy.overflow == BufferPolicy::Overflow::Coalesce) {
+        coalesce_keys_.clear();
+        for (auto it = buffer_.rbegin(); it != buffer_.rend(); ++it) {
+            if (it->event.type != type) {
+                continue;
+            }
+            const auto *key = it->event.find(policy.coalesce_key);
+            if (key && !coalesce_keys_.insert(key->value.asInt()).second) {
+                it->dropped = true;
+                --live;
+                ++state.stats.coalesced;
+                ++stats_.coalesced;
+            }
+        }
+    }
+    if (policy.capacity != 0 && live > policy.capacity) {
+        auto excess = live - policy.capacity;
+        auto drop = [&](BufferedEvent &entry) {
+            if (excess != 0 && entry.event.type == type && !entry.dropped) {
+                entry.dropped = true;
+                --excess;
+                --live;
+                ++state.stats.dropped;
+                ++stats_.dropped;
+            }
+        };
+        if (policy.overflow == BufferPolicy::Overflow::DropNewest) {
+            std::for_each(buffer_.rbegin(), buffer_.rend(), drop);
+        } else {
+            std::for_each(buffer_.begin(), buffer_.end(), drop);
+        }
+    }
+    if (live != state.buffered) {
+        buffer_.erase(std::remove_if(buffer_.begin(), buffer_.end(),
+                                     [](const BufferedEvent &entry) { return entry.dropped; }),
+                      buffer_.end());
+        state.buffered = live;
+    }
+}
+
+void EventBus::setBufferPolicy(EventTypeId event_type, BufferPolicy policy) {
+    ensureType(event_type);
+    type_buffers_[event_type].policy = policy;
+    auto it = std::find(bounded_types_.begin(), bounded_types_.end(), event_type);
+    bool bounded = policy.capacity != 0 || policy.overflow == BufferPolicy::Overflow::Coalesce;
+    if (bounded && it == bounded_types_.end()) {
+        bounded_types_.push_back(event_type);
+    } else if (!bounded && it != bounded_types_.end()) {
+        bounded_types_.erase(it);
+    }
+}
+
+EventBusStats EventBus::stats(EventTypeId event_type) const {
+    return event_type < type_buffers_.size() ? type_buffers_[event_type].stats : EventBusStats{};
+}
+
+EventBus::Lane &EventBus::lane(std::uint32_t slot) {
+    Lane *found = nullptr;
+    for (auto &existing : lanes_) {
+        if (existing->producer_ == current_producer_ && existing->slot_ == slot) {
+            found = existing.get();
+            break;
+        }
+    }
+    if (!found) {
+        lanes_.push_back(std::unique_ptr<Lane>(new Lane(current_producer_, slot)));
+        found = lanes_.back().get();
+    }
+    if (found->pending_.empty()) {
+        found->position_ = next_sequence_;
+    }
+    return *found;
+}
+
+void EventBus::mergeLanes() {
+    bool merged = false;
+    for (auto &lane : lanes_) {
+        if (lane->pending_.empty()) {
+            continue;
+        }
+        for (const auto &entry : lane->pending_) {
+            ensureType(entry.event.type);
+            auto &state = type_buffers_[entry.event.type];
+            ++state.stats.emitted;
+            ++state.buffered;
+        }
+        stats_.emitted += lane->pending_.size();
+        buffer_.insert(buffer_.end(), std::make_move_iterator(lane->pending_.begin()),
+                       std::make_move_iterator(lane->pending_.end()));
+        lane->pending_.clear();
+        merged = true;
+    }
+    // Main-thread events keep emission order; a lane's events go in front of the main-thread event
+    // that was next when the lane was taken.
+    auto order = [](const BufferedEvent &a, const BufferedEvent &b) {
+        if (a.position != b.position) {
+            return a.position < b.position;
+        }
+        if (a.from_lane != b.from_lane) {
+            return a.from_lane;
+        }
+        if (a.producer != b.producer) {
+            return a.producer < b.producer;
+        }
+        if (a.sequence != b.sequence) {
+            return a.sequence < b.sequence;
+        }
+        return a.slot < b.slot;
+    };
+    if (merged && !std::is_sorted(buffer_.begin(), buffer_.end(), order)) {
+        std::stable_sort(buffer_.begin(), buffer_.end(), order);
+    }
+}
+
+SimulationEvent EventBus::materialize(const TypedEvent &event) const {
+    SimulationEvent legacy;
+    legacy.type = typeName(event.type);
+    legacy.tick = event.tick;
+    for (const auto &field : event.fields) {
+        legacy.payload[fieldName(field.id)] = field.value.toString();
+    }
+    return legacy;
 }
 
 void EventBus::deliverBuffered() {
-    auto to_deliver = buffer_;
-    buffer_.clear();
-    for (const auto &event : to_deliver) {
-        auto it = subscribers_.find(event.type);
-        if (it == subscribers_.end()) {
+    if (dispatch_dirty_) {
+        rebuildDispatch();
+    }
+    flush_requested_ = false;
+    mergeLanes();
+    for (auto type : bounded_types_) {
+        const auto &state = type_buffers_[type];
+        bool over = state.policy.capacity != 0 && state.buffered > state.policy.capacity &&
+                    state.policy.overflow != BufferPolicy::Overflow::FlushEarly;
+        if (over || state.policy.overflow == BufferPolicy::Overflow::Coalesce) {
+            trim(type);
+        }
+    }
+    stats_.peak_buffered = std::max(stats_.peak_buffered, buffer_.size());
+    for (auto &state : type_buffers_) {
+        state.stats.peak_buffered = std::max(state.stats.peak_buffered, state.buffered);
+        state.buffered = 0;
+    }
+    delivering_.swap(buffer_);
+    if (grouped_) {
+        groupByType();
+    }
+
+    auto task = [this](std::size_t index) {
+        if (index == 0) {
+            deliverSerial();
+        } else {
+            deliverRoute(parallel_routes_[index - 1]);
+        }
+    };
+    if (dispatch_pool_ && !parallel_routes_.empty()) {
+        dispatch_pool_->parallelFor(parallel_routes_.size() + 1, task);
+    } else {
+        for (std::size_t i = 0; i <= parallel_routes_.size(); ++i) {
+            task(i);
+        }
+    }
+
+    for (auto &batch : batches_) {
+        batch.events.clear();
+        batch.legacy.clear();
+    }
+    order_.clear();
+    delivering_.clear();
+    for (auto &entry : dispatch_) {
+        collectDelivered(entry.serial);
+    }
+    collectDelivered(serial_batch_routes_);
+    collectDelivered(parallel_routes_);
+}
+
+void EventBus::collectDelivered(std::vector<Route> &routes) {
+    for (auto &route : routes) {
+        stats_.delivered += route.delivered;
+        type_buffers_[route.type].stats.delivered += route.delivered;
+        route.delivered = 0;
+    }
+}
+
+void EventBus::groupByType() {
+    for (auto &entry : delivering_) {
+        auto type = entry.event.type;
+        if (type >= batches_.size()) {
+            continue;
+        }
+        auto &batch = batches_[type];
+        const auto &route = dispatch_[type];
+        if (!route.serial.empty()) {
+            order_.push_back({type, static_cast<std::uint32_t>(batch.events.size())});
+        }
+        if (route.has_legacy) {
+            batch.legacy.resize(batch.events.size());
+            batch.legacy.push_back(std::move(entry.legacy));
+        }
+        batch.events.push_back(std::move(entry.event));
+    }
+}
+
+void EventBus::deliverOne(const TypedEvent &event, const std::shared_ptr<const SimulationEvent> &original) const {
+    const SimulationEvent *legacy = original.get();
+    SimulationEvent materialized;
+    for (const auto &route : dispatch_[event.type].serial) {
+        if (route.filter && !route.filter->accept(event)) {
             continue;
         }
-        for (const auto &handler : it->second) {
-            handler(event);
+        ++route.delivered;
+        if (route.handler) {
+            route.handler(event);
+            continue;
+        }
+        if (!legacy) {
+            materialized = materialize(event);
+            legacy = &materialized;
+        }
+        route.legacy(*legacy);
+    }
+}
+
+void EventBus::deliverSerial() {
+    if (!grouped_) {
+        for (const auto &entry : delivering_) {
+            if (entry.event.type < dispatch_.size()) {
+                deliverOne(entry.event, entry.legacy);
+            }
+        }
+        return;
+    }
+    static const std::shared_ptr<const SimulationEvent> no_original;
+    for (const auto &position : order_) {
+        const auto &batch = batches_[position.type];
+        const auto &original = position.index < batch.legacy.size() ? batch.legacy[position.index] : no_original;
+        deliverOne(batch.events[position.index], original);
+    }
+    for (const auto &route : serial_batch_routes_) {
+        deliverRoute(route);
+    }
+}
+
+void EventBus::deliverRoute(const Route &route) const {
+    const auto &events = batches_[route.type].events;
+    if (route.filter && route.batch) {
+        auto &selection = route.filter->selection;
+        selection.clear();
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            if (route.filter->accept(events[i])) {
+                selection.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+        if (!selection.empty()) {
+            route.delivered += selection.size();
+            route.batch(EventSpan(events.data(), selection.data(), selection.size()));
+        }
+        return;
+    }
+    if (route.batch) {
+        if (!events.empty()) {
+            route.delivered += events.size();
+            route.batch(EventSpan(events.data(), events.size()));
+        }
+        return;
+    }
+    for (const auto &event : events) {
+        if (!route.filter || route.filter->accept(event)) {
+            ++route.delivered;
+            route.handler(event);
         }
     }
 }
 
 void EventBus::clear() {
     buffer_.clear();
+    for (auto &state : type_buffers_) {
+        state.buffered = 0;
+    }
+    for (auto &lane : lanes_) {
+        lane->pending_.clear();
+    }
 }
 
 std::size_t EventBus::bufferedCount() const {
-    return buffer_.size();
+    std::size_t count = buffer_.size();
+    for (const auto &lane : lanes_) {
+        count += lane->pending_.size();
+    }
+    return count;
 }
 
 } // namespace ecosim
@@ -1,32 +1,350 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace ecosim {
 
+class ThreadPool;
+
+using EventTypeId = std::uint32_t;
+using EventFieldId = std::uint32_t;
+
 struct SimulationEvent {
     std::string type;
     int tick = 0;
     std::unordered_map<std::string, std::string> payload;
 };
 
+struct EventValue {
+    enum class Kind : std::uint8_t { Int, Real, Species };
+
+    Kind kind = Kind::Int;
+    union {
+        std::int64_t int_value = 0;
+        double real_value;
+        std::uint32_t species_value;
+    };
+
+    static EventValue ofInt(std::int64_t value);
+    static EventValue ofReal(double value);
+    static EventValue ofSpecies(std::uint32_t species_id);
+
+    std::int64_t asInt() const;
+    double asReal() const;
+    std::string toString() const;
+};
+
+bool operator==(const EventValue &a, const EventValue &b);
+inline bool operator!=(const EventValue &a, const EventValue &b) { return !(a == b); }
+
+struct EventField {
+    EventFieldId id = 0;
+    EventValue value;
+};
+
+// Fields may live in a TickArena (see ModuleContext::tickArena()). A copy of a TypedEvent allocates
+// its fields from the default heap resource, so handlers keep events beyond the tick by copying them.
+struct TypedEvent {
+    TypedEvent() = default;
+    explicit TypedEvent(std::pmr::memory_resource *resource) : fields(resource) {}
+
+    EventTypeId type = 0;
+    int tick = 0;
+    std::pmr::vector<EventField> fields;
+
+    void add(EventFieldId id, EventValue value) { fields.push_back({id, value}); }
+    const EventField *find(EventFieldId id) const;
+};
+
+// Ordered events of one type delivered in one tick. Contiguous unless the subscription filters
+// events, in which case the span walks a selection of indices into the tick's events.
+class EventSpan {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = TypedEvent;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const TypedEvent *;
+        using reference = const TypedEvent &;
+
+        iterator(const EventSpan *span, std::size_t index) : span_(span), index_(index) {}
+
+        reference operator*() const { return (*span_)[index_]; }
+        pointer operator->() const { return &(*span_)[index_]; }
+        iterator &operator++() {
+            ++index_;
+            return *this;
+        }
+        iterator operator++(int) {
+            auto copy = *this;
+            ++index_;
+            return copy;
+        }
+        bool operator==(const iterator &other) const { return index_ == other.index_; }
+        bool operator!=(const iterator &other) const { return index_ != other.index_; }
+
+    private:
+        const EventSpan *span_;
+        std::size_t index_;
+    };
+
+    EventSpan() = default;
+    EventSpan(const TypedEvent *data, std::size_t size) : data_(data), size_(size) {}
+    EventSpan(const TypedEvent *data, const std::uint32_t *selection, std::size_t size)
+        : data_(data), selection_(selection), size_(size) {}
+
+    bool contiguous() const { return selection_ == nullptr; }
+    // Only meaningful for contiguous spans.
+    const TypedEvent *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const TypedEvent &operator[](std::size_t index) const {
+        return selection_ ? data_[selection_[index]] : data_[index];
+    }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size_); }
+
+private:
+    const TypedEvent *data_ = nullptr;
+    const std::uint32_t *selection_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+struct FieldPredicate {
+    enum class Op : std::uint8_t { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+    EventFieldId field = 0;
+    Op op = Op::Equal;
+    EventValue value;
+
+    bool matches(const EventValue &candidate) const;
+};
+
+// Filters are evaluated by the bus before the handler runs (and before a string payload is
+// materialized): predicates first, then change detection, then sampling by stride.
+struct SubscribeOptions {
+    // The handler shares no state with other subscribers and may run on a worker thread,
+    // concurrently with other handlers. Its own events still arrive in order.
+    bool thread_safe = false;
+    // Deliver the first and then every Nth event that passed the other filters.
+    std::uint32_t stride = 1;
+    // All predicates must hold; events without the field are dropped.
+    std::vector<FieldPredicate> where;
+    // Deliver only when one of these fields differs from the last delivered event.
+    std::vector<EventFieldId> on_change;
+
+    bool filtered() const { return stride > 1 || !where.empty() || !on_change.empty(); }
+};
+
+// Limit on how many events of one type may wait for deliverBuffered().
+struct BufferPolicy {
+    enum class Overflow : std::uint8_t {
+        // Accept the event and request a flush (flushRequested()); the owner of the tick loop delivers
+        // at the next phase boundary, so handlers never run inside a module's phase.
+        FlushEarly,
+        DropOldest,
+        DropNewest,
+        // Keep only the latest event per value of coalesce_key (compared as integers), then drop oldest.
+        Coalesce
+    };
+
+    // 0 = unbounded. DropOldest/Coalesce trim lazily, so up to 2x capacity may be held before delivery.
+    std::size_t capacity = 0;
+    Overflow overflow = Overflow::FlushEarly;
+    EventFieldId coalesce_key = 0;
+};
+
+struct EventBusStats {
+    std::uint64_t emitted = 0;
+    // Events handed to handlers, once per receiving subscriber; events nobody receives are not counted.
+    std::uint64_t delivered = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t coalesced = 0;
+    std::uint64_t early_flushes = 0;
+    std::size_t peak_buffered = 0;
+};
+
 class EventBus {
 public:
     using Handler = std::function<void(const SimulationEvent &)>;
+    using TypedHandler = std::function<void(const TypedEvent &)>;
+    using BatchHandler = std::function<void(EventSpan)>;
+
+    class Lane;
+
+    EventTypeId typeId(const std::string &event_type);
+    EventFieldId fieldId(const std::string &field_name);
+    const std::string &typeName(EventTypeId id) const { return type_names_.at(id); }
+    const std::string &fieldName(EventFieldId id) const { return field_names_.at(id); }
+
+    void subscribe(EventTypeId event_type, TypedHandler handler);
+    void subscribe(EventTypeId event_type, TypedHandler handler, SubscribeOptions options);
+    void emit(TypedEvent event);
+
+    // Receives all events of the type buffered for a tick as one span, after per-event handlers
+    // of the same delivery stream. Not called for ticks without such events.
+    void subscribeBatch(EventTypeId event_type, BatchHandler handler);
+    void subscribeBatch(EventTypeId event_type, BatchHandler handler, SubscribeOptions options);
+
+    // Options applied by subscribe() overloads that do not take them (e.g. from the module manifest).
+    void setSubscriptionDefaults(SubscribeOptions options) { subscription_defaults_ = options; }
+    const SubscribeOptions &subscriptionDefaults() const { return subscription_defaults_; }
+
+    // Pool used to run thread-safe subscribers in parallel; deliverBuffered() waits for all of them.
+    void setDispatchPool(ThreadPool *pool) { dispatch_pool_ = pool; }
 
     void subscribe(const std::string &event_type, Handler handler);
+    void subscribe(const std::string &event_type, Handler handler, SubscribeOptions options);
     void emit(const SimulationEvent &event);
+
+    // Producer order stamped on events emitted from the calling (main) thread.
+    void setCurrentProducer(std::uint32_t producer) { current_producer_ = producer; }
+    std::uint32_t currentProducer() const { return current_producer_; }
+
+    // Returns the append lane (current producer, slot), creating it on first use. Lanes must be
+    // created on the main thread; afterwards each lane may be written by one worker thread without locking.
+    // Main-thread events are delivered in emission order. Lane events are delivered at the point where
+    // their lane was taken (the first lane() call since the lane was last delivered): after the
+    // main-thread events emitted before it and before those emitted after it. Lane events taken at
+    // the same point are ordered by (producer, sequence, slot).
+    Lane &lane(std::uint32_t slot);
+
     void deliverBuffered();
     void clear();
+    // A FlushEarly type reached its capacity since the last deliverBuffered().
+    bool flushRequested() const { return flush_requested_; }
 
     std::size_t bufferedCount() const;
 
+    void setBufferPolicy(EventTypeId event_type, BufferPolicy policy);
+    const EventBusStats &stats() const { return stats_; }
+    EventBusStats stats(EventTypeId event_type) const;
+
+private:
+    struct BufferedEvent {
+        TypedEvent event;
+        std::shared_ptr<const SimulationEvent> legacy;
+        std::uint32_t producer = 0;
+        std::uint64_t sequence = 0;
+        std::uint32_t slot = 0;
+        // Main-thread emission index the event is delivered at; equal to `sequence` for main-thread
+        // events, the index of the next main-thread event when the lane was taken for lane events.
+        std::uint64_t position = 0;
+        bool from_lane = false;
+        bool dropped = false;
+    };
+
+    struct TypeBuffer {
+        BufferPolicy policy;
+        std::size_t buffered = 0;
+        EventBusStats stats;
+    };
+
+    class Filter;
+
+    struct Subscriber {
+        TypedHandler handler;
+        BatchHandler batch;
+        Handler legacy;
+        SubscribeOptions options;
+        std::shared_ptr<Filter> filter;
+    };
+
+    struct Route {
+        EventTypeId type = 0;
+        TypedHandler handler;
+        BatchHandler batch;
+        Handler legacy;
+        Filter *filter = nullptr;
+        // Written only by the task delivering this route; folded into the stats after delivery.
+        mutable std::uint64_t delivered = 0;
+    };
+
+    struct DispatchEntry {
+        std::vector<Route> serial;
+        bool has_legacy = false;
+    };
+
+    struct TypeBatch {
+        std::vector<TypedEvent> events;
+        std::vector<std::shared_ptr<const SimulationEvent>> legacy;
+    };
+
+    struct OrderEntry {
+        EventTypeId type = 0;
+        std::uint32_t index = 0;
+    };
+
+    SimulationEvent materialize(const TypedEvent &event) const;
+    void ensureType(EventTypeId id);
+    void addSubscriber(EventTypeId event_type, Subscriber subscriber);
+    void rebuildDispatch();
+    void mergeLanes();
+    void groupByType();
+    void deliverOne(const TypedEvent &event, const std::shared_ptr<const SimulationEvent> &original) const;
+    void deliverSerial();
+    void deliverRoute(const Route &route) const;
+    void enqueue(BufferedEvent entry);
+    void trim(EventTypeId type);
+    void collectDelivered(std::vector<Route> &routes);
+
+    std::unordered_map<std::string, EventTypeId> type_ids_;
+    std::vector<std::string> type_names_;
+    std::unordered_map<std::string, EventFieldId> field_ids_;
+    std::vector<std::string> field_names_;
+
+    std::vector<std::vector<Subscriber>> subscribers_;
+    std::vector<BufferedEvent> buffer_;
+    std::vector<BufferedEvent> delivering_;
+    std::vector<DispatchEntry> dispatch_;
+    std::vector<Route> serial_batch_routes_;
+    std::vector<Route> parallel_routes_;
+    std::vector<TypeBatch> batches_;
+    std::vector<OrderEntry> order_;
+    bool grouped_ = false;
+    bool dispatch_dirty_ = true;
+    SubscribeOptions subscription_defaults_;
+    ThreadPool *dispatch_pool_ = nullptr;
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::uint32_t current_producer_ = 0;
+    std::uint64_t next_sequence_ = 0;
+    std::vector<TypeBuffer> type_buffers_;
+    std::vector<EventTypeId> bounded_types_;
+    std::unordered_set<std::int64_t> coalesce_keys_;
+    EventBusStats stats_;
+    bool flush_requested_ = false;
+};
+
+class EventBus::Lane {
+public:
+    // `sequence` orders this event among the lane events taken at the same point (see
+    // EventBus::lane()) and must not depend on how the work is split between lanes: use an entity or
+    // row index. It is never compared with main-thread events.
+    void emit(TypedEvent event, std::uint64_t sequence) {
+        pending_.push_back({std::move(event), nullptr, producer_, sequence, slot_, position_, true});
+    }
+
+    std::uint32_t producer() const { return producer_; }
+    std::uint32_t slot() const { return slot_; }
+
 private:
-    std::unordered_map<std::string, std::vector<Handler>> subscribers_;
-    std::vector<SimulationEvent> buffer_;
+    friend class EventBus;
+
+    Lane(std::uint32_t producer, std::uint32_t slot) : producer_(producer), slot_(slot) {}
+
+    std::uint32_t producer_;
+    std::uint32_t slot_;
+    std::uint64_t position_ = 0;
+    std::vector<BufferedEvent> pending_;
 };
 
 } // namespace ecosim
@@ -1,13 +1,12 @@
 #include "core/logger.h"
 
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <ctime>
 
 namespace ecosim {
 
 namespace {
-std::string channelLabel(LogChannel channel) {
+const char *channelLabel(LogChannel channel) {
     switch (channel) {
     case LogChannel::System:
         return "system";
@@ -17,7 +16,7 @@ std::string channelLabel(LogChannel channel) {
     return "unknown";
 }
 
-std::string timestamp() {
+void timestamp(char (&buffer)[32]) {
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
     std::tm tm{};
@@ -26,16 +25,19 @@ std::string timestamp() {
 #else
     localtime_r(&time, &tm);
 #endif
-    std::ostringstream stream;
-    stream << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return stream.str();
+    if (std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm) == 0) {
+        buffer[0] = '\0';
+    }
 }
 } // namespace
 
 Logger::Logger(std::ostream &output) : output_(output) {}
 
-void Logger::log(LogChannel channel, const std::string &message) {
-    output_ << '[' << timestamp() << "] [" << channelLabel(channel) << "] " << message << '\n';
+void Logger::log(LogChannel channel, std::string_view message) {
+    char stamp[32];
+    timestamp(stamp);
+    std::lock_guard<std::mutex> lock(mutex_);
+    output_ << '[' << stamp << "] [" << channelLabel(channel) << "] " << message << '\n';
 }
 
 } // namespace ecosim
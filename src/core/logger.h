@@ -1,7 +1,9 @@
 #pragma once
 
+#include <mutex>
 #include <ostream>
 #include <string>
+#include <string_view>
 
 namespace ecosim {
 
@@ -14,10 +16,11 @@ class Logger {
 public:
     explicit Logger(std::ostream &output);
 
-    void log(LogChannel channel, const std::string &message);
+    void log(LogChannel channel, std::string_view message);
 
 private:
     std::ostream &output_;
+    std::mutex mutex_;
 };
 
 } // namespace ecosim
@@ -1,3 +1,65 @@
 #include "core/module.h"
 
-namespace ecosim {}
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+
+namespace ecosim {
+namespace {
+
+bool parseNumber(const std::string &text, double &value) {
+    char *end = nullptr;
+    errno = 0;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && errno == 0 && end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+bool parseNumber(const std::string &text, std::size_t &value) {
+    if (text.empty() || text[0] < '0' || text[0] > '9') {
+        return false;
+    }
+    char *end = nullptr;
+    errno = 0;
+    const unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    value = static_cast<std::size_t>(parsed);
+    return errno == 0 && end == text.c_str() + text.size() && parsed == value;
+}
+
+template <typename Parsed, typename T>
+void readChecked(const ModuleInstanceConfig &instance, const std::string &name, T min, T max, T &value,
+                 Logger &logger) {
+    auto it = instance.params.find(name);
+    if (it == instance.params.end()) {
+        return;
+    }
+    Parsed parsed{};
+    if (parseNumber(it->second, parsed) && parsed >= min && parsed <= max) {
+        value = static_cast<T>(parsed);
+        return;
+    }
+    logger.log(LogChannel::System, "Invalid " + name + " " + it->second + ", using " + std::to_string(value));
+}
+
+} // namespace
+
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, float min, float max, float &value,
+               Logger &logger) {
+    readChecked<double>(instance, name, min, max, value, logger);
+}
+
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, double min, double max, double &value,
+               Logger &logger) {
+    readChecked<double>(instance, name, min, max, value, logger);
+}
+
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, std::size_t min, std::size_t max,
+               std::size_t &value, Logger &logger) {
+    readChecked<std::size_t>(instance, name, min, max, value, logger);
+}
+
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, std::uint32_t min, std::uint32_t max,
+               std::uint32_t &value, Logger &logger) {
+    readChecked<std::size_t>(instance, name, min, max, value, logger);
+}
+
+} // namespace ecosim
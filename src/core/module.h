@@ -3,7 +3,11 @@
 #include "core/config.h"
 #include "core/event_bus.h"
 #include "core/logger.h"
+#include "core/random.h"
+#include "core/thread_pool.h"
+#include "core/tick_arena.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -11,17 +15,24 @@ namespace ecosim {
 
 class ModuleContext {
 public:
-    ModuleContext(Logger &logger, EventBus &event_bus, const AppConfig &config)
-        : logger_(logger), event_bus_(event_bus), config_(config) {}
+    ModuleContext(Logger &logger, EventBus &event_bus, const AppConfig &config, ThreadPool &workers,
+                  TickArena &tick_arena)
+        : logger_(logger), event_bus_(event_bus), config_(config), workers_(workers), tick_arena_(tick_arena) {}
 
     Logger &logger() { return logger_; }
     EventBus &eventBus() { return event_bus_; }
     const AppConfig &config() const { return config_; }
+    ThreadPool &workers() { return workers_; }
+    TickArena &tickArena() { return tick_arena_; }
+    RandomStreams &random() { return random_; }
 
 private:
     Logger &logger_;
     EventBus &event_bus_;
     const AppConfig &config_;
+    ThreadPool &workers_;
+    TickArena &tick_arena_;
+    RandomStreams random_;
 };
 
 class IModule {
@@ -43,4 +54,15 @@ public:
 
 using ModulePtr = std::unique_ptr<IModule>;
 
+// Reads the numeric module param `name` into `value` if it is set. A value that does not parse or lies
+// outside [min, max] is logged and `value` keeps its default.
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, float min, float max, float &value,
+               Logger &logger);
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, double min, double max, double &value,
+               Logger &logger);
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, std::size_t min, std::size_t max,
+               std::size_t &value, Logger &logger);
+void readParam(const ModuleInstanceConfig &instance, const std::string &name, std::uint32_t min, std::uint32_t max,
+               std::uint32_t &value, Logger &logger);
+
 } // namespace ecosim
@@ -10,7 +10,9 @@ ModuleManager::ModuleManager(ModuleRegistry &registry, ModuleContext &context)
 
 bool ModuleManager::buildModules(const std::vector<ModuleInstanceConfig> &instances, ErrorPolicy policy, Logger &logger) {
     modules_.clear();
+    module_views_.clear();
     start_order_.clear();
+    started_.clear();
 
     for (const auto &instance : instances) {
         if (!instance.enabled) {
@@ -35,6 +37,7 @@ bool ModuleManager::buildModules(const std::vector<ModuleInstanceConfig> &instan
             }
             continue;
         }
+        module_views_.push_back(module.get());
         modules_.push_back(std::move(module));
     }
     return true;
@@ -117,9 +120,15 @@ bool ModuleManager::startModules(ErrorPolicy policy, Logger &logger) {
                 continue;
             }
             logger.log(LogChannel::System, "Starting module " + module->typeId() + ":" + module->instanceId());
+            auto manifest = registry_.findManifest(module->typeId());
+            SubscribeOptions defaults;
+            defaults.thread_safe = manifest && manifest->thread_safe_handlers;
+            context_.eventBus().setSubscriptionDefaults(defaults);
             module->onInit();
             module->onStart();
+            context_.eventBus().setSubscriptionDefaults(SubscribeOptions{});
             start_order_.push_back(module->typeId());
+            started_.push_back(module.get());
         }
     }
 
@@ -141,14 +150,6 @@ void ModuleManager::stopModules() {
     }
 }
 
-std::vector<IModule *> ModuleManager::modules() const {
-    std::vector<IModule *> result;
-    for (const auto &module : modules_) {
-        result.push_back(module.get());
-    }
-    return result;
-}
-
 IModule *ModuleManager::findModule(const std::string &type_id, const std::string &instance_id) const {
     for (const auto &module : modules_) {
         if (module->typeId() == type_id && module->instanceId() == instance_id) {
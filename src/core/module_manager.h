@@ -18,8 +18,10 @@ public:
     bool startModules(ErrorPolicy policy, Logger &logger);
     void stopModules();
 
-    std::vector<IModule *> modules() const;
+    const std::vector<IModule *> &modules() const { return module_views_; }
     const std::vector<std::string> &startOrder() const { return start_order_; }
+    // Started modules in dependency order, matching startOrder().
+    const std::vector<IModule *> &startedModules() const { return started_; }
 
     IModule *findModule(const std::string &type_id, const std::string &instance_id = "default") const;
 
@@ -29,7 +31,9 @@ private:
     ModuleRegistry &registry_;
     ModuleContext &context_;
     std::vector<ModulePtr> modules_;
+    std::vector<IModule *> module_views_;
     std::vector<std::string> start_order_;
+    std::vector<IModule *> started_;
 };
 
 } // namespace ecosim
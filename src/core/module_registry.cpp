@@ -34,6 +34,7 @@ std::filesystem::path resolveLibraryPath(const std::filesystem::path &path) {
 } // namespace
 
 ModuleRegistry::~ModuleRegistry() {
+    factories_.clear();
     for (auto &library : libraries_) {
         if (!library.handle) {
             continue;
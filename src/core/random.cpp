@@ -0,0 +1,191 @@
+#include "core/random.h"
+
+#include "core/cpu_features.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ECOSIM_RANDOM_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ECOSIM_TARGET(features) __attribute__((target(features)))
+#else
+#define ECOSIM_TARGET(features)
+#endif
+
+namespace ecosim {
+
+namespace {
+constexpr std::uint32_t kMul0 = 0xD2511F53u;
+constexpr std::uint32_t kMul1 = 0xCD9E8D57u;
+constexpr std::uint32_t kWeyl0 = 0x9E3779B9u;
+constexpr std::uint32_t kWeyl1 = 0xBB67AE85u;
+constexpr int kRounds = 10;
+constexpr float kInv24 = 1.0f / 16777216.0f;
+
+std::uint64_t splitmix(std::uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+float toUniform(std::uint32_t bits) {
+    return static_cast<float>(bits >> 8) * kInv24;
+}
+
+float toNormal(std::uint32_t first, std::uint32_t second) {
+    // (0, 1] keeps the logarithm finite.
+    double radius_input = (static_cast<double>(first >> 8) + 1.0) * kInv24;
+    double angle = static_cast<double>(second >> 8) * kInv24 * 6.283185307179586;
+    return static_cast<float>(std::sqrt(-2.0 * std::log(radius_input)) * std::cos(angle));
+}
+
+void batchScalar(const std::uint32_t key[2], std::uint64_t first_entity, std::uint32_t tick, std::uint32_t block,
+                 std::uint32_t out[4][8]) {
+    for (std::uint32_t lane = 0; lane < 8; ++lane) {
+        std::uint64_t entity = first_entity + lane;
+        auto words = CounterRng::philox({static_cast<std::uint32_t>(entity), static_cast<std::uint32_t>(entity >> 32),
+                                         tick, block},
+                                        {key[0], key[1]});
+        for (int word = 0; word < 4; ++word) {
+            out[word][lane] = words[word];
+        }
+    }
+}
+
+#ifdef ECOSIM_RANDOM_X86
+// 32x32 -> 64 products of all 8 lanes, split into low and high halves.
+ECOSIM_TARGET("avx2")
+void mulHiLo(__m256i value, __m256i factor, __m256i &hi, __m256i &lo) {
+    __m256i even = _mm256_mul_epu32(value, factor);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), factor);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+ECOSIM_TARGET("avx2")
+void batchAvx2(const std::uint32_t key[2], std::uint64_t first_entity, std::uint32_t tick, std::uint32_t block,
+               std::uint32_t out[4][8]) {
+    // The high entity word must be the same for all lanes.
+    if ((first_entity >> 32) != ((first_entity + 7) >> 32)) {
+        batchScalar(key, first_entity, tick, block, out);
+        return;
+    }
+    const __m256i mul0 = _mm256_set1_epi32(static_cast<int>(kMul0));
+    const __m256i mul1 = _mm256_set1_epi32(static_cast<int>(kMul1));
+    __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(first_entity))),
+                                  _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i c1 = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(first_entity >> 32)));
+    __m256i c2 = _mm256_set1_epi32(static_cast<int>(tick));
+    __m256i c3 = _mm256_set1_epi32(static_cast<int>(block));
+    std::uint32_t k0 = key[0];
+    std::uint32_t k1 = key[1];
+    for (int round = 0; round < kRounds; ++round) {
+        __m256i hi0, lo0, hi1, lo1;
+        mulHiLo(c0, mul0, hi0, lo0);
+        mulHiLo(c2, mul1, hi1, lo1);
+        c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+        c1 = lo1;
+        c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+        c3 = lo0;
+        k0 += kWeyl0;
+        k1 += kWeyl1;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out[0]), c0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out[1]), c1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out[2]), c2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out[3]), c3);
+}
+#endif
+} // namespace
+
+CounterRng::CounterRng(std::uint64_t seed, std::uint64_t tick, std::uint32_t stream, BatchFn batch)
+    : tick_(static_cast<std::uint32_t>(tick)), batch_(batch ? batch : batchScalar) {
+    auto key = splitmix(seed ^ splitmix((static_cast<std::uint64_t>(stream) << 32) | (tick >> 32)));
+    key_ = {static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32)};
+}
+
+CounterRng::Block CounterRng::philox(Block counter, std::array<std::uint32_t, 2> key) {
+    for (int round = 0; round < kRounds; ++round) {
+        std::uint64_t product0 = static_cast<std::uint64_t>(kMul0) * counter[0];
+        std::uint64_t product1 = static_cast<std::uint64_t>(kMul1) * counter[2];
+        counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                   static_cast<std::uint32_t>(product1),
+                   static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                   static_cast<std::uint32_t>(product0)};
+        key[0] += kWeyl0;
+        key[1] += kWeyl1;
+    }
+    return counter;
+}
+
+CounterRng::Block CounterRng::block(std::uint64_t entity, std::uint32_t index) const {
+    return philox({static_cast<std::uint32_t>(entity), static_cast<std::uint32_t>(entity >> 32), tick_, index}, key_);
+}
+
+std::uint32_t CounterRng::bits(std::uint64_t entity, std::uint32_t draw) const {
+    return block(entity, draw / 4)[draw % 4];
+}
+
+float CounterRng::uniform(std::uint64_t entity, std::uint32_t draw) const {
+    return toUniform(bits(entity, draw));
+}
+
+float CounterRng::normal(std::uint64_t entity, std::uint32_t draw) const {
+    auto words = block(entity, draw / 2);
+    auto pair = (draw % 2) * 2;
+    return toNormal(words[pair], words[pair + 1]);
+}
+
+template <typename Transform>
+void CounterRng::fill(std::uint64_t first_entity, std::size_t count, float *out, std::uint32_t index,
+                      Transform transform) const {
+    std::uint32_t words[4][8];
+    for (std::size_t done = 0; done < count; done += 8) {
+        batch_(key_.data(), first_entity + done, tick_, index, words);
+        std::size_t lanes = count - done < 8 ? count - done : 8;
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            out[done + lane] = transform(words, lane);
+        }
+    }
+}
+
+void CounterRng::fillUniform(std::uint64_t first_entity, std::size_t count, float *out, std::uint32_t draw) const {
+    const auto word = draw % 4;
+    fill(first_entity, count, out, draw / 4,
+         [word](const std::uint32_t(&words)[4][8], std::size_t lane) { return toUniform(words[word][lane]); });
+}
+
+void CounterRng::fillNormal(std::uint64_t first_entity, std::size_t count, float *out, std::uint32_t draw) const {
+    const auto pair = (draw % 2) * 2;
+    fill(first_entity, count, out, draw / 2, [pair](const std::uint32_t(&words)[4][8], std::size_t lane) {
+        return toNormal(words[pair][lane], words[pair + 1][lane]);
+    });
+}
+
+RandomStreams::RandomStreams(bool simd) : batch_(batchScalar) {
+#ifdef ECOSIM_RANDOM_X86
+    if (simd && detectCpuFeatures().avx2) {
+        batch_ = batchAvx2;
+    }
+#else
+    (void)simd;
+#endif
+}
+
+bool RandomStreams::vectorized() const {
+    return batch_ != batchScalar;
+}
+
+std::uint32_t RandomStreams::streamId(const std::string &name) {
+    std::uint32_t hash = 2166136261u;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+} // namespace ecosim
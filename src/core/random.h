@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ecosim {
+
+// Counter-based generator (Philox4x32-10, Salmon et al., SC'11): every draw is a pure function of
+// (seed, tick, stream, entity, draw index), with no state advanced between calls. Work split across
+// threads in any way therefore sees exactly the numbers a serial pass would.
+class CounterRng {
+public:
+    using Block = std::array<std::uint32_t, 4>;
+    // Fills 8 consecutive entities' blocks, one word array per block word.
+    using BatchFn = void (*)(const std::uint32_t key[2], std::uint64_t first_entity, std::uint32_t tick,
+                             std::uint32_t block, std::uint32_t out[4][8]);
+
+    CounterRng(std::uint64_t seed, std::uint64_t tick, std::uint32_t stream, BatchFn batch = nullptr);
+
+    static Block philox(Block counter, std::array<std::uint32_t, 2> key);
+
+    // Draw `draw` of an entity: word draw % 4 of block draw / 4.
+    std::uint32_t bits(std::uint64_t entity, std::uint32_t draw = 0) const;
+    // Uniform in [0, 1) with 24 random bits.
+    float uniform(std::uint64_t entity, std::uint32_t draw = 0) const;
+    // Standard normal by Box-Muller from words 2 * (draw % 2) and 2 * (draw % 2) + 1 of block draw / 2.
+    float normal(std::uint64_t entity, std::uint32_t draw = 0) const;
+
+    // out[i] = uniform(first_entity + i, draw) / normal(first_entity + i, draw), generated 8 entities
+    // at a time (vectorised when the batch function allows); bit-identical to the per-entity calls.
+    void fillUniform(std::uint64_t first_entity, std::size_t count, float *out, std::uint32_t draw = 0) const;
+    void fillNormal(std::uint64_t first_entity, std::size_t count, float *out, std::uint32_t draw = 0) const;
+
+private:
+    Block block(std::uint64_t entity, std::uint32_t index) const;
+    template <typename Transform>
+    void fill(std::uint64_t first_entity, std::size_t count, float *out, std::uint32_t index,
+              Transform transform) const;
+
+    std::array<std::uint32_t, 2> key_;
+    std::uint32_t tick_;
+    BatchFn batch_;
+};
+
+// Per-context source of CounterRng streams. The world sets the seed on world.reset and the tick at the
+// start of onTick; modules name their streams so that unrelated draws never share numbers.
+class RandomStreams {
+public:
+    // simd = false forces the scalar batch path (for comparisons and benchmarks).
+    explicit RandomStreams(bool simd = true);
+
+    void setSeed(std::uint64_t seed) { seed_ = seed; }
+    void setTick(std::uint64_t tick) { tick_ = tick; }
+    std::uint64_t seed() const { return seed_; }
+    std::uint64_t tick() const { return tick_; }
+    bool vectorized() const;
+
+    CounterRng stream(std::uint32_t stream) const { return CounterRng(seed_, tick_, stream, batch_); }
+    CounterRng stream(std::uint32_t stream, std::uint64_t tick) const {
+        return CounterRng(seed_, tick, stream, batch_);
+    }
+
+    // Stable stream id for a name (FNV-1a).
+    static std::uint32_t streamId(const std::string &name);
+
+private:
+    std::uint64_t seed_ = 0;
+    std::uint64_t tick_ = 0;
+    CounterRng::BatchFn batch_;
+};
+
+} // namespace ecosim
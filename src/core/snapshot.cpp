@@ -0,0 +1,267 @@
+#include "core/snapshot.h"
+#include "core/state_hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ecosim {
+
+namespace {
+const char kMagic[8] = {'E', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t section_count;
+    std::uint32_t alignment;
+    std::uint64_t file_size;
+};
+
+struct Entry {
+    char name[kSnapshotNameSize];
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t hash;
+};
+
+static_assert(sizeof(Header) == 32 && sizeof(Entry) == 64, "snapshot layout must not depend on the compiler");
+
+std::size_t alignUp(std::size_t value) {
+    return (value + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+}
+
+const Entry *entries(const unsigned char *data) {
+    return reinterpret_cast<const Entry *>(data + sizeof(Header));
+}
+} // namespace
+
+void SnapshotWriter::add(const std::string &name, const void *data, std::size_t size) {
+    sections_.push_back({name, {}, 0});
+    append(data, size);
+}
+
+void SnapshotWriter::append(const void *data, std::size_t size) {
+    if (size != 0) {
+        sections_.back().pieces.push_back({data, size});
+        sections_.back().size += size;
+    }
+}
+
+void SnapshotWriter::addStrings(const std::string &name, const std::vector<std::string> &values) {
+    std::string packed;
+    for (const auto &value : values) {
+        packed.append(value.c_str(), value.size() + 1);
+    }
+    owned_.push_back(std::move(packed));
+    add(name, owned_.back().data(), owned_.back().size());
+}
+
+bool SnapshotWriter::write(const std::string &path, std::string &error) const {
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kSnapshotVersion;
+    header.byte_order = kByteOrderMark;
+    header.section_count = static_cast<std::uint32_t>(sections_.size());
+    header.alignment = static_cast<std::uint32_t>(kSnapshotAlignment);
+
+    std::vector<Entry> table(sections_.size());
+    std::size_t offset = alignUp(sizeof(Header) + sizeof(Entry) * table.size());
+    for (std::size_t i = 0; i < sections_.size(); ++i) {
+        const auto &section = sections_[i];
+        if (section.name.empty() || section.name.size() >= kSnapshotNameSize) {
+            error = "snapshot section name must be 1.." + std::to_string(kSnapshotNameSize - 1) + " chars: " +
+                    section.name;
+            return false;
+        }
+        Entry &entry = table[i];
+        std::memcpy(entry.name, section.name.data(), section.name.size());
+        entry.offset = offset;
+        entry.size = section.size;
+        Hash64 hash;
+        for (const auto &piece : section.pieces) {
+            hash.update(piece.data, piece.size);
+        }
+        entry.hash = hash.digest();
+        offset = alignUp(offset + section.size);
+    }
+    header.file_size = offset;
+
+    const std::string temp = path + ".tmp";
+    std::FILE *file = std::fopen(temp.c_str(), "wb");
+    if (!file) {
+        error = "cannot create " + temp;
+        return false;
+    }
+    static const unsigned char padding[kSnapshotAlignment] = {};
+    std::size_t written = 0;
+    auto put = [&](const void *data, std::size_t size) {
+        if (size != 0 && std::fwrite(data, 1, size, file) == size) {
+            written += size;
+        }
+    };
+    put(&header, sizeof(header));
+    put(table.data(), sizeof(Entry) * table.size());
+    put(padding, alignUp(written) - written);
+    for (const auto &section : sections_) {
+        for (const auto &piece : section.pieces) {
+            put(piece.data, piece.size);
+        }
+        put(padding, alignUp(written) - written);
+    }
+    bool ok = std::fflush(file) == 0 && written == offset;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::remove(temp.c_str());
+        error = "short write to " + temp;
+        return false;
+    }
+    std::error_code code;
+    std::filesystem::rename(temp, path, code);
+    if (code) {
+        std::remove(temp.c_str());
+        error = "cannot rename snapshot to " + path + ": " + code.message();
+        return false;
+    }
+    return true;
+}
+
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+bool SnapshotReader::open(const std::string &path, std::string &error) {
+    close();
+    error.clear();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "cannot open " + path;
+        return false;
+    }
+    LARGE_INTEGER length{};
+    GetFileSizeEx(file, &length);
+    std::size_t size = static_cast<std::size_t>(length.QuadPart);
+    void *view = nullptr;
+    if (size >= sizeof(Header)) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info {};
+    std::size_t size = ::fstat(fd, &info) == 0 ? static_cast<std::size_t>(info.st_size) : 0;
+    void *view = nullptr;
+    if (size >= sizeof(Header)) {
+        view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+    }
+    ::close(fd);
+#endif
+    if (!view) {
+        error = path + " is too short or cannot be mapped";
+        return false;
+    }
+    data_ = static_cast<const unsigned char *>(view);
+    size_ = size;
+
+    Header header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        error = path + " is not a snapshot";
+    } else if (header.version != kSnapshotVersion) {
+        error = "snapshot version " + std::to_string(header.version) + " is not supported (expected " +
+                std::to_string(kSnapshotVersion) + ")";
+    } else if (header.byte_order != kByteOrderMark || header.alignment != kSnapshotAlignment) {
+        error = "snapshot was written on a platform with a different layout";
+    } else if (header.file_size != size_ ||
+               sizeof(Header) + sizeof(Entry) * static_cast<std::size_t>(header.section_count) > size_) {
+        error = "snapshot is truncated: " + std::to_string(size_) + " of " + std::to_string(header.file_size) +
+                " bytes";
+    }
+    if (!error.empty()) {
+        close();
+        return false;
+    }
+    sections_ = header.section_count;
+    const Entry *table = entries(data_);
+    for (std::size_t i = 0; i < sections_; ++i) {
+        const Entry &entry = table[i];
+        std::string name(entry.name, strnlen(entry.name, kSnapshotNameSize));
+        if (entry.offset > size_ || entry.size > size_ - entry.offset || entry.offset % kSnapshotAlignment != 0) {
+            error = "snapshot section " + name + " is out of bounds";
+        } else if (hash64(data_ + entry.offset, static_cast<std::size_t>(entry.size)) != entry.hash) {
+            error = "snapshot section " + name + " is corrupted";
+        }
+        if (!error.empty()) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SnapshotReader::close() {
+    if (data_) {
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<unsigned char *>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    sections_ = 0;
+}
+
+SnapshotReader::Section SnapshotReader::find(const std::string &name) const {
+    if (!data_ || name.size() >= kSnapshotNameSize) {
+        return {};
+    }
+    const Entry *table = entries(data_);
+    for (std::size_t i = 0; i < sections_; ++i) {
+        if (std::strncmp(table[i].name, name.c_str(), kSnapshotNameSize) == 0) {
+            // Empty sections still resolve, to a pointer at their (in-bounds) offset.
+            return {data_ + table[i].offset, static_cast<std::size_t>(table[i].size)};
+        }
+    }
+    return {};
+}
+
+bool SnapshotReader::readStrings(const std::string &name, std::vector<std::string> &out) const {
+    auto section = find(name);
+    if (!section.data || (section.size != 0 && static_cast<const char *>(section.data)[section.size - 1] != '\0')) {
+        return false;
+    }
+    out.clear();
+    const char *text = static_cast<const char *>(section.data);
+    for (std::size_t pos = 0; pos < section.size;) {
+        out.emplace_back(text + pos);
+        pos += out.back().size() + 1;
+    }
+    return true;
+}
+
+} // namespace ecosim
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ecosim {
+
+// Versioned binary snapshot: a fixed header, a table of named sections and the section payloads,
+// each aligned to kSnapshotAlignment. Payloads are raw native-layout arrays, so a reader maps the
+// file and hands out pointers into it; restoring a column is one copy, with no decoding.
+//   header  "ECSNAP\0\0", u32 version, u32 byte-order mark, u32 section count, u32 alignment,
+//           u64 file size
+//   table   per section: char name[40] (NUL-padded), u64 offset, u64 size, u64 XXH64 of the payload
+constexpr std::uint32_t kSnapshotVersion = 1;
+constexpr std::size_t kSnapshotAlignment = 64;
+constexpr std::size_t kSnapshotNameSize = 40;
+
+class SnapshotWriter {
+public:
+    // References `data` until write(); the caller keeps it alive and unchanged until then.
+    void add(const std::string &name, const void *data, std::size_t size);
+    // Extends the last added section with more bytes, e.g. the next chunk of a chunked column.
+    void append(const void *data, std::size_t size);
+    template <typename T>
+    void addArray(const std::string &name, const std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot trivially copyable values only");
+        add(name, values.data(), values.size() * sizeof(T));
+    }
+    // Copies a small value into the writer.
+    template <typename T>
+    void addValue(const std::string &name, const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot trivially copyable values only");
+        owned_.emplace_back(reinterpret_cast<const char *>(&value), sizeof(T));
+        add(name, owned_.back().data(), owned_.back().size());
+    }
+    // Stores the strings NUL-terminated, back to back.
+    void addStrings(const std::string &name, const std::vector<std::string> &values);
+
+    // Writes to `path` + ".tmp" with one write per added piece and renames over `path`, so a crash
+    // never leaves a partial snapshot under the final name.
+    bool write(const std::string &path, std::string &error) const;
+
+private:
+    struct Piece {
+        const void *data = nullptr;
+        std::size_t size = 0;
+    };
+    struct Section {
+        std::string name;
+        std::vector<Piece> pieces;
+        std::size_t size = 0;
+    };
+
+    std::vector<Section> sections_;
+    std::deque<std::string> owned_;
+};
+
+// Read-only memory mapping of a snapshot. open() checks the header, the table bounds and the payload
+// hashes; sections are then plain views into the mapping, valid while the reader lives.
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader &) = delete;
+    SnapshotReader &operator=(const SnapshotReader &) = delete;
+
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    struct Section {
+        const void *data = nullptr;
+        std::size_t size = 0;
+    };
+
+    bool has(const std::string &name) const { return find(name).data != nullptr; }
+    Section find(const std::string &name) const;
+
+    // Copy a section into `out`; false if it is missing or its size does not fit the type.
+    template <typename T>
+    bool readArray(const std::string &name, std::vector<T> &out) const {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot trivially copyable values only");
+        auto section = find(name);
+        if (!section.data || section.size % sizeof(T) != 0) {
+            return false;
+        }
+        auto begin = static_cast<const T *>(section.data);
+        out.assign(begin, begin + section.size / sizeof(T));
+        return true;
+    }
+    template <typename T>
+    bool readValue(const std::string &name, T &out) const {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot trivially copyable values only");
+        auto section = find(name);
+        if (!section.data || section.size != sizeof(T)) {
+            return false;
+        }
+        out = *static_cast<const T *>(section.data);
+        return true;
+    }
+    bool readStrings(const std::string &name, std::vector<std::string> &out) const;
+
+private:
+    const unsigned char *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t sections_ = 0;
+};
+
+// Implemented by modules whose state goes into a snapshot. Section names are prefixed with the
+// module's own namespace ("world.", "scenario."). restoreSnapshot() runs after onStart(), in module
+// start order, and replaces whatever state the module has at that point.
+class ISnapshotable {
+public:
+    virtual ~ISnapshotable() = default;
+
+    virtual void saveSnapshot(SnapshotWriter &out) const = 0;
+    virtual bool restoreSnapshot(const SnapshotReader &in, std::string &error) = 0;
+};
+
+} // namespace ecosim
@@ -0,0 +1,114 @@
+#include "core/state_hash.h"
+
+#include <cstring>
+
+namespace ecosim {
+
+namespace {
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+std::uint64_t rotl(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+std::uint64_t read64(const unsigned char *bytes) {
+    std::uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+std::uint32_t read32(const unsigned char *bytes) {
+    std::uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+    acc += input * kPrime2;
+    return rotl(acc, 31) * kPrime1;
+}
+
+std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t value) {
+    acc ^= round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+} // namespace
+
+Hash64::Hash64(std::uint64_t seed)
+    : seed_(seed), acc_{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1} {}
+
+void Hash64::update(const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    total_ += size;
+    if (buffered_ + size < sizeof(buffer_)) {
+        std::memcpy(buffer_ + buffered_, bytes, size);
+        buffered_ += size;
+        return;
+    }
+    if (buffered_ > 0) {
+        std::size_t fill = sizeof(buffer_) - buffered_;
+        std::memcpy(buffer_ + buffered_, bytes, fill);
+        for (int lane = 0; lane < 4; ++lane) {
+            acc_[lane] = round(acc_[lane], read64(buffer_ + lane * 8));
+        }
+        bytes += fill;
+        size -= fill;
+        buffered_ = 0;
+    }
+    for (; size >= 32; bytes += 32, size -= 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            acc_[lane] = round(acc_[lane], read64(bytes + lane * 8));
+        }
+    }
+    std::memcpy(buffer_, bytes, size);
+    buffered_ = size;
+}
+
+std::uint64_t Hash64::digest() const {
+    std::uint64_t hash;
+    if (total_ >= 32) {
+        hash = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+        for (auto acc : acc_) {
+            hash = mergeRound(hash, acc);
+        }
+    } else {
+        hash = seed_ + kPrime5;
+    }
+    hash += total_;
+
+    const unsigned char *tail = buffer_;
+    std::size_t left = buffered_;
+    for (; left >= 8; tail += 8, left -= 8) {
+        hash ^= round(0, read64(tail));
+        hash = rotl(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (left >= 4) {
+        hash ^= static_cast<std::uint64_t>(read32(tail)) * kPrime1;
+        hash = rotl(hash, 23) * kPrime2 + kPrime3;
+        tail += 4;
+        left -= 4;
+    }
+    for (; left > 0; ++tail, --left) {
+        hash ^= *tail * kPrime5;
+        hash = rotl(hash, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::uint64_t hash64(const void *data, std::size_t size, std::uint64_t seed) {
+    Hash64 hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+} // namespace ecosim
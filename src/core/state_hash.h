@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ecosim {
+
+// Streaming XXH64: update() may be called any number of times and the digest equals the one-shot
+// hash of the concatenated bytes. Values are hashed in their in-memory (little-endian) layout.
+class Hash64 {
+public:
+    explicit Hash64(std::uint64_t seed = 0);
+
+    void update(const void *data, std::size_t size);
+    template <typename T>
+    void add(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "hash trivially copyable values only");
+        update(&value, sizeof(T));
+    }
+    std::uint64_t digest() const;
+
+private:
+    std::uint64_t seed_;
+    std::uint64_t acc_[4];
+    unsigned char buffer_[32];
+    std::size_t buffered_ = 0;
+    std::uint64_t total_ = 0;
+};
+
+std::uint64_t hash64(const void *data, std::size_t size, std::uint64_t seed = 0);
+
+} // namespace ecosim
@@ -0,0 +1,97 @@
+#include "core/thread_pool.h"
+
+namespace ecosim {
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+std::size_t ThreadPool::defaultConcurrency() {
+    auto hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+void ThreadPool::start(std::size_t threads) {
+    stop();
+    stopping_ = false;
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const Task &task) {
+    if (count == 0) {
+        return;
+    }
+    bool expected = false;
+    if (workers_.empty() || count == 1 || !busy_.compare_exchange_strong(expected, true)) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        next_.store(0);
+        done_ = 0;
+        ++generation_;
+    }
+    wake_.notify_all();
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this]() { return done_ == count_ && active_ == 0; });
+    task_ = nullptr;
+    busy_.store(false);
+}
+
+void ThreadPool::drain() {
+    std::size_t completed = 0;
+    for (std::size_t i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+        (*task_)(i);
+        ++completed;
+    }
+    if (completed > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ += completed;
+    }
+    finished_.notify_all();
+}
+
+void ThreadPool::workerLoop() {
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return stopping_ || (generation_ != seen && task_ != nullptr); });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            ++active_;
+        }
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+        }
+        finished_.notify_all();
+    }
+}
+
+} // namespace ecosim
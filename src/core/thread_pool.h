@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecosim {
+
+class ThreadPool {
+public:
+    using Task = std::function<void(std::size_t)>;
+
+    ThreadPool() = default;
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Total parallelism including the calling thread; 0 or 1 runs everything inline.
+    void start(std::size_t threads);
+    void stop();
+
+    std::size_t concurrency() const { return workers_.size() + 1; }
+
+    // Runs task(0..count-1) across the pool and the calling thread, returning once all indices are done.
+    // Nested calls (from inside a task) run inline.
+    //
+    // Which thread runs an index is unspecified. Simulation code must stay bit-identical for any pool
+    // size, so it splits work into items that do not depend on concurrency() (rows, fixed-size chunks or
+    // tiles), lets each index write only its own outputs, and combines per-index results afterwards in
+    // index order on the calling thread.
+    void parallelFor(std::size_t count, const Task &task);
+
+    static std::size_t defaultConcurrency();
+
+private:
+    void workerLoop();
+    void drain();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable finished_;
+    bool stopping_ = false;
+    std::uint64_t generation_ = 0;
+    std::atomic<bool> busy_{false};
+
+    const Task *task_ = nullptr;
+    std::size_t count_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t done_ = 0;
+    std::size_t active_ = 0;
+};
+
+} // namespace ecosim
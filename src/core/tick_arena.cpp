@@ -0,0 +1,78 @@
+#include "core/tick_arena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+namespace ecosim {
+
+TickArena::TickArena(std::size_t block_size) : block_size_(block_size), owner_(std::this_thread::get_id()) {}
+
+TickArena::~TickArena() {
+    releaseAll();
+}
+
+void TickArena::nextTick() {
+    active_ = 1 - active_;
+    rewind(frames_[active_]);
+}
+
+void TickArena::rewind(Frame &frame) {
+    frame.current = 0;
+    frame.offset = 0;
+    frame.used = 0;
+}
+
+void TickArena::releaseAll() {
+    for (auto &frame : frames_) {
+        for (auto &block : frame.blocks) {
+            ::operator delete(block.data);
+        }
+        frame.blocks.clear();
+        rewind(frame);
+    }
+}
+
+void *TickArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    assert(std::this_thread::get_id() == owner_ && "TickArena used off its owning thread");
+    auto &frame = frames_[active_];
+    while (frame.current < frame.blocks.size()) {
+        auto &block = frame.blocks[frame.current];
+        auto base = reinterpret_cast<std::uintptr_t>(block.data);
+        auto aligned = (base + frame.offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        auto offset = static_cast<std::size_t>(aligned - base);
+        if (offset + bytes <= block.size) {
+            frame.offset = offset + bytes;
+            frame.used += bytes;
+            return block.data + offset;
+        }
+        ++frame.current;
+        frame.offset = 0;
+    }
+
+    Block block;
+    block.size = std::max(block_size_, bytes + alignment);
+    block.data = static_cast<std::byte *>(::operator new(block.size));
+    ++block_allocations_;
+    frame.blocks.push_back(block);
+    frame.current = frame.blocks.size() - 1;
+    frame.offset = 0;
+    return do_allocate(bytes, alignment);
+}
+
+std::size_t TickArena::bytesUsed() const {
+    return frames_[active_].used;
+}
+
+std::size_t TickArena::bytesReserved() const {
+    std::size_t total = 0;
+    for (const auto &frame : frames_) {
+        for (const auto &block : frame.blocks) {
+            total += block.size;
+        }
+    }
+    return total;
+}
+
+} // namespace ecosim
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace ecosim {
+
+// Monotonic memory for tick-scoped data (event payloads, queued commands, scratch buffers).
+// Memory handed out during tick N stays valid until the end of tick N + 1, so data produced in one
+// tick and consumed by the next (e.g. commands queued after the world's pre-tick) is safe. Anything
+// needed longer must be copied out. Not thread-safe: only the owning thread (the creator, or the last
+// caller of claimForCurrentThread()) may allocate from it (asserted), so modules must not hand
+// arena-backed containers to pool workers.
+class TickArena : public std::pmr::memory_resource {
+public:
+    explicit TickArena(std::size_t block_size = 64 * 1024);
+    ~TickArena() override;
+
+    TickArena(const TickArena &) = delete;
+    TickArena &operator=(const TickArena &) = delete;
+
+    // Ends the current tick: switches to the other frame and rewinds it, keeping its blocks.
+    void nextTick();
+    void releaseAll();
+    // Hands the arena to the calling thread, e.g. a world branch ticked on a pool worker.
+    void claimForCurrentThread() { owner_ = std::this_thread::get_id(); }
+
+    std::size_t bytesUsed() const;
+    std::size_t bytesReserved() const;
+    std::size_t blockAllocations() const { return block_allocations_; }
+
+private:
+    struct Block {
+        std::byte *data = nullptr;
+        std::size_t size = 0;
+    };
+
+    struct Frame {
+        std::vector<Block> blocks;
+        std::size_t current = 0;
+        std::size_t offset = 0;
+        std::size_t used = 0;
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    void rewind(Frame &frame);
+
+    std::size_t block_size_;
+    std::thread::id owner_;
+    Frame frames_[2];
+    int active_ = 0;
+    std::size_t block_allocations_ = 0;
+};
+
+} // namespace ecosim
@@ -5,8 +5,18 @@
 
 int main(int argc, char **argv) {
     std::string config_path = "configs/app.toml";
-    if (argc > 1) {
-        config_path = argv[1];
+    std::string resume_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--resume") {
+            if (i + 1 >= argc) {
+                std::cerr << "--resume requires a snapshot path" << std::endl;
+                return 1;
+            }
+            resume_path = argv[++i];
+        } else {
+            config_path = arg;
+        }
     }
 
     ecosim::Logger logger(std::cout);
@@ -20,6 +30,10 @@ int main(int argc, char **argv) {
         logger.log(ecosim::LogChannel::System, "Failed to start modules");
         return 1;
     }
+    if (!resume_path.empty() && !app.restoreSnapshot(resume_path)) {
+        app.shutdown();
+        return 1;
+    }
 
     const auto &mode = app.config().mode;
     if (mode == "console") {
@@ -1,18 +1,317 @@
 #include "modules/agent_behavoir.h"
 
 #include "core/logger.h"
+#include "modules/resource_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 
 namespace ecosim {
 
+namespace {
+constexpr float kTwoPi = 6.28318530718f;
+// Upper bounds of the size params: each flow field holds cells * cells entries.
+constexpr std::size_t kMaxNeighbors = 1024;
+constexpr std::size_t kMaxFlowCells = 16384;
+constexpr float kMaxValue = std::numeric_limits<float>::max();
+} // namespace
+
 AgentBehavoir::AgentBehavoir(const ModuleInstanceConfig &instance, ModuleContext &context)
-    : type_id_(instance.type_id), instance_id_(instance.instance_id), context_(context) {}
+    : type_id_(instance.type_id), instance_id_(instance.instance_id), context_(context),
+      wander_stream_(RandomStreams::streamId("behavior.wander")) {
+    auto predators_it = instance.params.find("predators");
+    if (predators_it != instance.params.end()) {
+        predator_names_.clear();
+        std::istringstream names(predators_it->second);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (!name.empty()) {
+                predator_names_.push_back(name);
+            }
+        }
+    }
+    Logger &logger = context_.logger();
+    readParam(instance, "sense_radius", 0.0f, kMaxValue, sense_radius_, logger);
+    readParam(instance, "neighbors", std::size_t{0}, kMaxNeighbors, neighbors_, logger);
+    readParam(instance, "speed", 0.0f, kMaxValue, speed_, logger);
+    readParam(instance, "hunt_range", 0.0f, kMaxValue, hunt_range_, logger);
+    readParam(instance, "reproduce_energy", 0.0f, kMaxValue, reproduce_energy_, logger);
+    readParam(instance, "flow_cells", std::size_t{0}, kMaxFlowCells, flow_cells_, logger);
+    readParam(instance, "food_level", -kMaxValue, kMaxValue, food_level_, logger);
+    food_.setWorkers(&context_.workers());
+    danger_.setWorkers(&context_.workers());
+    auto rules_it = instance.params.find("rules");
+    if (rules_it != instance.params.end()) {
+        rules_source_ = rules_it->second;
+    }
+}
 
 void AgentBehavoir::onInit() {
-    context_.logger().log(LogChannel::System, "AgentBehavoir module initialized (stub).");
+    std::string predators;
+    for (const auto &name : predator_names_) {
+        predators += (predators.empty() ? "" : ",") + name;
+    }
+    context_.logger().log(LogChannel::System, "AgentBehavoir: predators " + predators + ", " +
+                                                  std::to_string(neighbors_) + " neighbors within " +
+                                                  std::to_string(sense_radius_));
+    if (rules_source_.empty()) {
+        return;
+    }
+    std::string error;
+    if (rules_.compile(rules_source_, error)) {
+        context_.logger().log(LogChannel::System, "AgentBehavoir: " + std::to_string(rules_.ruleCount()) +
+                                                      " rules compiled to " +
+                                                      std::to_string(rules_.instructions().size()) + " instructions");
+    } else {
+        context_.logger().log(LogChannel::System, "Invalid behavior rules, using built-in ones: " + error);
+    }
+}
+
+void AgentBehavoir::refreshSpecies() {
+    const auto &species = world_->readModel().species;
+    if (predator_.size() == species.size()) {
+        return;
+    }
+    predator_.assign(species.size(), 0);
+    for (const auto &name : predator_names_) {
+        auto id = species.find(name);
+        if (id < predator_.size()) {
+            predator_[id] = 1;
+        }
+    }
+    rules_.bindSpecies(species);
 }
 
 void AgentBehavoir::onTick() {
-    context_.logger().log(LogChannel::System, "AgentBehavoir tick (stub).");
+    if (!world_) {
+        return;
+    }
+    refreshSpecies();
+    updateFlowFields();
+    const AgentStore &agents = world_->agents();
+    intents_ = world_->beginIntents(agents.size());
+    const std::size_t chunks = agents.chunkCount();
+    if (scratch_.size() < chunks) {
+        const std::size_t registers = std::max(BehaviorProgram::kFeatureCount, rules_.registerCount());
+        scratch_.resize(chunks);
+        for (auto &scratch : scratch_) {
+            scratch.nearby.reserve(neighbors_ + 1);
+            scratch.registers.resize(registers * kLanes);
+            scratch.prey.resize(kLanes);
+            scratch.threat.resize(kLanes);
+            scratch.actions.resize(kLanes);
+        }
+    }
+    context_.workers().parallelFor(chunks, [this](std::size_t chunk) { decideChunk(chunk); });
+    action_counts_.fill(0);
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (std::size_t action = 0; action < kActionCount; ++action) {
+            action_counts_[action] += scratch_[chunk].counts[action];
+        }
+    }
+}
+
+// Food sources are sampled at flow cell centres, danger sources are the cells holding a live predator.
+void AgentBehavoir::updateFlowFields() {
+    if (flow_cells_ == 0) {
+        return;
+    }
+    const float world_size = world_->worldSize();
+    if (danger_.cells() != flow_cells_ || flow_world_size_ != world_size) {
+        food_.resize(flow_cells_, world_size);
+        danger_.resize(flow_cells_, world_size);
+        flow_world_size_ = world_size;
+        flow_sources_.assign(flow_cells_ * flow_cells_, 0);
+    }
+    const ResourceField &resources = world_->resources();
+    if (!resources.empty()) {
+        const float cell = world_size / static_cast<float>(flow_cells_);
+        for (std::size_t row = 0; row < flow_cells_; ++row) {
+            const float y = (static_cast<float>(row) + 0.5f) * cell;
+            for (std::size_t column = 0; column < flow_cells_; ++column) {
+                const float x = (static_cast<float>(column) + 0.5f) * cell;
+                flow_sources_[row * flow_cells_ + column] = resources.sample(x, y) >= food_level_ ? 1 : 0;
+            }
+        }
+        food_.assignSources(flow_sources_);
+        food_.update();
+    }
+
+    std::fill(flow_sources_.begin(), flow_sources_.end(), 0);
+    const AgentStore &agents = world_->agents();
+    for (std::size_t chunk = 0; chunk < agents.chunkCount(); ++chunk) {
+        const SpeciesId *species = agents.species().chunk(chunk);
+        const float *xs = agents.x().chunk(chunk);
+        const float *ys = agents.y().chunk(chunk);
+        const std::uint8_t *alive = agents.alive().chunk(chunk);
+        for (std::size_t i = 0, rows = agents.chunkRows(chunk); i < rows; ++i) {
+            if (alive[i] && isPredator(species[i])) {
+                flow_sources_[danger_.cellAt(xs[i], ys[i])] = 1;
+            }
+        }
+    }
+    danger_.assignSources(flow_sources_);
+    danger_.update();
+}
+
+void AgentBehavoir::decideChunk(std::size_t chunk) {
+    const std::size_t begin = chunk * AgentStore::kChunkRows;
+    const std::size_t rows = world_->agents().chunkRows(chunk);
+    auto &scratch = scratch_[chunk];
+    scratch.counts.fill(0);
+    for (std::size_t offset = 0; offset < rows; offset += kLanes) {
+        const std::size_t lanes = std::min(kLanes, rows - offset);
+        sense(begin + offset, lanes, scratch);
+        decide(scratch.registers.data(), lanes, scratch.actions.data());
+        emit(begin + offset, lanes, scratch);
+    }
+}
+
+// Features of rows [begin, begin + lanes), all in one chunk. Dead rows get zero features and rest.
+void AgentBehavoir::sense(std::size_t begin, std::size_t lanes, Scratch &scratch) const {
+    const AgentStore &agents = world_->agents();
+    const std::size_t chunk = begin / AgentStore::kChunkRows;
+    const std::size_t first = begin % AgentStore::kChunkRows;
+    const SpeciesId *species = agents.species().chunk(chunk) + first;
+    const float *xs = agents.x().chunk(chunk) + first;
+    const float *ys = agents.y().chunk(chunk) + first;
+    const float *energy = agents.energy().chunk(chunk) + first;
+    const std::uint32_t *age = agents.age().chunk(chunk) + first;
+    const std::uint8_t *alive = agents.alive().chunk(chunk) + first;
+    const float sense_sq = sense_radius_ * sense_radius_;
+    const float none = std::numeric_limits<float>::infinity();
+    // Keyed by the world's tick, so draws do not depend on which context runs the module.
+    const auto draws = context_.random().stream(wander_stream_, static_cast<std::uint64_t>(world_->readModel().tick));
+    float *registers = scratch.registers.data();
+    float *feature_energy = BehaviorProgram::feature(registers, BehaviorFeature::Energy);
+    float *feature_age = BehaviorProgram::feature(registers, BehaviorFeature::Age);
+    float *feature_neighbors = BehaviorProgram::feature(registers, BehaviorFeature::Neighbors);
+    float *feature_prey = BehaviorProgram::feature(registers, BehaviorFeature::Prey);
+    float *feature_threats = BehaviorProgram::feature(registers, BehaviorFeature::Threats);
+    float *prey_distance = BehaviorProgram::feature(registers, BehaviorFeature::PreyDistance);
+    float *threat_distance = BehaviorProgram::feature(registers, BehaviorFeature::ThreatDistance);
+    float *feature_predator = BehaviorProgram::feature(registers, BehaviorFeature::Predator);
+    float *feature_species = BehaviorProgram::feature(registers, BehaviorFeature::Species);
+    float *feature_random = BehaviorProgram::feature(registers, BehaviorFeature::Random);
+
+    for (std::size_t i = 0; i < lanes; ++i) {
+        Neighbor &prey = scratch.prey[i];
+        Neighbor &threat = scratch.threat[i];
+        prey.row = kNoRow;
+        threat.row = kNoRow;
+        const bool predator = alive[i] && isPredator(species[i]);
+        std::size_t neighbors = 0;
+        std::size_t prey_count = 0;
+        std::size_t threat_count = 0;
+        if (alive[i]) {
+            world_->queryNearest(xs[i], ys[i], neighbors_ + 1, scratch.nearby);
+            for (const auto &neighbor : scratch.nearby) {
+                if (neighbor.distance_sq > sense_sq) {
+                    break;
+                }
+                if (neighbor.row == begin + i || !agents.alive()[neighbor.row]) {
+                    continue;
+                }
+                ++neighbors;
+                const bool other_predator = isPredator(agents.species()[neighbor.row]);
+                if (predator && !other_predator && prey_count++ == 0) {
+                    prey = neighbor;
+                } else if (!predator && other_predator && threat_count++ == 0) {
+                    threat = neighbor;
+                }
+            }
+        }
+        feature_energy[i] = alive[i] ? energy[i] : 0.0f;
+        feature_age[i] = alive[i] ? static_cast<float>(age[i]) : 0.0f;
+        feature_neighbors[i] = static_cast<float>(neighbors);
+        feature_prey[i] = static_cast<float>(prey_count);
+        feature_threats[i] = static_cast<float>(threat_count);
+        prey_distance[i] = prey.row != kNoRow ? std::sqrt(prey.distance_sq) : none;
+        threat_distance[i] = threat.row != kNoRow ? std::sqrt(threat.distance_sq) : none;
+        feature_predator[i] = predator ? 1.0f : 0.0f;
+        feature_species[i] = static_cast<float>(species[i]);
+        feature_random[i] = draws.uniform(agents.handle(begin + i).slot, 1);
+    }
+}
+
+void AgentBehavoir::decide(float *registers, std::size_t lanes, AgentAction *actions) const {
+    if (!rules_.empty()) {
+        rules_.run(registers, lanes, actions);
+        return;
+    }
+    const float *energy = BehaviorProgram::feature(registers, BehaviorFeature::Energy);
+    const float *prey = BehaviorProgram::feature(registers, BehaviorFeature::Prey);
+    const float *threats = BehaviorProgram::feature(registers, BehaviorFeature::Threats);
+    const float *predator = BehaviorProgram::feature(registers, BehaviorFeature::Predator);
+    for (std::size_t i = 0; i < lanes; ++i) {
+        if (prey[i] > 0.0f) {
+            actions[i] = AgentAction::Hunt;
+        } else if (threats[i] > 0.0f) {
+            actions[i] = AgentAction::Flee;
+        } else if (energy[i] >= reproduce_energy_) {
+            actions[i] = AgentAction::Reproduce;
+        } else {
+            actions[i] = predator[i] != 0.0f ? AgentAction::Move : AgentAction::Forage;
+        }
+    }
+}
+
+// Turns actions into intents. Hunt eats the sensed prey within hunt_range and otherwise approaches it
+// (Move); flee follows the danger field, or runs straight away from the nearest predator where it has
+// no direction; forage follows the food field. Hunt or flee with nothing sensed, move, and forage
+// without a food direction walk in a random direction.
+void AgentBehavoir::emit(std::size_t begin, std::size_t lanes, Scratch &scratch) const {
+    const AgentStore &agents = world_->agents();
+    const std::uint8_t *alive = agents.alive().chunk(begin / AgentStore::kChunkRows) + begin % AgentStore::kChunkRows;
+    const auto wander = context_.random().stream(wander_stream_, static_cast<std::uint64_t>(world_->readModel().tick));
+
+    for (std::size_t i = 0; i < lanes; ++i) {
+        const std::size_t row = begin + i;
+        AgentIntent &intent = intents_[row];
+        intent = AgentIntent();
+        intent.agent = agents.handle(row);
+        AgentAction action = alive[i] ? scratch.actions[i] : AgentAction::Rest;
+        FlowDirection flow;
+        if (action == AgentAction::Forage && !food_.empty()) {
+            flow = food_.sample(agents.x()[row], agents.y()[row]);
+        } else if (action == AgentAction::Flee && !danger_.empty()) {
+            flow = danger_.sample(agents.x()[row], agents.y()[row]);
+        }
+        const Neighbor *other = nullptr;
+        if (action == AgentAction::Hunt && scratch.prey[i].row != kNoRow) {
+            other = &scratch.prey[i];
+        } else if (action == AgentAction::Flee && scratch.threat[i].row != kNoRow) {
+            other = &scratch.threat[i];
+        }
+        if (flow.dx != 0.0f || flow.dy != 0.0f) {
+            intent.dx = flow.dx * speed_;
+            intent.dy = flow.dy * speed_;
+        } else if (other) {
+            float dx = agents.x()[other->row] - agents.x()[row];
+            float dy = agents.y()[other->row] - agents.y()[row];
+            const float distance = std::sqrt(other->distance_sq);
+            if (action == AgentAction::Hunt && distance <= hunt_range_) {
+                intent.target = other->agent;
+            } else {
+                const float step = distance > 0.0f ? speed_ / distance : 0.0f;
+                dx *= action == AgentAction::Hunt ? step : -step;
+                dy *= action == AgentAction::Hunt ? step : -step;
+                action = action == AgentAction::Hunt ? AgentAction::Move : AgentAction::Flee;
+            }
+            intent.dx = dx;
+            intent.dy = dy;
+        } else if (action == AgentAction::Hunt || action == AgentAction::Flee || action == AgentAction::Move ||
+                   action == AgentAction::Forage) {
+            const float angle = wander.uniform(intent.agent.slot) * kTwoPi;
+            intent.dx = std::cos(angle) * speed_;
+            intent.dy = std::sin(angle) * speed_;
+            action = action == AgentAction::Forage ? AgentAction::Forage : AgentAction::Move;
+        }
+        intent.action = action;
+        ++scratch.counts[static_cast<std::size_t>(action)];
+    }
 }
 
 } // namespace ecosim
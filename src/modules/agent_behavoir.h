@@ -1,13 +1,40 @@
 #pragma once
 
 #include "core/module.h"
+#include "modules/behavior_program.h"
+#include "modules/flow_field.h"
+#include "modules/world_port.h"
 
+#include <array>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace ecosim {
 
+// Decides what every agent does next (hunt, flee, reproduce, forage, move) in one batched pass over
+// the world's agent columns and writes the decisions into the world's intent buffer; the world applies
+// them in its next onPreTick. Each chunk of AgentStore::kChunkRows rows is one task on the worker pool,
+// processed in batches of BehaviorProgram::kLanes agents: sense (nearest-neighbour queries into feature
+// registers), decide (one action per agent), emit (intents with displacement and target). A decision
+// reads only the world and counter-based random streams keyed by agent slot.
+//
+// Species listed in `predators` hunt every other species; the others flee from predators they sense.
+// The decision is the built-in rule list below unless `rules` supplies one (BehaviorProgram syntax),
+// which is compiled at onInit; a rule list that does not compile is logged and the built-in one used.
+// Foragers follow a flow field towards cells whose resource is at least food_level, and fleeing agents
+// one away from cells holding predators (FlowField); both are refreshed every tick, recomputing only
+// the tiles whose sources changed. Without a direction there, foragers walk randomly and fleeing
+// agents run straight away from the nearest predator they sense.
+//
+// Instance params: predators (comma separated, default "wolf"), sense_radius (5), neighbors (nearest
+// agents considered, 8), speed (distance per tick, 1), hunt_range (1), reproduce_energy (4), rules,
+// flow_cells (flow field cells per side, 128; 0 turns the fields off), food_level (0.5).
 class AgentBehavoir : public IModule {
 public:
+    static constexpr std::size_t kActionCount = static_cast<std::size_t>(AgentAction::Reproduce) + 1;
+    static constexpr std::size_t kLanes = BehaviorProgram::kLanes;
+
     AgentBehavoir(const ModuleInstanceConfig &instance, ModuleContext &context);
 
     const std::string &typeId() const override { return type_id_; }
@@ -16,10 +43,65 @@ public:
     void onInit() override;
     void onTick() override;
 
+    void setWorld(IWorldPort *world) { world_ = world; }
+    // Decisions of the last onTick per action, indexed by AgentAction.
+    const std::array<std::size_t, kActionCount> &actionCounts() const { return action_counts_; }
+    // True when the compiled `rules` decide instead of the built-in list.
+    bool usesRules() const { return !rules_.empty(); }
+    const BehaviorProgram &rules() const { return rules_; }
+    const FlowField &foodField() const { return food_; }
+    const FlowField &dangerField() const { return danger_; }
+    // Actions for `lanes` agents whose features are in `registers` (BehaviorProgram layout, sized for
+    // rules().registerCount() when rules are used). Built-in list: prey sensed -> hunt, predator sensed
+    // -> flee, energy >= reproduce_energy -> reproduce, otherwise predators move and prey forage.
+    void decide(float *registers, std::size_t lanes, AgentAction *actions) const;
+
 private:
+    // Per chunk, so tasks never share scratch; reused across ticks.
+    struct Scratch {
+        std::vector<Neighbor> nearby;
+        std::vector<float> registers;
+        // Nearest sensed prey / predator per lane; row is kNoRow when there is none.
+        std::vector<Neighbor> prey;
+        std::vector<Neighbor> threat;
+        std::vector<AgentAction> actions;
+        std::array<std::size_t, kActionCount> counts{};
+    };
+
+    static constexpr std::uint32_t kNoRow = 0xffffffffu;
+
+    void refreshSpecies();
+    void updateFlowFields();
+    bool isPredator(SpeciesId species) const { return species < predator_.size() && predator_[species] != 0; }
+    void decideChunk(std::size_t chunk);
+    void sense(std::size_t begin, std::size_t lanes, Scratch &scratch) const;
+    void emit(std::size_t begin, std::size_t lanes, Scratch &scratch) const;
+
     std::string type_id_;
     std::string instance_id_;
     ModuleContext &context_;
+    IWorldPort *world_ = nullptr;
+    std::vector<std::string> predator_names_{"wolf"};
+    // Per SpeciesId, rebuilt when the world's species table grows.
+    std::vector<std::uint8_t> predator_;
+    float sense_radius_ = 5.0f;
+    std::size_t neighbors_ = 8;
+    float speed_ = 1.0f;
+    float hunt_range_ = 1.0f;
+    float reproduce_energy_ = 4.0f;
+    std::size_t flow_cells_ = 128;
+    float food_level_ = 0.5f;
+    std::string rules_source_;
+    BehaviorProgram rules_;
+    std::uint32_t wander_stream_;
+    AgentIntent *intents_ = nullptr;
+    FlowField food_{FlowField::Mode::Toward};
+    FlowField danger_{FlowField::Mode::Away};
+    float flow_world_size_ = 0.0f;
+    // Source flags of the field being refreshed; reused across ticks.
+    std::vector<std::uint8_t> flow_sources_;
+    std::vector<Scratch> scratch_;
+    std::array<std::size_t, kActionCount> action_counts_{};
 };
 
 } // namespace ecosim
@@ -0,0 +1,434 @@
+#include "modules/agent_kernels.h"
+
+#include "core/cpu_features.h"
+
+#include <algorithm>
+#include <bitset>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ECOSIM_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ECOSIM_TARGET(features) __attribute__((target(features)))
+#else
+#define ECOSIM_TARGET(features)
+#endif
+
+namespace ecosim {
+
+namespace {
+constexpr std::size_t kLanes = 16;
+
+std::uint32_t ageLimit(const MetabolismParams &params) {
+    return params.max_age != 0 ? params.max_age : std::numeric_limits<std::uint32_t>::max();
+}
+
+// Shared by every path: finishes rows [begin, count) and folds the lanes. `result` carries the
+// vector part's min, max and deaths.
+MetabolismResult finish(float *energy, std::uint32_t *age, std::uint8_t *alive, std::size_t begin,
+                        std::size_t count, const MetabolismParams &params, double *lanes, MetabolismResult result) {
+    const std::uint32_t limit = ageLimit(params);
+    for (std::size_t i = begin; i < count; ++i) {
+        std::uint32_t next_age = age[i] + 1;
+        float next_energy = energy[i] - params.decay;
+        bool live = alive[i] != 0 && next_energy > 0.0f && next_age <= limit;
+        result.deaths += alive[i] != 0 && !live;
+        age[i] = next_age;
+        energy[i] = live ? next_energy : 0.0f;
+        alive[i] = live ? 1 : 0;
+        lanes[i % kLanes] += static_cast<double>(energy[i]);
+        if (live) {
+            result.energy_min = std::min(result.energy_min, next_energy);
+            result.energy_max = std::max(result.energy_max, next_energy);
+        }
+    }
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        result.energy_total += lanes[lane];
+    }
+    return result;
+}
+
+MetabolismResult metabolismScalar(float *energy, std::uint32_t *age, std::uint8_t *alive, std::size_t count,
+                                  const MetabolismParams &params) {
+    double lanes[kLanes] = {};
+    return finish(energy, age, alive, 0, count, params, lanes, MetabolismResult());
+}
+
+double foldLanes(const double *lanes) {
+    double sum = 0.0;
+    for (std::size_t lane = 0; lane < kInteractionLanes; ++lane) {
+        sum += lanes[lane];
+    }
+    return sum;
+}
+
+void interactionScalar(const double *matrix, std::size_t stride, std::size_t rows, const double *x, double *out) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        const double *a = matrix + row * stride;
+        double lanes[kInteractionLanes] = {};
+        for (std::size_t j = 0; j < stride; j += kInteractionLanes) {
+            for (std::size_t lane = 0; lane < kInteractionLanes; ++lane) {
+                double product = a[j + lane] * x[j + lane];
+                lanes[lane] += product;
+            }
+        }
+        out[row] = foldLanes(lanes);
+    }
+}
+
+float resourceCell(float above, float below, float left, float centre, float right, const ResourceParams &params,
+                   float inverse_capacity) {
+    float laplacian = ((above + below) + (left + right)) - 4.0f * centre;
+    float value = centre + params.diffusion * laplacian;
+    value = value + params.growth * (value * (1.0f - value * inverse_capacity));
+    value = value > 0.0f ? value : 0.0f;
+    return value < params.capacity ? value : params.capacity;
+}
+
+// Cells [begin, end) of a row; shared by every path for the border cells and the tail.
+void resourceCells(const float *above, const float *row, const float *below, float *out, std::size_t width,
+                   std::size_t begin, std::size_t end, const ResourceParams &params) {
+    const float inverse_capacity = 1.0f / params.capacity;
+    for (std::size_t j = begin; j < end; ++j) {
+        float left = row[j > 0 ? j - 1 : j];
+        float right = row[j + 1 < width ? j + 1 : j];
+        out[j] = resourceCell(above[j], below[j], left, row[j], right, params, inverse_capacity);
+    }
+}
+
+void resourceScalar(const float *above, const float *row, const float *below, float *out, std::size_t width,
+                    const ResourceParams &params) {
+    resourceCells(above, row, below, out, width, 0, width, params);
+}
+
+#ifdef ECOSIM_KERNELS_X86
+std::size_t popcount(unsigned bits) {
+    return std::bitset<32>(bits).count();
+}
+
+ECOSIM_TARGET("avx2")
+MetabolismResult metabolismAvx2(float *energy, std::uint32_t *age, std::uint8_t *alive, std::size_t count,
+                                const MetabolismParams &params) {
+    const __m256 decay = _mm256_set1_ps(params.decay);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i limit = _mm256_set1_epi32(static_cast<int>(ageLimit(params)));
+    const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 neg_inf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256 low = inf;
+    __m256 high = neg_inf;
+    std::size_t deaths = 0;
+    std::size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        for (std::size_t half = 0; half < 2; ++half) {
+            const std::size_t base = i + half * 8;
+            __m256i next_age = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(age + base)), one);
+            __m256 next_energy = _mm256_sub_ps(_mm256_loadu_ps(energy + base), decay);
+            __m256i was_alive = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(alive + base)));
+            __m256 alive_mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(was_alive, _mm256_setzero_si256()));
+            __m256 age_ok = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_min_epu32(next_age, limit), next_age));
+            __m256 live = _mm256_and_ps(_mm256_and_ps(alive_mask, age_ok), _mm256_cmp_ps(next_energy, zero, _CMP_GT_OQ));
+            __m256 kept = _mm256_and_ps(next_energy, live);
+            low = _mm256_min_ps(low, _mm256_blendv_ps(inf, next_energy, live));
+            high = _mm256_max_ps(high, _mm256_blendv_ps(neg_inf, next_energy, live));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(age + base), next_age);
+            _mm256_storeu_ps(energy + base, kept);
+            unsigned live_bits = static_cast<unsigned>(_mm256_movemask_ps(live));
+            unsigned alive_bits = static_cast<unsigned>(_mm256_movemask_ps(alive_mask));
+            deaths += popcount(alive_bits & ~live_bits);
+            for (std::size_t j = 0; j < 8; ++j) {
+                alive[base + j] = static_cast<std::uint8_t>((live_bits >> j) & 1u);
+            }
+            acc[half * 2] = _mm256_add_pd(acc[half * 2], _mm256_cvtps_pd(_mm256_castps256_ps128(kept)));
+            acc[half * 2 + 1] = _mm256_add_pd(acc[half * 2 + 1], _mm256_cvtps_pd(_mm256_extractf128_ps(kept, 1)));
+        }
+    }
+    double lanes[kLanes];
+    for (std::size_t k = 0; k < 4; ++k) {
+        _mm256_storeu_pd(lanes + k * 4, acc[k]);
+    }
+    float lows[8];
+    float highs[8];
+    _mm256_storeu_ps(lows, low);
+    _mm256_storeu_ps(highs, high);
+    MetabolismResult result;
+    result.energy_min = *std::min_element(lows, lows + 8);
+    result.energy_max = *std::max_element(highs, highs + 8);
+    result.deaths = deaths;
+    return finish(energy, age, alive, i, count, params, lanes, result);
+}
+
+ECOSIM_TARGET("avx512f")
+MetabolismResult metabolismAvx512(float *energy, std::uint32_t *age, std::uint8_t *alive, std::size_t count,
+                                  const MetabolismParams &params) {
+    const __m512 decay = _mm512_set1_ps(params.decay);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i limit = _mm512_set1_epi32(static_cast<int>(ageLimit(params)));
+    __m512d acc_low = _mm512_setzero_pd();
+    __m512d acc_high = _mm512_setzero_pd();
+    __m512 low = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+    __m512 high = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+    std::size_t deaths = 0;
+    std::size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        __m512i next_age = _mm512_add_epi32(_mm512_loadu_si512(age + i), one);
+        __m512 next_energy = _mm512_sub_ps(_mm512_loadu_ps(energy + i), decay);
+        __m512i was_alive = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(alive + i)));
+        __mmask16 alive_mask = _mm512_test_epi32_mask(was_alive, was_alive);
+        __mmask16 live = alive_mask & _mm512_cmple_epu32_mask(next_age, limit) &
+                         _mm512_cmp_ps_mask(next_energy, zero, _CMP_GT_OQ);
+        __m512 kept = _mm512_maskz_mov_ps(live, next_energy);
+        low = _mm512_mask_min_ps(low, live, low, next_energy);
+        high = _mm512_mask_max_ps(high, live, high, next_energy);
+
+        _mm512_storeu_si512(age + i, next_age);
+        _mm512_storeu_ps(energy + i, kept);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(alive + i), _mm512_cvtepi32_epi8(_mm512_maskz_set1_epi32(live, 1)));
+        deaths += popcount(static_cast<unsigned>(alive_mask & ~live) & 0xffffu);
+        acc_low = _mm512_add_pd(acc_low, _mm512_cvtps_pd(_mm512_castps512_ps256(kept)));
+        acc_high = _mm512_add_pd(
+            acc_high, _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(kept), 1))));
+    }
+    double lanes[kLanes];
+    _mm512_storeu_pd(lanes, acc_low);
+    _mm512_storeu_pd(lanes + 8, acc_high);
+    MetabolismResult result;
+    result.energy_min = _mm512_reduce_min_ps(low);
+    result.energy_max = _mm512_reduce_max_ps(high);
+    result.deaths = deaths;
+    return finish(energy, age, alive, i, count, params, lanes, result);
+}
+
+// Two rows per pass share the loads of x.
+ECOSIM_TARGET("avx2")
+void interactionAvx2(const double *matrix, std::size_t stride, std::size_t rows, const double *x, double *out) {
+    std::size_t row = 0;
+    for (; row + 2 <= rows; row += 2) {
+        const double *a = matrix + row * stride;
+        const double *b = a + stride;
+        __m256d a_low = _mm256_setzero_pd();
+        __m256d a_high = _mm256_setzero_pd();
+        __m256d b_low = _mm256_setzero_pd();
+        __m256d b_high = _mm256_setzero_pd();
+        for (std::size_t j = 0; j < stride; j += kInteractionLanes) {
+            __m256d x_low = _mm256_loadu_pd(x + j);
+            __m256d x_high = _mm256_loadu_pd(x + j + 4);
+            a_low = _mm256_add_pd(a_low, _mm256_mul_pd(_mm256_loadu_pd(a + j), x_low));
+            a_high = _mm256_add_pd(a_high, _mm256_mul_pd(_mm256_loadu_pd(a + j + 4), x_high));
+            b_low = _mm256_add_pd(b_low, _mm256_mul_pd(_mm256_loadu_pd(b + j), x_low));
+            b_high = _mm256_add_pd(b_high, _mm256_mul_pd(_mm256_loadu_pd(b + j + 4), x_high));
+        }
+        double lanes[kInteractionLanes];
+        _mm256_storeu_pd(lanes, a_low);
+        _mm256_storeu_pd(lanes + 4, a_high);
+        out[row] = foldLanes(lanes);
+        _mm256_storeu_pd(lanes, b_low);
+        _mm256_storeu_pd(lanes + 4, b_high);
+        out[row + 1] = foldLanes(lanes);
+    }
+    if (row < rows) {
+        interactionScalar(matrix + row * stride, stride, rows - row, x, out + row);
+    }
+}
+
+ECOSIM_TARGET("avx512f")
+void interactionAvx512(const double *matrix, std::size_t stride, std::size_t rows, const double *x, double *out) {
+    std::size_t row = 0;
+    for (; row + 2 <= rows; row += 2) {
+        const double *a = matrix + row * stride;
+        const double *b = a + stride;
+        __m512d a_acc = _mm512_setzero_pd();
+        __m512d b_acc = _mm512_setzero_pd();
+        for (std::size_t j = 0; j < stride; j += kInteractionLanes) {
+            __m512d xs = _mm512_loadu_pd(x + j);
+            a_acc = _mm512_add_pd(a_acc, _mm512_mul_pd(_mm512_loadu_pd(a + j), xs));
+            b_acc = _mm512_add_pd(b_acc, _mm512_mul_pd(_mm512_loadu_pd(b + j), xs));
+        }
+        double lanes[kInteractionLanes];
+        _mm512_storeu_pd(lanes, a_acc);
+        out[row] = foldLanes(lanes);
+        _mm512_storeu_pd(lanes, b_acc);
+        out[row + 1] = foldLanes(lanes);
+    }
+    if (row < rows) {
+        interactionScalar(matrix + row * stride, stride, rows - row, x, out + row);
+    }
+}
+
+// Interior cells [1, width - 1) in vectors; the border cells and the tail go through resourceCells.
+ECOSIM_TARGET("avx2")
+void resourceAvx2(const float *above, const float *row, const float *below, float *out, std::size_t width,
+                  const ResourceParams &params) {
+    if (width < 2) {
+        resourceCells(above, row, below, out, width, 0, width, params);
+        return;
+    }
+    const __m256 growth = _mm256_set1_ps(params.growth);
+    const __m256 diffusion = _mm256_set1_ps(params.diffusion);
+    const __m256 capacity = _mm256_set1_ps(params.capacity);
+    const __m256 inverse_capacity = _mm256_set1_ps(1.0f / params.capacity);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    resourceCells(above, row, below, out, width, 0, 1, params);
+    std::size_t j = 1;
+    for (; j + 8 < width; j += 8) {
+        __m256 centre = _mm256_loadu_ps(row + j);
+        __m256 sides = _mm256_add_ps(_mm256_loadu_ps(row + j - 1), _mm256_loadu_ps(row + j + 1));
+        __m256 vertical = _mm256_add_ps(_mm256_loadu_ps(above + j), _mm256_loadu_ps(below + j));
+        __m256 laplacian = _mm256_sub_ps(_mm256_add_ps(vertical, sides), _mm256_mul_ps(four, centre));
+        __m256 value = _mm256_add_ps(centre, _mm256_mul_ps(diffusion, laplacian));
+        __m256 room = _mm256_sub_ps(one, _mm256_mul_ps(value, inverse_capacity));
+        value = _mm256_add_ps(value, _mm256_mul_ps(growth, _mm256_mul_ps(value, room)));
+        _mm256_storeu_ps(out + j, _mm256_min_ps(_mm256_max_ps(value, zero), capacity));
+    }
+    resourceCells(above, row, below, out, width, j, width, params);
+}
+
+ECOSIM_TARGET("avx512f")
+void resourceAvx512(const float *above, const float *row, const float *below, float *out, std::size_t width,
+                    const ResourceParams &params) {
+    if (width < 2) {
+        resourceCells(above, row, below, out, width, 0, width, params);
+        return;
+    }
+    const __m512 growth = _mm512_set1_ps(params.growth);
+    const __m512 diffusion = _mm512_set1_ps(params.diffusion);
+    const __m512 capacity = _mm512_set1_ps(params.capacity);
+    const __m512 inverse_capacity = _mm512_set1_ps(1.0f / params.capacity);
+    const __m512 four = _mm512_set1_ps(4.0f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 zero = _mm512_setzero_ps();
+    resourceCells(above, row, below, out, width, 0, 1, params);
+    std::size_t j = 1;
+    for (; j + 16 < width; j += 16) {
+        __m512 centre = _mm512_loadu_ps(row + j);
+        __m512 sides = _mm512_add_ps(_mm512_loadu_ps(row + j - 1), _mm512_loadu_ps(row + j + 1));
+        __m512 vertical = _mm512_add_ps(_mm512_loadu_ps(above + j), _mm512_loadu_ps(below + j));
+        __m512 laplacian = _mm512_sub_ps(_mm512_add_ps(vertical, sides), _mm512_mul_ps(four, centre));
+        __m512 value = _mm512_add_ps(centre, _mm512_mul_ps(diffusion, laplacian));
+        __m512 room = _mm512_sub_ps(one, _mm512_mul_ps(value, inverse_capacity));
+        value = _mm512_add_ps(value, _mm512_mul_ps(growth, _mm512_mul_ps(value, room)));
+        _mm512_storeu_ps(out + j, _mm512_min_ps(_mm512_max_ps(value, zero), capacity));
+    }
+    resourceCells(above, row, below, out, width, j, width, params);
+}
+
+#endif
+} // namespace
+
+bool kernelSupported(KernelPath path) {
+    switch (path) {
+    case KernelPath::Scalar:
+        return true;
+#ifdef ECOSIM_KERNELS_X86
+    case KernelPath::Avx2:
+        return detectCpuFeatures().avx2;
+    case KernelPath::Avx512:
+        return detectCpuFeatures().avx512;
+#else
+    default:
+        return false;
+#endif
+    }
+    return false;
+}
+
+KernelPath bestKernelPath() {
+    if (kernelSupported(KernelPath::Avx512)) {
+        return KernelPath::Avx512;
+    }
+    if (kernelSupported(KernelPath::Avx2)) {
+        return KernelPath::Avx2;
+    }
+    return KernelPath::Scalar;
+}
+
+MetabolismKernel metabolismKernel(KernelPath path) {
+    if (!kernelSupported(path)) {
+        return nullptr;
+    }
+    switch (path) {
+    case KernelPath::Scalar:
+        return metabolismScalar;
+#ifdef ECOSIM_KERNELS_X86
+    case KernelPath::Avx2:
+        return metabolismAvx2;
+    case KernelPath::Avx512:
+        return metabolismAvx512;
+#else
+    default:
+        return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+InteractionKernel interactionKernel(KernelPath path) {
+    if (!kernelSupported(path)) {
+        return nullptr;
+    }
+    switch (path) {
+    case KernelPath::Scalar:
+        return interactionScalar;
+#ifdef ECOSIM_KERNELS_X86
+    case KernelPath::Avx2:
+        return interactionAvx2;
+    case KernelPath::Avx512:
+        return interactionAvx512;
+#else
+    default:
+        return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+ResourceKernel resourceKernel(KernelPath path) {
+    if (!kernelSupported(path)) {
+        return nullptr;
+    }
+    switch (path) {
+    case KernelPath::Scalar:
+        return resourceScalar;
+#ifdef ECOSIM_KERNELS_X86
+    case KernelPath::Avx2:
+        return resourceAvx2;
+    case KernelPath::Avx512:
+        return resourceAvx512;
+#else
+    default:
+        return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+const char *kernelPathName(KernelPath path) {
+    switch (path) {
+    case KernelPath::Scalar:
+        return "scalar";
+    case KernelPath::Avx2:
+        return "avx2";
+    case KernelPath::Avx512:
+        return "avx512";
+    }
+    return "scalar";
+}
+
+KernelPath parseKernelPath(const std::string &name) {
+    for (auto path : {KernelPath::Scalar, KernelPath::Avx2, KernelPath::Avx512}) {
+        if (name == kernelPathName(path) && kernelSupported(path)) {
+            return path;
+        }
+    }
+    return bestKernelPath();
+}
+
+} // namespace ecosim
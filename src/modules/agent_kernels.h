@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace ecosim {
+
+enum class KernelPath { Scalar, Avx2, Avx512 };
+
+struct MetabolismParams {
+    float decay = 0.0f;
+    // 0 = agents do not die of age.
+    std::uint32_t max_age = 0;
+};
+
+struct MetabolismResult {
+    double energy_total = 0.0;
+    // Over survivors; +inf / -inf when none survive.
+    float energy_min = std::numeric_limits<float>::infinity();
+    float energy_max = -std::numeric_limits<float>::infinity();
+    std::size_t deaths = 0;
+};
+
+// One fused pass over the agent columns: age += 1, energy -= decay, then an agent dies (alive = 0,
+// energy = 0) if its energy is not positive or its age exceeds max_age; returns the total, minimum and
+// maximum energy of the survivors and the number of deaths. Every path sums in the same 16 double lanes (element i goes to
+// lane i % 16, lanes added in order at the end), so all paths are bit-identical.
+using MetabolismKernel = MetabolismResult (*)(float *energy, std::uint32_t *age, std::uint8_t *alive,
+                                              std::size_t count, const MetabolismParams &params);
+
+// Dense matrix-vector product for population dynamics: out[i] = sum_j matrix[i * stride + j] * x[j]
+// for rows [0, rows). `stride` is a multiple of kInteractionLanes and x holds `stride` values (zero
+// padded). Products go to lane j % 8 without FMA and the lanes are added in order, so every path is
+// bit-identical.
+constexpr std::size_t kInteractionLanes = 8;
+using InteractionKernel = void (*)(const double *matrix, std::size_t stride, std::size_t rows, const double *x,
+                                   double *out);
+
+struct ResourceParams {
+    float growth = 0.0f;
+    // Share of a cell exchanged with each of its four neighbours per tick; stable up to 0.25.
+    float diffusion = 0.0f;
+    float capacity = 1.0f;
+};
+
+// One row of the resource field stencil: out[j] from row[j - 1..j + 1], above[j] and below[j].
+//   v = c + diffusion * (((above + below) + (left + right)) - 4c)
+//   v = v + growth * (v * (1 - v / capacity)), clamped to [0, capacity]
+// The first and last cell stand in for their missing neighbour, so nothing flows out over the border.
+// Every path evaluates the same expression without FMA, so all paths are bit-identical.
+using ResourceKernel = void (*)(const float *above, const float *row, const float *below, float *out,
+                                std::size_t width, const ResourceParams &params);
+
+bool kernelSupported(KernelPath path);
+// Fastest path supported by the CPU (and the OS, for AVX register state).
+KernelPath bestKernelPath();
+// nullptr when the path is not supported on this machine.
+MetabolismKernel metabolismKernel(KernelPath path);
+InteractionKernel interactionKernel(KernelPath path);
+ResourceKernel resourceKernel(KernelPath path);
+const char *kernelPathName(KernelPath path);
+// "auto", "scalar", "avx2" or "avx512"; unknown or unsupported names resolve to bestKernelPath().
+KernelPath parseKernelPath(const std::string &name);
+
+} // namespace ecosim
@@ -0,0 +1,311 @@
+#include "modules/agent_store.h"
+
+#include <algorithm>
+
+namespace ecosim {
+
+namespace {
+template <typename T>
+void addColumn(SnapshotWriter &out, const std::string &name, const ChunkedColumn<T> &column) {
+    out.add(name, column.empty() ? nullptr : column.chunk(0), column.empty() ? 0 : column.chunkRows(0) * sizeof(T));
+    for (std::size_t chunk = 1; chunk < column.chunkCount(); ++chunk) {
+        out.append(column.chunk(chunk), column.chunkRows(chunk) * sizeof(T));
+    }
+}
+
+template <typename T>
+bool readColumn(const SnapshotReader &in, const std::string &name, ChunkedColumn<T> &column) {
+    auto section = in.find(name);
+    if (!section.data || section.size % sizeof(T) != 0) {
+        return false;
+    }
+    column.assign(static_cast<const T *>(section.data), section.size / sizeof(T));
+    return true;
+}
+
+template <typename T>
+void copyRow(ChunkedColumn<T> &column, std::size_t from, std::size_t to) {
+    T value = column[from];
+    column.mutableAt(to) = value;
+}
+} // namespace
+
+AgentStore::AgentStore(const AgentStore &other)
+    : species_(other.species_), x_(other.x_), y_(other.y_), energy_(other.energy_), age_(other.age_),
+      alive_(other.alive_), slot_of_row_(other.slot_of_row_), slots_(other.slots_), free_slots_(other.free_slots_),
+      counts_(other.counts_), dead_(other.dead_) {}
+
+AgentStore &AgentStore::operator=(const AgentStore &other) {
+    if (this != &other) {
+        species_ = other.species_;
+        x_ = other.x_;
+        y_ = other.y_;
+        energy_ = other.energy_;
+        age_ = other.age_;
+        alive_ = other.alive_;
+        slot_of_row_ = other.slot_of_row_;
+        slots_ = other.slots_;
+        free_slots_ = other.free_slots_;
+        counts_ = other.counts_;
+        dead_ = other.dead_;
+    }
+    return *this;
+}
+
+void AgentStore::reserve(std::size_t count) {
+    species_.reserve(count);
+    x_.reserve(count);
+    y_.reserve(count);
+    energy_.reserve(count);
+    age_.reserve(count);
+    alive_.reserve(count);
+    slot_of_row_.reserve(count);
+    slots_.reserve(count);
+}
+
+void AgentStore::clear() {
+    species_.clear();
+    x_.clear();
+    y_.clear();
+    energy_.clear();
+    age_.clear();
+    alive_.clear();
+    slot_of_row_.clear();
+    slots_.clear();
+    free_slots_.clear();
+    counts_.clear();
+    dead_ = 0;
+}
+
+AgentHandle AgentStore::spawn(SpeciesId species, float x, float y, float energy) {
+    std::uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back({});
+    }
+    slots_.mutableAt(slot).row = static_cast<std::uint32_t>(species_.size());
+
+    species_.push_back(species);
+    x_.push_back(x);
+    y_.push_back(y);
+    energy_.push_back(energy);
+    age_.push_back(0);
+    alive_.push_back(1);
+    slot_of_row_.push_back(slot);
+
+    if (counts_.size() <= species) {
+        counts_.resize(species + 1, 0);
+    }
+    ++counts_[species];
+    return {slot, slots_[slot].generation};
+}
+
+void AgentStore::kill(std::size_t row) {
+    if (!alive_[row]) {
+        return;
+    }
+    alive_.mutableAt(row) = 0;
+    --counts_[species_[row]];
+    ++dead_;
+}
+
+bool AgentStore::remove(AgentHandle handle) {
+    if (!valid(handle)) {
+        return false;
+    }
+    auto target = row(handle);
+    if (alive_[target]) {
+        --counts_[species_[target]];
+    } else {
+        --dead_;
+    }
+    moveRow(species_.size() - 1, target);
+    popRow();
+    return true;
+}
+
+std::size_t AgentStore::compact() {
+    if (dead_ == 0) {
+        return 0;
+    }
+    std::size_t removed = 0;
+    std::size_t row = 0;
+    while (row < species_.size()) {
+        if (alive_[row]) {
+            ++row;
+            continue;
+        }
+        moveRow(species_.size() - 1, row);
+        popRow();
+        ++removed;
+    }
+    dead_ = 0;
+    return removed;
+}
+
+std::size_t AgentStore::reapDead() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    dead_ = 0;
+    for (std::size_t chunk = 0; chunk < species_.chunkCount(); ++chunk) {
+        const SpeciesId *species = species_.chunk(chunk);
+        const std::uint8_t *alive = alive_.chunk(chunk);
+        for (std::size_t i = 0, rows = species_.chunkRows(chunk); i < rows; ++i) {
+            if (alive[i]) {
+                ++counts_[species[i]];
+            } else {
+                ++dead_;
+            }
+        }
+    }
+    return compact();
+}
+
+// Fills whole chunks of the scratch column, so chunks shared with a fork are replaced, never cloned.
+template <typename T>
+void AgentStore::permute(ChunkedColumn<T> &column, const std::vector<std::uint32_t> &order,
+                         ChunkedColumn<T> &scratch) {
+    scratch.resize(column.size());
+    for (std::size_t chunk = 0; chunk < scratch.chunkCount(); ++chunk) {
+        T *out = scratch.overwriteChunk(chunk);
+        const std::uint32_t *from = order.data() + chunk * kChunkRows;
+        for (std::size_t i = 0, rows = scratch.chunkRows(chunk); i < rows; ++i) {
+            out[i] = column[from[i]];
+        }
+    }
+    column.swap(scratch);
+}
+
+void AgentStore::reorder(const std::vector<std::uint32_t> &order) {
+    permute(species_, order, species_scratch_);
+    permute(x_, order, float_scratch_);
+    permute(y_, order, float_scratch_);
+    permute(energy_, order, float_scratch_);
+    permute(age_, order, index_scratch_);
+    permute(alive_, order, flag_scratch_);
+    permute(slot_of_row_, order, index_scratch_);
+    for (std::size_t row = 0; row < slot_of_row_.size(); ++row) {
+        slots_.mutableAt(slot_of_row_[row]).row = static_cast<std::uint32_t>(row);
+    }
+    // The scratch columns now hold the previous chunks; drop them so a fork sharing them is not
+    // charged a copy on its next write. Unshared chunks stay in the scratch columns' spare lists.
+    species_scratch_.clear();
+    float_scratch_.clear();
+    index_scratch_.clear();
+    flag_scratch_.clear();
+}
+
+void AgentStore::saveSnapshot(SnapshotWriter &out, const std::string &prefix) const {
+    addColumn(out, prefix + "species", species_);
+    addColumn(out, prefix + "x", x_);
+    addColumn(out, prefix + "y", y_);
+    addColumn(out, prefix + "energy", energy_);
+    addColumn(out, prefix + "age", age_);
+    addColumn(out, prefix + "alive", alive_);
+    addColumn(out, prefix + "slot_of_row", slot_of_row_);
+    addColumn(out, prefix + "slots", slots_);
+    addColumn(out, prefix + "free_slots", free_slots_);
+}
+
+bool AgentStore::restoreSnapshot(const SnapshotReader &in, const std::string &prefix, std::string &error) {
+    clear();
+    bool read = readColumn(in, prefix + "species", species_) && readColumn(in, prefix + "x", x_) &&
+                readColumn(in, prefix + "y", y_) && readColumn(in, prefix + "energy", energy_) &&
+                readColumn(in, prefix + "age", age_) && readColumn(in, prefix + "alive", alive_) &&
+                readColumn(in, prefix + "slot_of_row", slot_of_row_) && readColumn(in, prefix + "slots", slots_) &&
+                readColumn(in, prefix + "free_slots", free_slots_);
+    const std::size_t rows = species_.size();
+    bool consistent = read && x_.size() == rows && y_.size() == rows && energy_.size() == rows &&
+                      age_.size() == rows && alive_.size() == rows && slot_of_row_.size() == rows;
+    for (std::size_t row = 0; consistent && row < rows; ++row) {
+        consistent = slot_of_row_[row] < slots_.size() && slots_[slot_of_row_[row]].row == row &&
+                     species_[row] != SpeciesRegistry::kInvalid;
+    }
+    for (std::size_t i = 0; consistent && i < free_slots_.size(); ++i) {
+        consistent = free_slots_[i] < slots_.size();
+    }
+    if (!consistent) {
+        clear();
+        error = read ? "agent columns in snapshot are inconsistent" : "agent columns missing from snapshot";
+        return false;
+    }
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (counts_.size() <= species_[row]) {
+            counts_.resize(species_[row] + 1, 0);
+        }
+        if (alive_[row]) {
+            ++counts_[species_[row]];
+        } else {
+            ++dead_;
+        }
+    }
+    return true;
+}
+
+AgentStore::MemoryStats AgentStore::memory() const {
+    MemoryStats stats;
+    auto add = [&stats](std::size_t bytes, std::size_t shared) {
+        stats.bytes += bytes;
+        stats.shared_bytes += shared;
+    };
+    add(species_.bytes(), species_.sharedBytes());
+    add(x_.bytes(), x_.sharedBytes());
+    add(y_.bytes(), y_.sharedBytes());
+    add(energy_.bytes(), energy_.sharedBytes());
+    add(age_.bytes(), age_.sharedBytes());
+    add(alive_.bytes(), alive_.sharedBytes());
+    add(slot_of_row_.bytes(), slot_of_row_.sharedBytes());
+    add(slots_.bytes(), slots_.sharedBytes());
+    add(free_slots_.bytes(), free_slots_.sharedBytes());
+    return stats;
+}
+
+bool AgentStore::valid(AgentHandle handle) const {
+    if (handle.slot >= slots_.size()) {
+        return false;
+    }
+    const auto &slot = slots_[handle.slot];
+    return slot.generation == handle.generation && slot.row < species_.size() &&
+           slot_of_row_[slot.row] == handle.slot;
+}
+
+AgentHandle AgentStore::handle(std::size_t row) const {
+    auto slot = slot_of_row_[row];
+    return {slot, slots_[slot].generation};
+}
+
+// Copies row `from` over row `to`; the slot of `to` must be released by popRow() of the old last row.
+void AgentStore::moveRow(std::size_t from, std::size_t to) {
+    if (from == to) {
+        return;
+    }
+    auto released = slot_of_row_[to];
+    auto moved = slot_of_row_[from];
+    copyRow(species_, from, to);
+    copyRow(x_, from, to);
+    copyRow(y_, from, to);
+    copyRow(energy_, from, to);
+    copyRow(age_, from, to);
+    copyRow(alive_, from, to);
+    slot_of_row_.mutableAt(to) = moved;
+    slots_.mutableAt(moved).row = static_cast<std::uint32_t>(to);
+    slot_of_row_.mutableAt(from) = released;
+}
+
+// Drops the last row and frees the slot recorded for it.
+void AgentStore::popRow() {
+    auto slot = slot_of_row_.back();
+    ++slots_.mutableAt(slot).generation;
+    free_slots_.push_back(slot);
+    species_.pop_back();
+    x_.pop_back();
+    y_.pop_back();
+    energy_.pop_back();
+    age_.pop_back();
+    alive_.pop_back();
+    slot_of_row_.pop_back();
+}
+
+} // namespace ecosim
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "core/snapshot.h"
+#include "modules/chunked_column.h"
+#include "modules/species_registry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ecosim {
+
+struct AgentHandle {
+    std::uint32_t slot = 0;
+    std::uint32_t generation = 0;
+
+    bool operator==(const AgentHandle &other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const AgentHandle &other) const { return !(*this == other); }
+};
+
+// Agents stored as structure-of-arrays: one column per attribute, rows [0, size()), each column in
+// chunks of kChunkRows rows. Removal moves the last row into the hole (swap-remove), so rows are not
+// stable; handles are, through a slot table with generations that detects use after removal.
+//
+// Copying a store is a fork: the copy shares every chunk copy-on-write (ChunkedColumn), so it costs
+// O(chunks) and memory grows only with the chunks either side writes afterwards.
+class AgentStore {
+public:
+    static constexpr std::size_t kChunkRows = ChunkedColumn<float>::kChunkRows;
+
+    AgentStore() = default;
+    AgentStore(const AgentStore &other);
+    AgentStore &operator=(const AgentStore &other);
+
+    void reserve(std::size_t count);
+    void clear();
+
+    AgentHandle spawn(SpeciesId species, float x, float y, float energy);
+    // Marks the row dead; it stays in the columns until compact().
+    void kill(std::size_t row);
+    bool remove(AgentHandle handle);
+    // Swap-removes all dead rows; returns how many were removed.
+    std::size_t compact();
+    // Recounts species after alive flags were cleared through aliveChunk() (e.g. by a kernel) and
+    // compacts the dead rows away; returns how many were removed.
+    std::size_t reapDead();
+    // Permutes rows so that new row i holds old row order[i]; handles follow their agents.
+    void reorder(const std::vector<std::uint32_t> &order);
+
+    // Columns and the slot table as sections named `prefix` + column; handles stay valid across a
+    // save/restore. restoreSnapshot() checks that the sections are consistent and recounts species.
+    void saveSnapshot(SnapshotWriter &out, const std::string &prefix) const;
+    bool restoreSnapshot(const SnapshotReader &in, const std::string &prefix, std::string &error);
+
+    bool valid(AgentHandle handle) const;
+    std::size_t row(AgentHandle handle) const { return slots_[handle.slot].row; }
+    AgentHandle handle(std::size_t row) const;
+
+    std::size_t size() const { return species_.size(); }
+    bool empty() const { return species_.empty(); }
+    std::size_t chunkCount() const { return species_.chunkCount(); }
+    std::size_t chunkRows(std::size_t chunk) const { return species_.chunkRows(chunk); }
+    // Alive agents per species id.
+    std::size_t count(SpeciesId species) const { return species < counts_.size() ? counts_[species] : 0; }
+    const std::vector<std::size_t> &counts() const { return counts_; }
+
+    const ChunkedColumn<SpeciesId> &species() const { return species_; }
+    const ChunkedColumn<float> &x() const { return x_; }
+    const ChunkedColumn<float> &y() const { return y_; }
+    const ChunkedColumn<float> &energy() const { return energy_; }
+    const ChunkedColumn<std::uint32_t> &age() const { return age_; }
+    const ChunkedColumn<std::uint8_t> &alive() const { return alive_; }
+    // Writable rows of one chunk, unshared from forks first; distinct chunks may be written in parallel.
+    float *energyChunk(std::size_t chunk) { return energy_.mutableChunk(chunk); }
+    std::uint32_t *ageChunk(std::size_t chunk) { return age_.mutableChunk(chunk); }
+    std::uint8_t *aliveChunk(std::size_t chunk) { return alive_.mutableChunk(chunk); }
+    float *xChunk(std::size_t chunk) { return x_.mutableChunk(chunk); }
+    float *yChunk(std::size_t chunk) { return y_.mutableChunk(chunk); }
+
+    struct MemoryStats {
+        std::size_t bytes = 0;
+        // Part of `bytes` in chunks still shared with a parent or sibling fork.
+        std::size_t shared_bytes = 0;
+    };
+    MemoryStats memory() const;
+
+private:
+    struct Slot {
+        std::uint32_t row = 0;
+        std::uint32_t generation = 0;
+    };
+
+    void moveRow(std::size_t from, std::size_t to);
+    void popRow();
+    template <typename T>
+    void permute(ChunkedColumn<T> &column, const std::vector<std::uint32_t> &order, ChunkedColumn<T> &scratch);
+
+    ChunkedColumn<SpeciesId> species_;
+    ChunkedColumn<float> x_;
+    ChunkedColumn<float> y_;
+    ChunkedColumn<float> energy_;
+    ChunkedColumn<std::uint32_t> age_;
+    ChunkedColumn<std::uint8_t> alive_;
+    ChunkedColumn<std::uint32_t> slot_of_row_;
+    ChunkedColumn<Slot> slots_;
+    ChunkedColumn<std::uint32_t> free_slots_;
+    std::vector<std::size_t> counts_;
+    std::size_t dead_ = 0;
+    // Not copied by a fork.
+    ChunkedColumn<SpeciesId> species_scratch_;
+    ChunkedColumn<float> float_scratch_;
+    ChunkedColumn<std::uint32_t> index_scratch_;
+    ChunkedColumn<std::uint8_t> flag_scratch_;
+};
+
+} // namespace ecosim
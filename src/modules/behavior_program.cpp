@@ -0,0 +1,496 @@
+#include "modules/behavior_program.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace ecosim {
+
+namespace {
+constexpr auto kUndecided = static_cast<AgentAction>(0xffffffffu);
+
+const std::pair<const char *, BehaviorFeature> kFeatureNames[] = {
+    {"energy", BehaviorFeature::Energy},
+    {"age", BehaviorFeature::Age},
+    {"neighbors", BehaviorFeature::Neighbors},
+    {"prey", BehaviorFeature::Prey},
+    {"threats", BehaviorFeature::Threats},
+    {"prey_distance", BehaviorFeature::PreyDistance},
+    {"threat_distance", BehaviorFeature::ThreatDistance},
+    {"predator", BehaviorFeature::Predator},
+    {"random", BehaviorFeature::Random},
+};
+
+const std::pair<const char *, AgentAction> kActionNames[] = {
+    {"rest", AgentAction::Rest},     {"move", AgentAction::Move}, {"forage", AgentAction::Forage},
+    {"flee", AgentAction::Flee},     {"hunt", AgentAction::Hunt}, {"reproduce", AgentAction::Reproduce},
+};
+
+// Operands are tagged while a rule is parsed, because the final register of a constant or temporary
+// depends on how many constants the whole source has.
+enum class OperandKind : std::uint8_t { Feature, Constant, Temporary };
+
+struct Operand {
+    OperandKind kind = OperandKind::Feature;
+    std::size_t index = 0;
+};
+
+// Recursive descent over one rule; emits instructions with tagged operands.
+class RuleParser {
+public:
+    RuleParser(const std::string &text, std::vector<float> &constants,
+               std::vector<std::pair<std::size_t, std::string>> &species)
+        : text_(text), constants_(constants), species_(species) {}
+
+    // Appends the rule's ops and their dst/a/b operands (tagged); `temporaries` is raised to the number
+    // the rule needs.
+    bool parse(std::vector<BehaviorProgram::Op> &ops, std::vector<Operand> &operands, std::size_t &temporaries,
+               std::string &error) {
+        ops_ = &ops;
+        operands_ = &operands;
+        Operand condition;
+        if (!parseOr(condition)) {
+            error = error_;
+            return false;
+        }
+        skipSpaces();
+        if (text_.compare(pos_, 2, "->") != 0) {
+            error = "expected '->' at '" + rest() + "'";
+            return false;
+        }
+        pos_ += 2;
+        const std::string action = word();
+        skipSpaces();
+        if (pos_ != text_.size()) {
+            error = "unexpected '" + rest() + "' after the action";
+            return false;
+        }
+        auto found = std::find_if(std::begin(kActionNames), std::end(kActionNames),
+                                  [&](const auto &entry) { return action == entry.first; });
+        if (found == std::end(kActionNames)) {
+            error = "unknown action '" + action + "'";
+            return false;
+        }
+        emit(BehaviorProgram::Op::Choose, {OperandKind::Constant, static_cast<std::size_t>(found->second)},
+             condition, condition);
+        temporaries = std::max(temporaries, peak_);
+        return true;
+    }
+
+private:
+    void skipSpaces() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    std::string rest() const { return text_.substr(pos_); }
+
+    std::string word() {
+        skipSpaces();
+        std::size_t start = pos_;
+        while (pos_ < text_.size() &&
+               (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_' || text_[pos_] == '.')) {
+            ++pos_;
+        }
+        return text_.substr(start, pos_ - start);
+    }
+
+    // Consumes `token` if it comes next; keywords must not run into a following name.
+    bool accept(const char *token) {
+        skipSpaces();
+        const std::size_t length = std::char_traits<char>::length(token);
+        if (text_.compare(pos_, length, token) != 0) {
+            return false;
+        }
+        if (std::isalpha(static_cast<unsigned char>(token[0])) && pos_ + length < text_.size() &&
+            (std::isalnum(static_cast<unsigned char>(text_[pos_ + length])) || text_[pos_ + length] == '_')) {
+            return false;
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool fail(const std::string &message) {
+        if (error_.empty()) {
+            error_ = message;
+        }
+        return false;
+    }
+
+    Operand constant(float value) {
+        constants_.push_back(value);
+        return {OperandKind::Constant, constants_.size() - 1};
+    }
+
+    // Temporaries are a stack: operands are released before the result is allocated, so the result
+    // may reuse an operand's register (every op reads lane i before writing it).
+    void release(const Operand &operand) {
+        if (operand.kind == OperandKind::Temporary) {
+            --next_;
+        }
+    }
+
+    Operand emit(BehaviorProgram::Op op, Operand dst, Operand a, Operand b) {
+        ops_->push_back(op);
+        operands_->insert(operands_->end(), {dst, a, b});
+        return dst;
+    }
+
+    Operand emitResult(BehaviorProgram::Op op, Operand a, Operand b) {
+        release(b);
+        release(a);
+        Operand dst{OperandKind::Temporary, next_++};
+        peak_ = std::max(peak_, next_);
+        return emit(op, dst, a, b);
+    }
+
+    Operand emitUnary(BehaviorProgram::Op op, Operand a) {
+        release(a);
+        Operand dst{OperandKind::Temporary, next_++};
+        peak_ = std::max(peak_, next_);
+        return emit(op, dst, a, a);
+    }
+
+    bool parseOr(Operand &out) {
+        if (!parseAnd(out)) {
+            return false;
+        }
+        while (accept("or") || accept("||")) {
+            Operand rhs;
+            if (!parseAnd(rhs)) {
+                return false;
+            }
+            out = emitResult(BehaviorProgram::Op::Or, out, rhs);
+        }
+        return true;
+    }
+
+    bool parseAnd(Operand &out) {
+        if (!parseNot(out)) {
+            return false;
+        }
+        while (accept("and") || accept("&&")) {
+            Operand rhs;
+            if (!parseNot(rhs)) {
+                return false;
+            }
+            out = emitResult(BehaviorProgram::Op::And, out, rhs);
+        }
+        return true;
+    }
+
+    bool parseNot(Operand &out) {
+        skipSpaces();
+        if (accept("not") || (text_.compare(pos_, 2, "!=") != 0 && accept("!"))) {
+            if (!parseNot(out)) {
+                return false;
+            }
+            out = emitUnary(BehaviorProgram::Op::Not, out);
+            return true;
+        }
+        return parseComparison(out);
+    }
+
+    bool parseComparison(Operand &out) {
+        if (!parseSum(out)) {
+            return false;
+        }
+        static const std::pair<const char *, BehaviorProgram::Op> kComparisons[] = {
+            {"<=", BehaviorProgram::Op::LessEqual}, {">=", BehaviorProgram::Op::GreaterEqual},
+            {"==", BehaviorProgram::Op::Equal},     {"!=", BehaviorProgram::Op::NotEqual},
+            {"<", BehaviorProgram::Op::Less},       {">", BehaviorProgram::Op::Greater},
+        };
+        for (const auto &comparison : kComparisons) {
+            if (accept(comparison.first)) {
+                Operand rhs;
+                if (!parseSum(rhs)) {
+                    return false;
+                }
+                out = emitResult(comparison.second, out, rhs);
+                return true;
+            }
+        }
+        return true;
+    }
+
+    bool parseSum(Operand &out) {
+        if (!parseProduct(out)) {
+            return false;
+        }
+        for (;;) {
+            skipSpaces();
+            BehaviorProgram::Op op;
+            if (text_.compare(pos_, 2, "->") != 0 && accept("-")) {
+                op = BehaviorProgram::Op::Subtract;
+            } else if (accept("+")) {
+                op = BehaviorProgram::Op::Add;
+            } else {
+                return true;
+            }
+            Operand rhs;
+            if (!parseProduct(rhs)) {
+                return false;
+            }
+            out = emitResult(op, out, rhs);
+        }
+    }
+
+    bool parseProduct(Operand &out) {
+        if (!parseUnary(out)) {
+            return false;
+        }
+        for (;;) {
+            BehaviorProgram::Op op;
+            if (accept("*")) {
+                op = BehaviorProgram::Op::Multiply;
+            } else if (accept("/")) {
+                op = BehaviorProgram::Op::Divide;
+            } else {
+                return true;
+            }
+            Operand rhs;
+            if (!parseUnary(rhs)) {
+                return false;
+            }
+            out = emitResult(op, out, rhs);
+        }
+    }
+
+    bool parseUnary(Operand &out) {
+        skipSpaces();
+        if (text_.compare(pos_, 2, "->") != 0 && accept("-")) {
+            if (!parseUnary(out)) {
+                return false;
+            }
+            // Only literals are constant operands here (species ids are compared, never negated).
+            if (out.kind == OperandKind::Constant) {
+                constants_[out.index] = -constants_[out.index];
+                return true;
+            }
+            out = emitUnary(BehaviorProgram::Op::Negate, out);
+            return true;
+        }
+        return parsePrimary(out);
+    }
+
+    bool parsePrimary(Operand &out) {
+        skipSpaces();
+        if (accept("(")) {
+            if (!parseOr(out)) {
+                return false;
+            }
+            return accept(")") || fail("expected ')' at '" + rest() + "'");
+        }
+        if (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '.')) {
+            const char *start = text_.c_str() + pos_;
+            char *end = nullptr;
+            const float value = std::strtof(start, &end);
+            pos_ += static_cast<std::size_t>(end - start);
+            out = constant(value);
+            return true;
+        }
+        const std::string name = word();
+        if (name.empty()) {
+            return fail(pos_ < text_.size() ? "unexpected '" + rest() + "'" : "expression expected");
+        }
+        if (name == "true" || name == "false") {
+            out = constant(name == "true" ? 1.0f : 0.0f);
+            return true;
+        }
+        if (name.compare(0, 8, "species.") == 0 && name.size() > 8) {
+            Operand id = constant(static_cast<float>(SpeciesRegistry::kInvalid));
+            species_.emplace_back(id.index, name.substr(8));
+            out = emitResult(BehaviorProgram::Op::Equal,
+                             {OperandKind::Feature, static_cast<std::size_t>(BehaviorFeature::Species)}, id);
+            return true;
+        }
+        auto found = std::find_if(std::begin(kFeatureNames), std::end(kFeatureNames),
+                                  [&](const auto &entry) { return name == entry.first; });
+        if (found == std::end(kFeatureNames)) {
+            return fail("unknown name '" + name + "'");
+        }
+        out = {OperandKind::Feature, static_cast<std::size_t>(found->second)};
+        return true;
+    }
+
+    const std::string &text_;
+    std::size_t pos_ = 0;
+    std::vector<float> &constants_;
+    std::vector<std::pair<std::size_t, std::string>> &species_;
+    std::vector<BehaviorProgram::Op> *ops_ = nullptr;
+    std::vector<Operand> *operands_ = nullptr;
+    std::size_t next_ = 0;
+    std::size_t peak_ = 0;
+    std::string error_;
+};
+} // namespace
+
+bool BehaviorProgram::compile(const std::string &source, std::string &error) {
+    instructions_.clear();
+    constants_.clear();
+    species_constants_.clear();
+    temporaries_ = 0;
+    rules_ = 0;
+
+    std::vector<Op> ops;
+    std::vector<Operand> operands;
+    std::vector<float> constants;
+    std::vector<std::pair<std::size_t, std::string>> species;
+    std::size_t temporaries = 0;
+    std::size_t rules = 0;
+    std::size_t start = 0;
+    while (start <= source.size()) {
+        std::size_t end = source.find_first_of(";\n", start);
+        if (end == std::string::npos) {
+            end = source.size();
+        }
+        const std::string rule = source.substr(start, end - start);
+        start = end + 1;
+        if (rule.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        ++rules;
+        RuleParser parser(rule, constants, species);
+        std::string rule_error;
+        if (!parser.parse(ops, operands, temporaries, rule_error)) {
+            error = "rule " + std::to_string(rules) + " (" + rule + "): " + rule_error;
+            return false;
+        }
+    }
+    if (kFeatureCount + constants.size() + temporaries > kMaxRegisters) {
+        error = "rules need " + std::to_string(kFeatureCount + constants.size() + temporaries) +
+                " registers, at most " + std::to_string(kMaxRegisters) + " are available";
+        return false;
+    }
+
+    auto reg = [&](const Operand &operand) {
+        switch (operand.kind) {
+        case OperandKind::Feature:
+            return static_cast<std::uint8_t>(operand.index);
+        case OperandKind::Constant:
+            return static_cast<std::uint8_t>(kFeatureCount + operand.index);
+        case OperandKind::Temporary:
+        default:
+            return static_cast<std::uint8_t>(kFeatureCount + constants.size() + operand.index);
+        }
+    };
+    instructions_.reserve(ops.size());
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const Operand *operand = &operands[i * 3];
+        Instruction instruction;
+        instruction.op = ops[i];
+        // Choose keeps the action itself in `dst`.
+        instruction.dst = ops[i] == Op::Choose ? static_cast<std::uint8_t>(operand[0].index) : reg(operand[0]);
+        instruction.a = reg(operand[1]);
+        instruction.b = reg(operand[2]);
+        instructions_.push_back(instruction);
+    }
+    constants_ = std::move(constants);
+    species_constants_ = std::move(species);
+    temporaries_ = temporaries;
+    rules_ = rules;
+    return true;
+}
+
+void BehaviorProgram::bindSpecies(const SpeciesRegistry &species) {
+    for (const auto &entry : species_constants_) {
+        constants_[entry.first] = static_cast<float>(species.find(entry.second));
+    }
+}
+
+void BehaviorProgram::run(float *registers, std::size_t lanes, AgentAction *actions) const {
+    for (std::size_t c = 0; c < constants_.size(); ++c) {
+        std::fill_n(registers + (kFeatureCount + c) * kLanes, lanes, constants_[c]);
+    }
+    std::fill_n(actions, lanes, kUndecided);
+    for (const auto &instruction : instructions_) {
+        float *dst = registers + instruction.dst * kLanes;
+        const float *a = registers + instruction.a * kLanes;
+        const float *b = registers + instruction.b * kLanes;
+        switch (instruction.op) {
+        case Op::Add:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] + b[i];
+            }
+            break;
+        case Op::Subtract:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] - b[i];
+            }
+            break;
+        case Op::Multiply:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] * b[i];
+            }
+            break;
+        case Op::Divide:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] / b[i];
+            }
+            break;
+        case Op::Less:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] < b[i] ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::LessEqual:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] <= b[i] ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::Greater:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] > b[i] ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::GreaterEqual:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] >= b[i] ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::Equal:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] == b[i] ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::NotEqual:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] != b[i] ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::And:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = (a[i] != 0.0f) & (b[i] != 0.0f) ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::Or:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = (a[i] != 0.0f) | (b[i] != 0.0f) ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::Not:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = a[i] == 0.0f ? 1.0f : 0.0f;
+            }
+            break;
+        case Op::Negate:
+            for (std::size_t i = 0; i < lanes; ++i) {
+                dst[i] = -a[i];
+            }
+            break;
+        case Op::Choose: {
+            const auto action = static_cast<AgentAction>(instruction.dst);
+            for (std::size_t i = 0; i < lanes; ++i) {
+                actions[i] = (actions[i] == kUndecided) & (a[i] != 0.0f) ? action : actions[i];
+            }
+            break;
+        }
+        }
+    }
+    for (std::size_t i = 0; i < lanes; ++i) {
+        actions[i] = actions[i] == kUndecided ? AgentAction::Rest : actions[i];
+    }
+}
+
+} // namespace ecosim
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "modules/species_registry.h"
+#include "modules/world_port.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ecosim {
+
+// What a rule can read about an agent; each is one register of the program.
+enum class BehaviorFeature : std::uint8_t {
+    Energy,
+    Age,
+    // Live agents within the sense radius among the nearest considered, and how many of them are prey
+    // (for predators) or predators (for prey).
+    Neighbors,
+    Prey,
+    Threats,
+    // Distance to the nearest sensed prey / predator; +inf when there is none.
+    PreyDistance,
+    ThreatDistance,
+    // 1 for predator species, 0 otherwise.
+    Predator,
+    Species,
+    // Uniform in [0, 1), drawn per agent and tick.
+    Random
+};
+
+// Behaviour rules from configuration, compiled once into register bytecode and evaluated over a batch
+// of kLanes agents at a time: every instruction is one loop over all lanes of float registers, so the
+// compiler vectorizes it and the cost of dispatch is paid per batch, not per agent.
+//
+// Source: rules separated by ';' or newlines, each `condition -> action`, tried in order; the first
+// rule whose condition holds picks the agent's action, and agents no rule matches rest. Conditions
+// combine feature names (energy, age, neighbors, prey, threats, prey_distance, threat_distance,
+// predator, random), numbers, `true`/`false` and `species.<name>` (1 for agents of that species) with
+// + - * /, comparisons (< <= > >= == !=), and/or/not (also && || !) and parentheses; anything non-zero
+// is true. Actions: rest, move, forage, flee, hunt, reproduce.
+//
+//     prey > 0 -> hunt; threats > 0 -> flee; energy >= 4 and age > 10 -> reproduce; true -> forage
+class BehaviorProgram {
+public:
+    static constexpr std::size_t kLanes = 256;
+    static constexpr std::size_t kFeatureCount = static_cast<std::size_t>(BehaviorFeature::Random) + 1;
+    static constexpr std::size_t kMaxRegisters = 255;
+
+    enum class Op : std::uint8_t {
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual,
+        And,
+        Or,
+        Not,
+        Negate,
+        // Lanes without an action yet whose register `a` is non-zero take action `dst`.
+        Choose
+    };
+
+    struct Instruction {
+        Op op = Op::Add;
+        std::uint8_t dst = 0;
+        std::uint8_t a = 0;
+        std::uint8_t b = 0;
+    };
+
+    // False (with `error` set and the program left empty) on a syntax error, an unknown name or action,
+    // or a rule set needing more than kMaxRegisters registers.
+    bool compile(const std::string &source, std::string &error);
+    bool empty() const { return rules_ == 0; }
+    std::size_t ruleCount() const { return rules_; }
+    const std::vector<Instruction> &instructions() const { return instructions_; }
+    // Features, then constants, then temporaries; each kLanes floats.
+    std::size_t registerCount() const { return kFeatureCount + constants_.size() + temporaries_; }
+
+    // Resolves the `species.<name>` constants; needed again whenever the species table changes.
+    void bindSpecies(const SpeciesRegistry &species);
+
+    static float *feature(float *registers, BehaviorFeature feature) {
+        return registers + static_cast<std::size_t>(feature) * kLanes;
+    }
+    static const float *feature(const float *registers, BehaviorFeature feature) {
+        return registers + static_cast<std::size_t>(feature) * kLanes;
+    }
+    // `registers` holds registerCount() * kLanes floats with the features of the first `lanes` lanes
+    // filled in; writes one AgentAction per lane.
+    void run(float *registers, std::size_t lanes, AgentAction *actions) const;
+
+private:
+    std::vector<Instruction> instructions_;
+    std::vector<float> constants_;
+    // Constant index and species name of every `species.<name>` reference.
+    std::vector<std::pair<std::size_t, std::string>> species_constants_;
+    std::size_t temporaries_ = 0;
+    std::size_t rules_ = 0;
+};
+
+} // namespace ecosim
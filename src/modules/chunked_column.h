@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecosim {
+
+// Column of trivially copyable values in fixed chunks of kChunkRows rows, shared copy-on-write:
+// copying a column only takes a reference to each chunk, and the first write through a mutable
+// accessor clones just the chunk it touches. A forked world therefore owns the chunks it changed
+// and shares the rest with its parent and siblings.
+//
+// mutableChunk() on distinct chunks and all const accessors may run concurrently, also across
+// columns sharing chunks; everything that changes the size is single-threaded per column.
+template <typename T>
+class ChunkedColumn {
+    static_assert(std::is_trivially_copyable<T>::value, "chunked columns hold trivially copyable values");
+
+public:
+    static constexpr std::size_t kChunkShift = 14;
+    static constexpr std::size_t kChunkRows = std::size_t(1) << kChunkShift;
+    static constexpr std::size_t kChunkBytes = kChunkRows * sizeof(T);
+
+    ChunkedColumn() = default;
+    ChunkedColumn(const ChunkedColumn &other) : chunks_(other.chunks_), size_(other.size_) {
+        for (auto *chunk : chunks_) {
+            chunk->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    ChunkedColumn(ChunkedColumn &&other) noexcept { swap(other); }
+    ChunkedColumn &operator=(ChunkedColumn other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~ChunkedColumn() {
+        clear();
+        for (auto *chunk : spare_) {
+            delete chunk;
+        }
+    }
+
+    void swap(ChunkedColumn &other) noexcept {
+        chunks_.swap(other.chunks_);
+        spare_.swap(other.spare_);
+        std::swap(size_, other.size_);
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t chunkCount() const { return chunks_.size(); }
+    std::size_t chunkRows(std::size_t chunk) const { return std::min(kChunkRows, size_ - chunk * kChunkRows); }
+
+    const T &operator[](std::size_t row) const { return chunks_[row >> kChunkShift]->data[row & kMask]; }
+    const T &back() const { return (*this)[size_ - 1]; }
+    const T *chunk(std::size_t chunk) const { return chunks_[chunk]->data; }
+    // Writable rows of one chunk; the chunk is cloned first if another column still references it.
+    T *mutableChunk(std::size_t chunk) {
+        unshare(chunk, true);
+        return chunks_[chunk]->data;
+    }
+    // Like mutableChunk() for a caller that overwrites every row: a shared chunk is replaced, not cloned.
+    T *overwriteChunk(std::size_t chunk) {
+        unshare(chunk, false);
+        return chunks_[chunk]->data;
+    }
+    T &mutableAt(std::size_t row) { return mutableChunk(row >> kChunkShift)[row & kMask]; }
+
+    void push_back(const T &value) {
+        if ((size_ & kMask) == 0) {
+            chunks_.push_back(acquire());
+        }
+        mutableChunk(size_ >> kChunkShift)[size_ & kMask] = value;
+        ++size_;
+    }
+    void pop_back() {
+        --size_;
+        if ((size_ & kMask) == 0) {
+            recycle(chunks_.back());
+            chunks_.pop_back();
+        }
+    }
+    // New rows are left unspecified; callers fill them through overwriteChunk().
+    void resize(std::size_t rows) {
+        const std::size_t needed = (rows + kChunkRows - 1) >> kChunkShift;
+        while (chunks_.size() > needed) {
+            recycle(chunks_.back());
+            chunks_.pop_back();
+        }
+        while (chunks_.size() < needed) {
+            chunks_.push_back(acquire());
+        }
+        size_ = rows;
+    }
+    void clear() {
+        for (auto *chunk : chunks_) {
+            recycle(chunk);
+        }
+        chunks_.clear();
+        size_ = 0;
+    }
+    // Allocates chunks for `rows` rows up front; clear() and pop_back() keep released chunks for reuse.
+    void reserve(std::size_t rows) {
+        const std::size_t needed = (rows + kChunkRows - 1) >> kChunkShift;
+        chunks_.reserve(needed);
+        spare_.reserve(needed);
+        while (chunks_.size() + spare_.size() < needed) {
+            spare_.push_back(new Chunk);
+        }
+    }
+    void assign(const T *values, std::size_t count) {
+        resize(count);
+        for (std::size_t chunk = 0; chunk < chunks_.size(); ++chunk) {
+            std::memcpy(overwriteChunk(chunk), values + chunk * kChunkRows, chunkRows(chunk) * sizeof(T));
+        }
+    }
+
+    // Chunk bytes held by this column, and the part also referenced by other columns.
+    std::size_t bytes() const { return chunks_.size() * kChunkBytes; }
+    std::size_t sharedBytes() const {
+        std::size_t shared = 0;
+        for (const auto *chunk : chunks_) {
+            shared += chunk->refs.load(std::memory_order_relaxed) > 1 ? kChunkBytes : 0;
+        }
+        return shared;
+    }
+
+private:
+    static constexpr std::size_t kMask = kChunkRows - 1;
+
+    struct Chunk {
+        std::atomic<std::uint32_t> refs{1};
+        alignas(64) T data[kChunkRows];
+    };
+
+    Chunk *acquire() {
+        if (spare_.empty()) {
+            return new Chunk;
+        }
+        Chunk *chunk = spare_.back();
+        spare_.pop_back();
+        return chunk;
+    }
+
+    // Keeps the chunk for reuse if this was the last reference.
+    void recycle(Chunk *chunk) {
+        if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            chunk->refs.store(1, std::memory_order_relaxed);
+            spare_.push_back(chunk);
+        }
+    }
+
+    // May run on worker threads for distinct chunks, so it allocates fresh chunks rather than taking
+    // from spare_, and frees (rather than recycles) a chunk whose other owners let go meanwhile.
+    void unshare(std::size_t index, bool copy) {
+        Chunk *chunk = chunks_[index];
+        if (chunk->refs.load(std::memory_order_acquire) == 1) {
+            return;
+        }
+        Chunk *own = new Chunk;
+        if (copy) {
+            std::memcpy(own->data, chunk->data, chunkRows(index) * sizeof(T));
+        }
+        chunks_[index] = own;
+        if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete chunk;
+        }
+    }
+
+    std::vector<Chunk *> chunks_;
+    std::vector<Chunk *> spare_;
+    std::size_t size_ = 0;
+};
+
+} // namespace ecosim
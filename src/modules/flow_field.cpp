@@ -0,0 +1,169 @@
+#include "modules/flow_field.h"
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ecosim {
+
+namespace {
+constexpr float kDiagonal = 1.41421356f;
+constexpr float kReachCells = static_cast<float>(FlowField::kReach);
+// Stands for "no source in the window"; well above the cap, so the chamfer passes never overflow.
+constexpr float kFar = 4.0f * kReachCells;
+// The 3 x 3 tile window plus its border.
+constexpr std::size_t kPadded = 3 * FlowField::kTileCells + 2;
+} // namespace
+
+void FlowField::resize(std::size_t cells, float world_size) {
+    cells_ = cells;
+    tiles_ = (cells + kTileCells - 1) / kTileCells;
+    cells_per_unit_ = world_size > 0.0f ? static_cast<float>(cells) / world_size : 0.0f;
+    sources_.assign(cells * cells, 0);
+    distances_.assign(cells * cells, kReachCells);
+    directions_.assign(cells * cells, FlowDirection());
+    tile_dirty_.assign(tiles_ * tiles_, 0);
+    dirty_.clear();
+    dirty_.reserve(tiles_ * tiles_);
+}
+
+std::size_t FlowField::cellAt(float x, float y) const {
+    const std::size_t last = cells_ - 1;
+    const std::size_t column = std::min(last, static_cast<std::size_t>(std::max(0.0f, x) * cells_per_unit_));
+    const std::size_t row = std::min(last, static_cast<std::size_t>(std::max(0.0f, y) * cells_per_unit_));
+    return row * cells_ + column;
+}
+
+void FlowField::markDirty(std::size_t cell) {
+    const std::size_t tx = (cell % cells_) / kTileCells;
+    const std::size_t ty = (cell / cells_) / kTileCells;
+    for (std::size_t y = ty > 0 ? ty - 1 : 0; y <= std::min(tiles_ - 1, ty + 1); ++y) {
+        for (std::size_t x = tx > 0 ? tx - 1 : 0; x <= std::min(tiles_ - 1, tx + 1); ++x) {
+            const std::size_t tile = y * tiles_ + x;
+            if (!tile_dirty_[tile]) {
+                tile_dirty_[tile] = 1;
+                dirty_.push_back(static_cast<std::uint32_t>(tile));
+            }
+        }
+    }
+}
+
+void FlowField::assignSources(const std::vector<std::uint8_t> &sources) {
+    for (std::size_t cell = 0; cell < sources_.size(); ++cell) {
+        const std::uint8_t source = sources[cell] != 0 ? 1 : 0;
+        if (source != sources_[cell]) {
+            sources_[cell] = source;
+            markDirty(cell);
+        }
+    }
+}
+
+void FlowField::setSource(std::size_t cell, bool source) {
+    if (sources_[cell] != (source ? 1 : 0)) {
+        sources_[cell] = source ? 1 : 0;
+        markDirty(cell);
+    }
+}
+
+std::size_t FlowField::update() {
+    const std::size_t count = dirty_.size();
+    if (workers_) {
+        workers_->parallelFor(count, [this](std::size_t i) { computeTile(dirty_[i]); });
+    } else {
+        for (std::size_t i = 0; i < count; ++i) {
+            computeTile(dirty_[i]);
+        }
+    }
+    for (auto tile : dirty_) {
+        tile_dirty_[tile] = 0;
+    }
+    dirty_.clear();
+    return count;
+}
+
+void FlowField::rebuild() {
+    for (std::size_t tile = 0; tile < tile_dirty_.size(); ++tile) {
+        if (!tile_dirty_[tile]) {
+            tile_dirty_[tile] = 1;
+            dirty_.push_back(static_cast<std::uint32_t>(tile));
+        }
+    }
+    update();
+}
+
+// Two-pass chamfer transform (steps 1 and sqrt 2) over the tile's 3 x 3 tile window, which holds
+// every source within kReach of the tile's cells; the directions follow the central-difference
+// gradient of the capped distance. The window has a one-cell border of kFar, so the passes need no
+// edge checks, and each row takes the row before it first (independent per cell, so it vectorizes)
+// and then sweeps along itself.
+void FlowField::computeTile(std::size_t tile) {
+    float window[kPadded * kPadded];
+    const auto side = static_cast<std::ptrdiff_t>(cells_);
+    const auto margin = static_cast<std::ptrdiff_t>(kTileCells) + 1;
+    const std::ptrdiff_t x0 = static_cast<std::ptrdiff_t>((tile % tiles_) * kTileCells) - margin;
+    const std::ptrdiff_t y0 = static_cast<std::ptrdiff_t>((tile / tiles_) * kTileCells) - margin;
+    for (std::size_t wy = 0; wy < kPadded; ++wy) {
+        const std::ptrdiff_t y = y0 + static_cast<std::ptrdiff_t>(wy);
+        const bool row_inside = wy > 0 && wy + 1 < kPadded && y >= 0 && y < side;
+        for (std::size_t wx = 0; wx < kPadded; ++wx) {
+            const std::ptrdiff_t x = x0 + static_cast<std::ptrdiff_t>(wx);
+            const bool inside = row_inside && wx > 0 && wx + 1 < kPadded && x >= 0 && x < side;
+            window[wy * kPadded + wx] = inside && sources_[static_cast<std::size_t>(y * side + x)] ? 0.0f : kFar;
+        }
+    }
+    for (std::size_t wy = 1; wy + 1 < kPadded; ++wy) {
+        float *row = window + wy * kPadded;
+        const float *above = row - kPadded;
+        for (std::size_t wx = 1; wx + 1 < kPadded; ++wx) {
+            row[wx] = std::min(std::min(row[wx], above[wx] + 1.0f),
+                               std::min(above[wx - 1], above[wx + 1]) + kDiagonal);
+        }
+        for (std::size_t wx = 1; wx + 1 < kPadded; ++wx) {
+            row[wx] = std::min(row[wx], row[wx - 1] + 1.0f);
+        }
+    }
+    for (std::size_t wy = kPadded - 2; wy > 0; --wy) {
+        float *row = window + wy * kPadded;
+        const float *below = row + kPadded;
+        for (std::size_t wx = 1; wx + 1 < kPadded; ++wx) {
+            row[wx] = std::min(std::min(row[wx], below[wx] + 1.0f),
+                               std::min(below[wx - 1], below[wx + 1]) + kDiagonal);
+        }
+        for (std::size_t wx = kPadded - 2; wx > 0; --wx) {
+            row[wx] = std::min(row[wx], row[wx + 1] + 1.0f);
+        }
+    }
+
+    auto capped = [&](std::size_t wx, std::size_t wy) { return std::min(window[wy * kPadded + wx], kReachCells); };
+    for (std::size_t wy = kTileCells + 1; wy < 2 * kTileCells + 1; ++wy) {
+        const std::ptrdiff_t y = y0 + static_cast<std::ptrdiff_t>(wy);
+        for (std::size_t wx = kTileCells + 1; wx < 2 * kTileCells + 1; ++wx) {
+            const std::ptrdiff_t x = x0 + static_cast<std::ptrdiff_t>(wx);
+            if (x >= side || y >= side) {
+                continue;
+            }
+            const float d = capped(wx, wy);
+            // Off-grid neighbours count as level with the cell, so borders get one-sided slopes.
+            const float left = x > 0 ? capped(wx - 1, wy) : d;
+            const float right = x + 1 < side ? capped(wx + 1, wy) : d;
+            const float up = y > 0 ? capped(wx, wy - 1) : d;
+            const float down = y + 1 < side ? capped(wx, wy + 1) : d;
+            const float gx = right - left;
+            const float gy = down - up;
+            const float length = std::sqrt(gx * gx + gy * gy);
+            FlowDirection direction;
+            const bool settled = mode_ == Mode::Toward ? d == 0.0f : d >= kReachCells;
+            if (!settled && length > 1e-6f) {
+                const float scale = (mode_ == Mode::Toward ? -1.0f : 1.0f) / length;
+                direction.dx = gx * scale;
+                direction.dy = gy * scale;
+            }
+            const auto cell = static_cast<std::size_t>(y * side + x);
+            distances_[cell] = d;
+            directions_[cell] = direction;
+        }
+    }
+}
+
+} // namespace ecosim
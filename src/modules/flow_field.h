@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecosim {
+
+class ThreadPool;
+
+struct FlowDirection {
+    float dx = 0.0f;
+    float dy = 0.0f;
+};
+
+// Unit directions on a square grid over the world, towards the nearest source cell (food) or away
+// from it (predators), so any number of agents steer in O(1) by sampling their cell instead of
+// searching a path each.
+//
+// The distance to the nearest source is capped at kReach cells, so a cell depends only on sources
+// within kReach of it. The grid is split into tiles of kReach x kReach cells; a tile is computed from
+// the sources of its 3 x 3 tile window alone (chamfer distance transform of the window, then the
+// distance gradient for the tile's own cells), and a changed source marks only its own tile and the
+// eight around it dirty. update() recomputes just the dirty tiles, in parallel on the worker pool.
+// A tile's result depends only on its window, so incremental updates, full rebuilds and any number
+// of threads give the same bits.
+class FlowField {
+public:
+    static constexpr std::size_t kReach = 16;
+    static constexpr std::size_t kTileCells = kReach;
+
+    enum class Mode : std::uint8_t { Toward, Away };
+
+    explicit FlowField(Mode mode = Mode::Toward) : mode_(mode) {}
+
+    // `cells` x `cells` over a world of `world_size` units, without sources (every direction zero).
+    // 0 disables the field.
+    void resize(std::size_t cells, float world_size);
+    std::size_t cells() const { return cells_; }
+    bool empty() const { return cells_ == 0; }
+    std::size_t tileCount() const { return tiles_ * tiles_; }
+    void setWorkers(ThreadPool *workers) { workers_ = workers; }
+
+    std::size_t cellAt(float x, float y) const;
+    // Replaces the source flags (cells() * cells() of them); tiles near the flags that changed become
+    // dirty.
+    void assignSources(const std::vector<std::uint8_t> &sources);
+    void setSource(std::size_t cell, bool source);
+    // Recomputes the dirty tiles; returns how many.
+    std::size_t update();
+    // Marks every tile dirty and recomputes them all.
+    void rebuild();
+    std::size_t dirtyTiles() const { return dirty_.size(); }
+
+    // Zero when no source is within reach (and, for Away, where the distance is already at the cap).
+    FlowDirection sample(float x, float y) const { return directions_[cellAt(x, y)]; }
+    FlowDirection direction(std::size_t cell) const { return directions_[cell]; }
+    // In cells, capped at kReach.
+    float distance(std::size_t cell) const { return distances_[cell]; }
+    const std::vector<std::uint8_t> &sources() const { return sources_; }
+
+private:
+    void markDirty(std::size_t cell);
+    void computeTile(std::size_t tile);
+
+    Mode mode_;
+    ThreadPool *workers_ = nullptr;
+    std::size_t cells_ = 0;
+    std::size_t tiles_ = 0;
+    float cells_per_unit_ = 0.0f;
+    std::vector<std::uint8_t> sources_;
+    std::vector<float> distances_;
+    std::vector<FlowDirection> directions_;
+    std::vector<std::uint8_t> tile_dirty_;
+    std::vector<std::uint32_t> dirty_;
+};
+
+} // namespace ecosim
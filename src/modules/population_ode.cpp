@@ -0,0 +1,214 @@
+#include "modules/population_ode.h"
+
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ecosim {
+
+namespace {
+// Dormand-Prince 5(4): stage weights a_s, fifth-order weights (also the last stage's input, which
+// makes its slope the first slope of the next step) and the fifth minus fourth order error weights.
+constexpr double kA2[] = {1.0 / 5};
+constexpr double kA3[] = {3.0 / 40, 9.0 / 40};
+constexpr double kA4[] = {44.0 / 45, -56.0 / 15, 32.0 / 9};
+constexpr double kA5[] = {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729};
+constexpr double kA6[] = {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656};
+constexpr double kB5[] = {35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84};
+constexpr double kError[] = {71.0 / 57600,      0.0,          -71.0 / 16695, 71.0 / 1920,
+                             -17253.0 / 339200, 22.0 / 525,   -1.0 / 40};
+constexpr double kSafety = 0.9;
+constexpr double kMinFactor = 0.2;
+constexpr double kMaxFactor = 5.0;
+
+std::size_t paddedStride(std::size_t species) {
+    return std::max<std::size_t>(kInteractionLanes,
+                                 (species + kInteractionLanes - 1) / kInteractionLanes * kInteractionLanes);
+}
+
+// Returns true if any density was clamped.
+bool clampNegative(double *x, std::size_t count) {
+    bool clamped = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!(x[i] >= 0.0)) {
+            x[i] = 0.0;
+            clamped = true;
+        }
+    }
+    return clamped;
+}
+} // namespace
+
+const char *odeMethodName(OdeMethod method) {
+    return method == OdeMethod::Rk4 ? "rk4" : "rk45";
+}
+
+bool parseOdeMethod(const std::string &name, OdeMethod &out) {
+    if (name == "rk4") {
+        out = OdeMethod::Rk4;
+    } else if (name == "rk45") {
+        out = OdeMethod::Rk45;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+PopulationOde::PopulationOde(KernelPath path)
+    : kernel_(interactionKernel(path) ? interactionKernel(path) : interactionKernel(KernelPath::Scalar)) {
+    resize(0);
+}
+
+void PopulationOde::resize(std::size_t species) {
+    const std::size_t stride = paddedStride(species);
+    if (stride != stride_) {
+        std::vector<double> matrix(stride * species, 0.0);
+        const std::size_t kept = std::min(size_, species);
+        for (std::size_t row = 0; row < kept; ++row) {
+            std::copy(matrix_.begin() + row * stride_, matrix_.begin() + row * stride_ + kept,
+                      matrix.begin() + row * stride);
+        }
+        matrix_.swap(matrix);
+    } else {
+        matrix_.resize(stride * species, 0.0);
+        for (std::size_t row = 0; row < std::min(size_, species); ++row) {
+            std::fill(matrix_.begin() + row * stride + species, matrix_.begin() + (row + 1) * stride, 0.0);
+        }
+    }
+    growth_.resize(species, 0.0);
+    stage_.assign(stride, 0.0);
+    next_.assign(stride, 0.0);
+    for (auto &slope : k_) {
+        slope.assign(stride, 0.0);
+    }
+    size_ = species;
+    stride_ = stride;
+}
+
+void PopulationOde::derivative(const double *x, double *out) {
+    std::copy(x, x + size_, stage_.begin());
+    evaluate(stage_.data(), k_[0].data());
+    std::copy(k_[0].begin(), k_[0].begin() + size_, out);
+}
+
+void PopulationOde::evaluate(const double *x, double *out) {
+    eval_x_ = x;
+    eval_out_ = out;
+    const std::size_t blocks = (size_ + kRowBlock - 1) / kRowBlock;
+    if (workers_ && blocks > 1) {
+        workers_->parallelFor(blocks, [this](std::size_t block) {
+            evaluateRows(block * kRowBlock, std::min(size_, (block + 1) * kRowBlock));
+        });
+    } else {
+        evaluateRows(0, size_);
+    }
+}
+
+void PopulationOde::evaluateRows(std::size_t begin, std::size_t end) {
+    kernel_(matrix_.data() + begin * stride_, stride_, end - begin, eval_x_, eval_out_ + begin);
+    for (std::size_t i = begin; i < end; ++i) {
+        eval_out_[i] = eval_x_[i] * (growth_[i] + eval_out_[i]);
+    }
+}
+
+void PopulationOde::combine(const double *x, double dt, const double *weights, std::size_t count,
+                            double *stage) const {
+    for (std::size_t i = 0; i < size_; ++i) {
+        double slope = 0.0;
+        for (std::size_t s = 0; s < count; ++s) {
+            slope += weights[s] * k_[s][i];
+        }
+        stage[i] = x[i] + dt * slope;
+    }
+}
+
+void PopulationOde::stepRk4(double *x, double dt) {
+    std::copy(x, x + size_, next_.begin());
+    const double *y = next_.data();
+    const double k2[] = {0.5};
+    const double k3[] = {0.0, 0.5};
+    const double k4[] = {0.0, 0.0, 1.0};
+    evaluate(y, k_[0].data());
+    combine(y, dt, k2, 1, stage_.data());
+    evaluate(stage_.data(), k_[1].data());
+    combine(y, dt, k3, 2, stage_.data());
+    evaluate(stage_.data(), k_[2].data());
+    combine(y, dt, k4, 3, stage_.data());
+    evaluate(stage_.data(), k_[3].data());
+    for (std::size_t i = 0; i < size_; ++i) {
+        x[i] = y[i] + dt / 6.0 * (k_[0][i] + 2.0 * k_[1][i] + 2.0 * k_[2][i] + k_[3][i]);
+    }
+    clampNegative(x, size_);
+}
+
+double PopulationOde::advanceRk45(double *x, double dt, double tolerance) {
+    accepted_ = 0;
+    if (size_ == 0 || !(dt > 0.0)) {
+        return dt;
+    }
+    if (!(tolerance > 0.0)) {
+        return 0.0;
+    }
+    std::copy(x, x + size_, next_.begin());
+    evaluate(next_.data(), k_[0].data());
+    double h = step_ > 0.0 ? step_ : dt;
+    double t = 0.0;
+    for (std::size_t attempt = 0; t < dt && attempt < kMaxSubsteps; ++attempt) {
+        const bool last = h >= dt - t;
+        const double span = last ? dt - t : h;
+        const double *y = next_.data();
+        combine(y, span, kA2, 1, stage_.data());
+        evaluate(stage_.data(), k_[1].data());
+        combine(y, span, kA3, 2, stage_.data());
+        evaluate(stage_.data(), k_[2].data());
+        combine(y, span, kA4, 3, stage_.data());
+        evaluate(stage_.data(), k_[3].data());
+        combine(y, span, kA5, 4, stage_.data());
+        evaluate(stage_.data(), k_[4].data());
+        combine(y, span, kA6, 5, stage_.data());
+        evaluate(stage_.data(), k_[5].data());
+        combine(y, span, kB5, 6, stage_.data());
+        evaluate(stage_.data(), k_[6].data());
+
+        double error = 0.0;
+        bool finite = true;
+        for (std::size_t i = 0; i < size_; ++i) {
+            double estimate = 0.0;
+            for (std::size_t s = 0; s < k_.size(); ++s) {
+                estimate += kError[s] * k_[s][i];
+            }
+            const double scale = tolerance * (1.0 + std::max(std::abs(y[i]), std::abs(stage_[i])));
+            const double ratio = std::abs(span * estimate) / scale;
+            finite = finite && std::isfinite(ratio) && std::isfinite(stage_[i]);
+            error = std::max(error, ratio);
+        }
+        double factor = kMaxFactor;
+        if (!finite) {
+            error = std::numeric_limits<double>::infinity();
+            factor = kMinFactor;
+        } else if (error > 0.0) {
+            factor = std::min(kMaxFactor, std::max(kMinFactor, kSafety * std::pow(error, -0.2)));
+        }
+        if (error <= 1.0) {
+            t = last ? dt : t + span;
+            next_.swap(stage_);
+            if (clampNegative(next_.data(), size_)) {
+                evaluate(next_.data(), k_[0].data());
+            } else {
+                k_[0].swap(k_[6]);
+            }
+            ++accepted_;
+            // A step shortened to land on dt says little about the step size the dynamics allow.
+            h = last && span < h ? std::max(h, span * factor) : span * factor;
+        } else {
+            h = span * factor;
+        }
+    }
+    std::copy(next_.begin(), next_.begin() + size_, x);
+    step_ = h;
+    return t;
+}
+
+} // namespace ecosim
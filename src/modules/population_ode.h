@@ -0,0 +1,83 @@
+#pragma once
+
+#include "modules/agent_kernels.h"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ecosim {
+
+class ThreadPool;
+
+enum class OdeMethod { Rk4, Rk45 };
+
+const char *odeMethodName(OdeMethod method);
+// "rk4" or "rk45"; false for anything else.
+bool parseOdeMethod(const std::string &name, OdeMethod &out);
+
+// Generalized Lotka-Volterra dynamics over a vector of species densities:
+//   dx_i/dt = x_i * (r_i + sum_j A_ij x_j)
+// A is dense and row-major with rows padded to a multiple of kInteractionLanes, so A x goes through
+// the SIMD interaction kernels. Rows are split over the worker pool in fixed blocks; each row is
+// computed whole by one thread. Densities cannot
+// go negative: integration error that would make one so is clamped to 0 after each step.
+class PopulationOde {
+public:
+    explicit PopulationOde(KernelPath path = bestKernelPath());
+
+    // Keeps the coefficients of the first min(old, new) species; new ones start at 0.
+    void resize(std::size_t species);
+    std::size_t size() const { return size_; }
+    void setWorkers(ThreadPool *workers) { workers_ = workers; }
+
+    void setGrowth(std::size_t species, double rate) { growth_[species] = rate; }
+    void setInteraction(std::size_t species, std::size_t other, double coefficient) {
+        matrix_[species * stride_ + other] = coefficient;
+    }
+    double growth(std::size_t species) const { return growth_[species]; }
+    double interaction(std::size_t species, std::size_t other) const { return matrix_[species * stride_ + other]; }
+
+    // out = dx/dt at x; both hold size() values.
+    void derivative(const double *x, double *out);
+    // One classic fourth-order Runge-Kutta step of length dt.
+    void stepRk4(double *x, double dt);
+    // Advances x by dt with Dormand-Prince 5(4) substeps whose size keeps the local error under
+    // `tolerance` (absolute and relative); the last accepted size carries over to the next call.
+    // Returns the time actually integrated: less than dt when the substep budget ran out, 0 for a
+    // tolerance that is not positive.
+    double advanceRk45(double *x, double dt, double tolerance);
+    // Accepted substeps of the last advanceRk45() call.
+    std::size_t acceptedSteps() const { return accepted_; }
+    double stepSize() const { return step_; }
+    void setStepSize(double step) { step_ = step; }
+
+    // Attempted substeps per advanceRk45() call before it gives up (e.g. on a blow-up).
+    static constexpr std::size_t kMaxSubsteps = 100000;
+
+private:
+    static constexpr std::size_t kRowBlock = 256;
+
+    void evaluate(const double *x, double *out);
+    void evaluateRows(std::size_t begin, std::size_t end);
+    // stage = x + dt * sum(weights[s] * k_[s]) over the first `count` stages.
+    void combine(const double *x, double dt, const double *weights, std::size_t count, double *stage) const;
+
+    InteractionKernel kernel_;
+    ThreadPool *workers_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t stride_ = 0;
+    std::vector<double> matrix_;
+    std::vector<double> growth_;
+    // Stage inputs and slopes, padded to stride_ with zeros for the kernel.
+    std::vector<double> stage_;
+    std::vector<double> next_;
+    std::array<std::vector<double>, 7> k_;
+    const double *eval_x_ = nullptr;
+    double *eval_out_ = nullptr;
+    double step_ = 0.0;
+    std::size_t accepted_ = 0;
+};
+
+} // namespace ecosim
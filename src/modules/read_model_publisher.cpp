@@ -0,0 +1,126 @@
+#include "modules/read_model_publisher.h"
+
+#include <thread>
+#include <utility>
+
+namespace ecosim {
+
+ReadModelSnapshot::ReadModelSnapshot(ReadModelSnapshot &&other) noexcept
+    : slot_(std::exchange(other.slot_, nullptr)), model_(std::exchange(other.model_, nullptr)),
+      version_(std::exchange(other.version_, 0)) {}
+
+ReadModelSnapshot &ReadModelSnapshot::operator=(ReadModelSnapshot &&other) noexcept {
+    if (this != &other) {
+        release();
+        slot_ = std::exchange(other.slot_, nullptr);
+        model_ = std::exchange(other.model_, nullptr);
+        version_ = std::exchange(other.version_, 0);
+    }
+    return *this;
+}
+
+void ReadModelSnapshot::release() {
+    if (slot_) {
+        slot_->store(0);
+        slot_ = nullptr;
+    }
+    model_ = nullptr;
+    version_ = 0;
+}
+
+ReadModelPublisher::ReadModelPublisher() {
+    for (auto &reader : readers_) {
+        reader.store(0);
+    }
+}
+
+// Field by field, so a recycled version keeps its storage: the species table is copied only when it
+// changed, which happens when species are added, not per tick.
+void ReadModelPublisher::publish(const ReadModel &model) {
+    reclaim();
+    Version *next = nullptr;
+    if (spare_.empty()) {
+        versions_.push_back(std::make_unique<Version>());
+        next = versions_.back().get();
+        spare_.reserve(versions_.size());
+        retired_.reserve(versions_.size());
+    } else {
+        next = spare_.back();
+        spare_.pop_back();
+    }
+    ReadModel &copy = next->model;
+    copy.tick = model.tick;
+    copy.seed = model.seed;
+    copy.population.assign(model.population.begin(), model.population.end());
+    if (copy.species.names() != model.species.names()) {
+        copy.species = model.species;
+    }
+    copy.energy_total = model.energy_total;
+    copy.agent_count = model.agent_count;
+    copy.energy_sum = model.energy_sum;
+    copy.energy_min = model.energy_min;
+    copy.energy_max = model.energy_max;
+    copy.state_hash = model.state_hash;
+    next->number = ++published_;
+    // Only this thread advances the epoch.
+    const std::uint64_t epoch = epoch_.load() + 1;
+    next->published_epoch = epoch;
+
+    Version *previous = current_.exchange(next);
+    // Readers announcing this epoch or later loaded the pointer after the exchange.
+    epoch_.store(epoch);
+    if (previous) {
+        previous->retired_epoch = epoch;
+        retired_.push_back(previous);
+    }
+}
+
+bool ReadModelPublisher::held(const Version &version) const {
+    for (const auto &reader : readers_) {
+        const std::uint64_t slot = reader.load();
+        if (slot == 0) {
+            continue;
+        }
+        if ((slot & kPinned) != 0 ? (slot & ~kPinned) == version.published_epoch : slot < version.retired_epoch) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReadModelPublisher::reclaim() {
+    for (std::size_t i = 0; i < retired_.size();) {
+        if (!held(*retired_[i])) {
+            spare_.push_back(retired_[i]);
+            retired_[i] = retired_.back();
+            retired_.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+ReadModelSnapshot ReadModelPublisher::acquire() const {
+    for (;;) {
+        for (auto &reader : readers_) {
+            std::uint64_t free = 0;
+            if (reader.load() != 0 || !reader.compare_exchange_strong(free, epoch_.load())) {
+                continue;
+            }
+            ReadModelSnapshot snapshot;
+            const Version *version = current_.load();
+            if (!version) {
+                reader.store(0);
+                return snapshot;
+            }
+            reader.store(kPinned | version->published_epoch);
+            snapshot.slot_ = &reader;
+            snapshot.model_ = &version->model;
+            snapshot.version_ = version->number;
+            return snapshot;
+        }
+        std::this_thread::yield();
+    }
+}
+
+} // namespace ecosim
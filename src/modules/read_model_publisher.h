@@ -0,0 +1,94 @@
+#pragma once
+
+#include "modules/world_port.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ecosim {
+
+// One published version of the ReadModel, pinned for the reader. The model stays valid and
+// unchanged while the snapshot lives, however far the world advances meanwhile. Hold it briefly:
+// versions retired while it is pinned cannot be reused until it is released.
+class ReadModelSnapshot {
+public:
+    ReadModelSnapshot() = default;
+    ~ReadModelSnapshot() { release(); }
+    ReadModelSnapshot(ReadModelSnapshot &&other) noexcept;
+    ReadModelSnapshot &operator=(ReadModelSnapshot &&other) noexcept;
+    ReadModelSnapshot(const ReadModelSnapshot &) = delete;
+    ReadModelSnapshot &operator=(const ReadModelSnapshot &) = delete;
+
+    // False before the world published its first version.
+    explicit operator bool() const { return model_ != nullptr; }
+    const ReadModel &model() const { return *model_; }
+    const ReadModel *operator->() const { return model_; }
+    // 1 for the first published version, +1 per publication.
+    std::uint64_t version() const { return version_; }
+
+private:
+    friend class ReadModelPublisher;
+    void release();
+
+    std::atomic<std::uint64_t> *slot_ = nullptr;
+    const ReadModel *model_ = nullptr;
+    std::uint64_t version_ = 0;
+};
+
+// Publishes immutable ReadModel versions from the simulation thread to readers on any thread; neither
+// side takes a lock or waits for the other.
+//
+// The writer copies the model into a spare version and swaps it in with one atomic pointer exchange,
+// then advances the epoch. A reader announces the epoch it saw in a free reader slot before loading
+// the pointer, so a version retired at epoch E can only be held by readers that announced an epoch
+// below E (epoch-based reclamation). Once it has the pointer, the reader narrows its slot to the epoch
+// that version was published at, so a long-lived snapshot pins only its own version instead of every
+// later one; a reader preempted in between holds back reuse until it resumes. Versions are recycled
+// rather than freed, so the steady state copies into existing storage without allocating.
+class ReadModelPublisher {
+public:
+    static constexpr std::size_t kReaderSlots = 64;
+
+    ReadModelPublisher();
+    ReadModelPublisher(const ReadModelPublisher &) = delete;
+    ReadModelPublisher &operator=(const ReadModelPublisher &) = delete;
+
+    // Simulation thread only.
+    void publish(const ReadModel &model);
+    // Any thread. Spins (yielding) only if all kReaderSlots slots are pinned at once.
+    ReadModelSnapshot acquire() const;
+
+    // Simulation thread only: versions published so far and versions allocated (current, pinned or
+    // retired, and spare).
+    std::uint64_t published() const { return published_; }
+    std::size_t versionCount() const { return versions_.size(); }
+
+private:
+    // Slot value flag: the rest is the publish epoch of the one version the reader holds.
+    static constexpr std::uint64_t kPinned = std::uint64_t(1) << 63;
+
+    struct Version {
+        std::uint64_t number = 0;
+        std::uint64_t published_epoch = 0;
+        std::uint64_t retired_epoch = 0;
+        ReadModel model;
+    };
+
+    void reclaim();
+    bool held(const Version &version) const;
+
+    std::atomic<Version *> current_{nullptr};
+    std::atomic<std::uint64_t> epoch_{1};
+    // Per reader: 0 when free, the announced epoch while acquiring, then kPinned | publish epoch.
+    mutable std::array<std::atomic<std::uint64_t>, kReaderSlots> readers_;
+    std::vector<std::unique_ptr<Version>> versions_;
+    std::vector<Version *> spare_;
+    std::vector<Version *> retired_;
+    std::uint64_t published_ = 0;
+};
+
+} // namespace ecosim
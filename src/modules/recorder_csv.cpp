@@ -1,6 +1,9 @@
 #include "modules/recorder_csv.h"
 
 #include "core/module_registry.h"
+
+#include <cstdint>
+#include <charconv>
 #include <filesystem>
 
 namespace ecosim {
@@ -15,6 +18,21 @@ RecorderCsv::RecorderCsv(const ModuleInstanceConfig &instance, ModuleContext &co
     if (path_it != instance.params.end()) {
         output_path_ = path_it->second;
     }
+    readParam(instance, "every", 1u, UINT32_MAX, every_, context_.logger());
+    auto change_it = instance.params.find("on_change");
+    if (change_it != instance.params.end()) {
+        std::size_t start = 0;
+        while (start <= change_it->second.size()) {
+            auto end = change_it->second.find(',', start);
+            if (end == std::string::npos) {
+                end = change_it->second.size();
+            }
+            if (end > start) {
+                on_change_.push_back(change_it->second.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+    }
 }
 
 void RecorderCsv::onStart() {
@@ -26,7 +44,16 @@ void RecorderCsv::onStart() {
         file_.open(output_path_, std::ios::out | std::ios::trunc);
         file_ << "tick,seed,energy_total\n";
     }
-    context_.eventBus().subscribe("world.tick", [this](const SimulationEvent &event) { handleEvent(event); });
+    auto &bus = context_.eventBus();
+    seed_field_ = bus.fieldId("seed");
+    energy_field_ = bus.fieldId("energy_total");
+    auto options = bus.subscriptionDefaults();
+    options.stride = every_;
+    for (const auto &field : on_change_) {
+        options.on_change.push_back(bus.fieldId(field));
+    }
+    bus.subscribeBatch(
+        bus.typeId("world.tick"), [this](EventSpan events) { handleEvents(events); }, std::move(options));
 }
 
 void RecorderCsv::onStop() {
@@ -35,14 +62,33 @@ void RecorderCsv::onStop() {
     }
 }
 
-void RecorderCsv::handleEvent(const SimulationEvent &event) {
-    events_.push_back(event);
-    if (!memory_only_ && file_.is_open()) {
-        auto seed_it = event.payload.find("seed");
-        auto energy_it = event.payload.find("energy_total");
-        file_ << event.tick << ',' << (seed_it != event.payload.end() ? seed_it->second : "") << ','
-              << (energy_it != event.payload.end() ? energy_it->second : "") << '\n';
+void RecorderCsv::handleEvents(EventSpan events) {
+    if (memory_only_) {
+        events_.insert(events_.end(), events.begin(), events.end());
+        return;
+    }
+    if (!file_.is_open()) {
+        return;
+    }
+    rows_.clear();
+    char number[24];
+    auto append = [this, &number](std::int64_t value) {
+        auto result = std::to_chars(number, number + sizeof(number), value);
+        rows_.append(number, result.ptr);
+    };
+    for (const auto &event : events) {
+        append(event.tick);
+        rows_ += ',';
+        if (auto seed = event.find(seed_field_)) {
+            append(seed->value.asInt());
+        }
+        rows_ += ',';
+        if (auto energy = event.find(energy_field_)) {
+            append(energy->value.asInt());
+        }
+        rows_ += '\n';
     }
+    file_.write(rows_.data(), static_cast<std::streamsize>(rows_.size()));
 }
 
 } // namespace ecosim
@@ -18,18 +18,23 @@ public:
     void onStart() override;
     void onStop() override;
 
-    const std::vector<SimulationEvent> &events() const { return events_; }
+    const std::vector<TypedEvent> &events() const { return events_; }
 
 private:
-    void handleEvent(const SimulationEvent &event);
+    void handleEvents(EventSpan events);
 
     std::string type_id_;
     std::string instance_id_;
     ModuleContext &context_;
     std::string output_path_;
     bool memory_only_ = false;
+    std::uint32_t every_ = 1;
+    std::vector<std::string> on_change_;
     std::ofstream file_;
-    std::vector<SimulationEvent> events_;
+    std::string rows_;
+    std::vector<TypedEvent> events_;
+    EventFieldId seed_field_ = 0;
+    EventFieldId energy_field_ = 0;
 };
 
 } // namespace ecosim
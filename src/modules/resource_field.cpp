@@ -0,0 +1,136 @@
+#include "modules/resource_field.h"
+
+#include "core/state_hash.h"
+#include "core/thread_pool.h"
+
+#include <algorithm>
+
+namespace ecosim {
+
+ResourceField::ResourceField(KernelPath path)
+    : kernel_(resourceKernel(path) ? resourceKernel(path) : resourceKernel(KernelPath::Scalar)) {}
+
+void ResourceField::resize(std::size_t cells, float world_size) {
+    cells_ = cells;
+    tiles_ = (cells + kTileRows - 1) / kTileRows;
+    cells_per_unit_ = world_size > 0.0f ? static_cast<float>(cells) / world_size : 0.0f;
+    values_.assign(cells * cells, params_.capacity);
+    tile_rows_.assign(tiles_ * 4 * cells, 0.0f);
+    tile_hashes_.assign(tiles_, 0);
+}
+
+void ResourceField::fill(float value) {
+    std::fill(values_.begin(), values_.end(), value);
+}
+
+bool ResourceField::assign(const std::vector<float> &values) {
+    if (values.size() != values_.size()) {
+        return false;
+    }
+    values_ = values;
+    return true;
+}
+
+void ResourceField::step() {
+    if (tiles_ == 0) {
+        return;
+    }
+    // All halos are taken before any tile writes its rows back.
+    if (workers_) {
+        workers_->parallelFor(tiles_, [this](std::size_t tile) { captureHalo(tile); });
+        workers_->parallelFor(tiles_, [this](std::size_t tile) { stepTile(tile); });
+    } else {
+        for (std::size_t tile = 0; tile < tiles_; ++tile) {
+            captureHalo(tile);
+        }
+        for (std::size_t tile = 0; tile < tiles_; ++tile) {
+            stepTile(tile);
+        }
+    }
+}
+
+// The border rows of the grid are their own missing neighbour, like the border cells of a row.
+void ResourceField::captureHalo(std::size_t tile) {
+    const std::size_t begin = tile * kTileRows;
+    const std::size_t end = std::min(cells_, begin + kTileRows);
+    const float *above = values_.data() + (begin > 0 ? begin - 1 : begin) * cells_;
+    const float *below = values_.data() + (end < cells_ ? end : end - 1) * cells_;
+    float *halo = tile_rows_.data() + tile * 4 * cells_;
+    std::copy(above, above + cells_, halo);
+    std::copy(below, below + cells_, halo + cells_);
+}
+
+void ResourceField::stepTile(std::size_t tile) {
+    const std::size_t begin = tile * kTileRows;
+    const std::size_t end = std::min(cells_, begin + kTileRows);
+    const float *halo_above = tile_rows_.data() + tile * 4 * cells_;
+    const float *halo_below = halo_above + cells_;
+    float *out[2] = {tile_rows_.data() + (tile * 4 + 2) * cells_, tile_rows_.data() + (tile * 4 + 3) * cells_};
+    float *grid = values_.data();
+    for (std::size_t row = begin; row < end; ++row) {
+        // Row - 1 is written back only after this row is computed, so it still holds its old values.
+        const float *above = row == begin ? halo_above : grid + (row - 1) * cells_;
+        const float *below = row + 1 == end ? halo_below : grid + (row + 1) * cells_;
+        kernel_(above, grid + row * cells_, below, out[row & 1], cells_, params_);
+        if (row > begin) {
+            std::copy(out[(row - 1) & 1], out[(row - 1) & 1] + cells_, grid + (row - 1) * cells_);
+        }
+    }
+    std::copy(out[(end - 1) & 1], out[(end - 1) & 1] + cells_, grid + (end - 1) * cells_);
+}
+
+double ResourceField::consume(const float *x, const float *y, const std::uint8_t *alive, float *energy,
+                              std::size_t rows, float intake) {
+    if (cells_ == 0) {
+        return 0.0;
+    }
+    const std::size_t last = cells_ - 1;
+    double taken = 0.0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (!alive[i]) {
+            continue;
+        }
+        std::size_t column = std::min(last, static_cast<std::size_t>(x[i] * cells_per_unit_));
+        std::size_t row = std::min(last, static_cast<std::size_t>(y[i] * cells_per_unit_));
+        float &cell = values_[row * cells_ + column];
+        float bite = cell < intake ? cell : intake;
+        cell -= bite;
+        energy[i] += bite;
+        taken += bite;
+    }
+    return taken;
+}
+
+double ResourceField::total() const {
+    double sum = 0.0;
+    for (float value : values_) {
+        sum += value;
+    }
+    return sum;
+}
+
+std::uint64_t ResourceField::digest() const {
+    auto hashTile = [this](std::size_t tile) {
+        const std::size_t begin = tile * kTileRows;
+        const std::size_t end = std::min(cells_, begin + kTileRows);
+        tile_hashes_[tile] = hash64(values_.data() + begin * cells_, (end - begin) * cells_ * sizeof(float), tile);
+    };
+    if (workers_) {
+        workers_->parallelFor(tiles_, hashTile);
+    } else {
+        for (std::size_t tile = 0; tile < tiles_; ++tile) {
+            hashTile(tile);
+        }
+    }
+    Hash64 hash;
+    hash.add(cells_);
+    hash.update(tile_hashes_.data(), tile_hashes_.size() * sizeof(std::uint64_t));
+    return hash.digest();
+}
+
+std::size_t ResourceField::memoryBytes() const {
+    return (values_.capacity() + tile_rows_.capacity()) * sizeof(float) +
+           tile_hashes_.capacity() * sizeof(std::uint64_t);
+}
+
+} // namespace ecosim
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "modules/agent_kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecosim {
+
+class ThreadPool;
+
+// Square grid of a renewable resource (vegetation, nutrients) laid over the world. Each step it
+// diffuses between neighbouring cells and regrows logistically towards capacity (ResourceKernel);
+// agents then eat from the cell they stand on.
+//
+// The grid is updated in place, one tile of kTileRows full rows per worker task. A tile keeps the
+// original values of the rows just outside it (taken before any tile writes) and writes each row back
+// one row late, once the row below no longer needs it, so besides the grid itself the step needs only
+// four rows per tile. A tile's working set (three input rows and an output row) stays in L2 up to
+// 16k cells per side.
+class ResourceField {
+public:
+    static constexpr std::size_t kTileRows = 128;
+
+    explicit ResourceField(KernelPath path = bestKernelPath());
+
+    // `cells` x `cells` over a world of `world_size` units; every cell starts at capacity. 0 disables
+    // the field.
+    void resize(std::size_t cells, float world_size);
+    std::size_t cells() const { return cells_; }
+    bool empty() const { return cells_ == 0; }
+    std::size_t tileCount() const { return tiles_; }
+    void setWorkers(ThreadPool *workers) { workers_ = workers; }
+
+    const ResourceParams &params() const { return params_; }
+    void setParams(const ResourceParams &params) { params_ = params; }
+    void fill(float value);
+
+    // Diffusion and regrowth over the whole grid.
+    void step();
+    // Each live row takes up to `intake` from its cell into its energy, in row order (rows sharing a
+    // cell eat in that order). Returns the total taken.
+    double consume(const float *x, const float *y, const std::uint8_t *alive, float *energy, std::size_t rows,
+                   float intake);
+
+    float at(std::size_t row, std::size_t column) const { return values_[row * cells_ + column]; }
+    // Value of the cell under world position (x, y); the field must not be empty.
+    float sample(float x, float y) const {
+        const std::size_t last = cells_ - 1;
+        return at(std::min(last, static_cast<std::size_t>(y * cells_per_unit_)),
+                  std::min(last, static_cast<std::size_t>(x * cells_per_unit_)));
+    }
+    // Row-major, cells() * cells() values.
+    const std::vector<float> &values() const { return values_; }
+    // False (and no change) unless `values` holds cells() * cells() values.
+    bool assign(const std::vector<float> &values);
+    double total() const;
+    // XXH64 of the values, hashed per tile on the worker pool and folded in tile order. Only for the
+    // owner's thread between steps: the tile hashes go to shared scratch.
+    std::uint64_t digest() const;
+    // Grid plus the per-tile halo and output rows.
+    std::size_t memoryBytes() const;
+
+private:
+    void captureHalo(std::size_t tile);
+    void stepTile(std::size_t tile);
+
+    ResourceKernel kernel_;
+    ThreadPool *workers_ = nullptr;
+    ResourceParams params_;
+    std::size_t cells_ = 0;
+    std::size_t tiles_ = 0;
+    float cells_per_unit_ = 0.0f;
+    std::vector<float> values_;
+    // Per tile: original row above, original row below, two output rows.
+    std::vector<float> tile_rows_;
+    mutable std::vector<std::uint64_t> tile_hashes_;
+};
+
+} // namespace ecosim
@@ -34,31 +34,74 @@ void ScenarioRunner::onStart() {
     timeline_ = ScenarioTimeline(config);
     initialized_ = true;
     if (world_) {
-        world_->enqueueCommand("world.reset", {{"seed", std::to_string(config.seed)}});
-        world_->enqueueCommand("stop.at_tick", {{"value", std::to_string(config.stop_at_tick)}});
+        WorldCommand setup[] = {WorldCommand::reset(config.seed), WorldCommand::stopAtTick(config.stop_at_tick)};
+        world_->enqueueCommands(setup, 2);
+        loadCommands(timeline_.config());
     }
 }
 
+// Validation and string parsing happen once here; each tick only copies its slice of the schedule.
+void ScenarioRunner::loadCommands(const ScenarioConfig &config) {
+    schedule_.clear();
+    cursor_ = 0;
+    for (const auto &action : config.schedule) {
+        if (action.command != "spawn" && action.command != "set_param" && action.command != "apply_shock") {
+            context_.logger().log(LogChannel::System, "Unsupported scenario command skipped: " + action.command);
+            continue;
+        }
+        ScheduledCommand scheduled;
+        scheduled.tick = action.tick;
+        std::string error;
+        if (!world_->parseCommand(action.command, action.params, scheduled.command, error)) {
+            context_.logger().log(LogChannel::System, "Invalid scenario action at tick " + std::to_string(action.tick) +
+                                                          ": " + error);
+            continue;
+        }
+        schedule_.push_back(scheduled);
+    }
+}
+
+void ScenarioRunner::saveSnapshot(SnapshotWriter &out) const {
+    out.addValue("scenario.cursor", static_cast<std::uint64_t>(cursor_));
+    out.addValue("scenario.schedule_size", static_cast<std::uint64_t>(schedule_.size()));
+}
+
+// Runs after the world restored its species and parameter tables, so the schedule is parsed again
+// against them; ids interned at load would otherwise refer to the tables of this process.
+bool ScenarioRunner::restoreSnapshot(const SnapshotReader &in, std::string &error) {
+    std::uint64_t cursor = 0;
+    std::uint64_t size = 0;
+    if (!in.readValue("scenario.cursor", cursor) || !in.readValue("scenario.schedule_size", size)) {
+        error = "scenario sections missing from snapshot";
+        return false;
+    }
+    if (initialized_ && world_) {
+        loadCommands(timeline_.config());
+    }
+    if (size != schedule_.size() || cursor > size) {
+        error = "snapshot was taken with a different scenario (" + std::to_string(size) + " scheduled commands, " +
+                std::to_string(schedule_.size()) + " loaded)";
+        return false;
+    }
+    cursor_ = static_cast<std::size_t>(cursor);
+    return true;
+}
+
 void ScenarioRunner::onPreTick() {
     if (!initialized_ || !world_) {
         return;
     }
 
     int next_tick = world_->readModel().tick + 1;
-    for (const auto &action : timeline_.actionsForTick(next_tick)) {
-        dispatchAction(action);
-    }
-}
-
-void ScenarioRunner::dispatchAction(const ScenarioConfig::ScheduledAction &action) {
-    if (action.command == "spawn") {
-        world_->enqueueCommand("spawn", action.params);
+    while (cursor_ < schedule_.size() && schedule_[cursor_].tick < next_tick) {
+        ++cursor_;
     }
-    else if (action.command == "set_param") {
-        world_->enqueueCommand("set_param", action.params);
+    batch_.clear();
+    while (cursor_ < schedule_.size() && schedule_[cursor_].tick == next_tick) {
+        batch_.push_back(schedule_[cursor_++].command);
     }
-    else if (action.command == "apply_shock") {
-        world_->enqueueCommand("apply_shock", action.params);
+    if (!batch_.empty()) {
+        world_->enqueueCommands(batch_.data(), batch_.size());
     }
 }
 
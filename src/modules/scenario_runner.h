@@ -2,13 +2,15 @@
 
 #include "core/module.h"
 #include "core/scenario.h"
+#include "core/snapshot.h"
 #include "modules/world_port.h"
 
 #include <set>
+#include <vector>
 
 namespace ecosim {
 
-class ScenarioRunner : public IModule {
+class ScenarioRunner : public IModule, public ISnapshotable {
 public:
     ScenarioRunner(const ModuleInstanceConfig &instance, ModuleContext &context);
 
@@ -21,8 +23,18 @@ public:
     void setWorld(IWorldPort *world) { world_ = world; }
     void setAvailableModules(const std::vector<std::string> &modules);
 
+    // The schedule itself is reloaded from the scenario file; only the cursor is stored.
+    void saveSnapshot(SnapshotWriter &out) const override;
+    bool restoreSnapshot(const SnapshotReader &in, std::string &error) override;
+
 private:
-    void dispatchAction(const ScenarioConfig::ScheduledAction &action);
+    // Scenario actions parsed into world commands at load, ordered by tick.
+    struct ScheduledCommand {
+        int tick = 0;
+        WorldCommand command;
+    };
+
+    void loadCommands(const ScenarioConfig &config);
 
     std::string type_id_;
     std::string instance_id_;
@@ -30,6 +42,9 @@ private:
     ScenarioTimeline timeline_;
     std::set<std::string> available_modules_;
     IWorldPort *world_ = nullptr;
+    std::vector<ScheduledCommand> schedule_;
+    std::vector<WorldCommand> batch_;
+    std::size_t cursor_ = 0;
     bool initialized_ = false;
 };
 
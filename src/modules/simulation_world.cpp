@@ -1,113 +1,1046 @@
 #include "modules/simulation_world.h"
 #include "core/logger.h"
+#include "core/state_hash.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
 
 namespace ecosim {
 
+namespace {
+bool parseInt(const std::string &text, std::int32_t &out) {
+    char *end = nullptr;
+    errno = 0;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno != 0 || value < INT32_MIN || value > INT32_MAX) {
+        return false;
+    }
+    out = static_cast<std::int32_t>(value);
+    return true;
+}
+
+bool parseReal(const std::string &text, double &out) {
+    char *end = nullptr;
+    errno = 0;
+    out = std::strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && errno == 0 && std::isfinite(out);
+}
+
+const std::string *findParam(const std::map<std::string, std::string> &params, const char *key) {
+    auto it = params.find(key);
+    return it != params.end() ? &it->second : nullptr;
+}
+
+// Scalar world state as one snapshot section; value-initialized so padding bytes are zero.
+struct WorldSnapshotState {
+    std::int32_t tick;
+    std::int32_t seed;
+    std::int32_t stop_at_tick;
+    std::uint32_t extremes_stale;
+    std::uint64_t spawned;
+    std::uint64_t population_hash;
+    std::uint64_t rng_seed;
+    std::uint64_t rng_tick;
+    double energy_sum;
+    float energy_low;
+    float energy_high;
+};
+
+constexpr float kAgentEnergy = 2.0f;
+// Upper bounds of the size params: the resource grid holds cells * cells floats.
+constexpr std::size_t kMaxResourceCells = 16384;
+constexpr std::size_t kMaxReserveAgents = std::size_t{1} << 24;
+constexpr float kMaxLength = std::numeric_limits<float>::max();
+constexpr std::uint64_t kHashBase = 31;
+// set_param names of Lotka-Volterra coefficients: kOdeGrowth + species, kOdeInteraction + species
+// + "." + other species.
+const std::string kOdeGrowth = "ode.growth.";
+const std::string kOdeInteraction = "ode.interaction.";
+constexpr std::size_t kNoSpecies = static_cast<std::size_t>(-1);
+
+// set_param names of the resource field, see resourceParam().
+const std::string kResourcePrefix = "resource.";
+constexpr float kDefaultIntake = 0.1f;
+
+ResourceParams defaultResourceParams() {
+    ResourceParams params;
+    params.growth = 0.05f;
+    params.diffusion = 0.1f;
+    params.capacity = 1.0f;
+    return params;
+}
+
+// Field of `params` (or the intake) named by a set_param name, nullptr for any other name. Writes
+// the allowed range of its value.
+float *resourceParam(const std::string &name, ResourceParams &params, float &intake, double &low, double &high) {
+    low = 0.0;
+    high = 1.0;
+    if (name == "resource.growth") {
+        return &params.growth;
+    }
+    if (name == "resource.diffusion") {
+        high = 0.25;
+        return &params.diffusion;
+    }
+    if (name == "resource.capacity") {
+        low = 1e-6;
+        high = 1e9;
+        return &params.capacity;
+    }
+    if (name == "resource.intake") {
+        high = 1e9;
+        return &intake;
+    }
+    return nullptr;
+}
+} // namespace
+
 SimulationWorld::SimulationWorld(const ModuleInstanceConfig &instance, ModuleContext &context)
-    : type_id_(instance.type_id), instance_id_(instance.instance_id), context_(context) {}
+    : type_id_(instance.type_id), instance_id_(instance.instance_id), context_(context) {
+    Logger &logger = context_.logger();
+    readParam(instance, "world_size", std::numeric_limits<float>::min(), kMaxLength, world_size_, logger);
+    readParam(instance, "cell_size", std::numeric_limits<float>::min(), kMaxLength, cell_size_, logger);
+    auto simd_it = instance.params.find("simd");
+    kernel_path_ = parseKernelPath(simd_it != instance.params.end() ? simd_it->second : "auto");
+    metabolism_kernel_ = metabolismKernel(kernel_path_);
+    std::size_t reserve_agents = 0;
+    readParam(instance, "reserve_agents", std::size_t{0}, kMaxReserveAgents, reserve_agents, logger);
+    agents_.reserve(reserve_agents);
+    auto verify_it = instance.params.find("verify_aggregates");
+    verify_aggregates_ = verify_it != instance.params.end() && (verify_it->second == "true" || verify_it->second == "1");
+    auto stream_it = instance.params.find("checksum_stream");
+    if (stream_it != instance.params.end()) {
+        checksum_stream_path_ = stream_it->second;
+    }
+    auto dynamics_it = instance.params.find("dynamics");
+    if (dynamics_it != instance.params.end() && dynamics_it->second == "ode") {
+        dynamics_ = WorldDynamics::Ode;
+    }
+    auto integrator_it = instance.params.find("integrator");
+    if (integrator_it != instance.params.end() && !parseOdeMethod(integrator_it->second, ode_method_)) {
+        logger.log(LogChannel::System, "Unknown integrator " + integrator_it->second + ", using rk45");
+    }
+    readParam(instance, "ode_tolerance", std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+              ode_tolerance_, logger);
+    ode_ = PopulationOde(kernel_path_);
+    ode_.setWorkers(&context_.workers());
+    resources_ = ResourceField(kernel_path_);
+    resources_.setParams(defaultResourceParams());
+    resource_intake_ = kDefaultIntake;
+    std::size_t resource_cells = 0;
+    readParam(instance, "resource_cells", std::size_t{0}, kMaxResourceCells, resource_cells, logger);
+    if (resource_cells > 0) {
+        resources_.resize(resource_cells, world_size_);
+    }
+    resources_.setWorkers(&context_.workers());
+}
+
+SimulationWorld::SimulationWorld(const SimulationWorld &parent, ModuleContext &context)
+    : type_id_(parent.type_id_), instance_id_(parent.instance_id_), context_(context),
+      read_model_(parent.read_model_), param_names_(parent.param_names_), param_values_(parent.param_values_),
+      active_species_(parent.active_species_), pending_commands_(parent.pending_commands_),
+      intents_(parent.intents_.begin(), parent.intents_.begin() + parent.intent_count_),
+      intent_count_(parent.intent_count_), agents_(parent.agents_),
+      spawned_(parent.spawned_), world_size_(parent.world_size_), cell_size_(parent.cell_size_),
+      metabolism_(parent.metabolism_), kernel_path_(parent.kernel_path_),
+      metabolism_kernel_(parent.metabolism_kernel_), energy_sum_(parent.energy_sum_),
+      energy_low_(parent.energy_low_), energy_high_(parent.energy_high_), extremes_stale_(parent.extremes_stale_),
+      population_hash_(parent.population_hash_), hash_weights_(parent.hash_weights_),
+      verify_aggregates_(parent.verify_aggregates_), stop_at_tick_(parent.stop_at_tick_), dynamics_(parent.dynamics_),
+      ode_method_(parent.ode_method_), ode_tolerance_(parent.ode_tolerance_), ode_(parent.ode_),
+      densities_(parent.densities_), resources_(parent.resources_), resource_intake_(parent.resource_intake_) {
+    registerEvents();
+    ode_.setWorkers(&context_.workers());
+    resources_.setWorkers(&context_.workers());
+    for (const auto &name : read_model_.species.names()) {
+        population_fields_.push_back(context_.eventBus().fieldId("population." + name));
+    }
+    context_.random().setSeed(parent.context_.random().seed());
+    context_.random().setTick(parent.context_.random().tick());
+    // The parent's rows are already in the order its own rebuild settled on.
+    grid_.rebuild(agents_, world_size_, cell_size_);
+    publisher_.publish(read_model_);
+}
+
+std::unique_ptr<SimulationWorld> SimulationWorld::fork(ModuleContext &context) const {
+    return std::unique_ptr<SimulationWorld>(new SimulationWorld(*this, context));
+}
+
+void SimulationWorld::registerEvents() {
+    auto &bus = context_.eventBus();
+    tick_event_type_ = bus.typeId("world.tick");
+    seed_field_ = bus.fieldId("seed");
+    tick_field_ = bus.fieldId("tick");
+    energy_field_ = bus.fieldId("energy_total");
+}
 
 void SimulationWorld::onInit() {
     read_model_.tick = 0;
     read_model_.seed = 0;
-    read_model_.population_by_species.clear();
+    read_model_.population.clear();
     read_model_.energy_total = 0;
+    publishAggregates();
+    publisher_.publish(read_model_);
+
+    registerEvents();
+    context_.logger().log(LogChannel::System,
+                          std::string("World metabolism kernel: ") + kernelPathName(kernel_path_));
+    if (dynamics_ == WorldDynamics::Ode) {
+        context_.logger().log(LogChannel::System, std::string("World population dynamics: ode, ") +
+                                                      odeMethodName(ode_method_) + ", dt " +
+                                                      std::to_string(context_.config().dt));
+    }
+    if (!resources_.empty()) {
+        char message[96];
+        std::snprintf(message, sizeof(message), "World resource field: %zux%zu cells, %.1f MiB", resources_.cells(),
+                      resources_.cells(), static_cast<double>(resources_.memoryBytes()) / (1024.0 * 1024.0));
+        context_.logger().log(LogChannel::System, message);
+    }
+
+    if (!checksum_stream_path_.empty()) {
+        std::filesystem::path path(checksum_stream_path_);
+        if (path.is_relative()) {
+            path = std::filesystem::path(context_.config().output_dir) / path;
+        }
+        std::error_code ignored;
+        std::filesystem::create_directories(path.parent_path(), ignored);
+        std::vector<std::string> names(kDigestNames.begin(), kDigestNames.end());
+        if (checksum_stream_.open(path.string(), names)) {
+            context_.logger().log(LogChannel::System, "World checksum stream: " + path.string());
+        } else {
+            context_.logger().log(LogChannel::System, "Cannot open checksum stream " + path.string());
+        }
+    }
+}
+
+void SimulationWorld::onStop() {
+    checksum_stream_.close();
+}
+
+bool SimulationWorld::parseCommand(const std::string &command, const std::map<std::string, std::string> &params,
+                                   WorldCommand &out, std::string &error) {
+    if (command == "world.reset") {
+        auto seed = findParam(params, "seed");
+        std::int32_t value = read_model_.seed;
+        if (seed && !parseInt(*seed, value)) {
+            error = "world.reset: seed is not an integer";
+            return false;
+        }
+        out = WorldCommand::reset(value);
+    } else if (command == "spawn") {
+        auto species = findParam(params, "species");
+        auto count = findParam(params, "count");
+        std::int32_t value = 0;
+        if (!species || species->empty() || !count) {
+            error = "spawn: species and count are required";
+            return false;
+        }
+        if (!parseInt(*count, value) || value < 0) {
+            error = "spawn: count must be a non-negative integer";
+            return false;
+        }
+        auto id = internSpecies(*species);
+        if (id == SpeciesRegistry::kInvalid) {
+            error = "spawn: species limit reached, " + *species + " ignored";
+            return false;
+        }
+        out = WorldCommand::spawn(id, value);
+    } else if (command == "set_param") {
+        auto name = findParam(params, "name");
+        auto value = findParam(params, "value");
+        double number = 0.0;
+        if (!name || name->empty() || !value || !parseReal(*value, number)) {
+            error = "set_param: name and numeric value are required";
+            return false;
+        }
+        if ((*name == "metabolism" && number < 0.0) || (*name == "max_age" && (number < 0.0 || number > UINT32_MAX))) {
+            error = "set_param: " + *name + " out of range";
+            return false;
+        }
+        std::size_t species = 0;
+        std::size_t other = 0;
+        if (name->compare(0, 4, "ode.") == 0 && !parseOdeParam(*name, true, species, other)) {
+            error = "set_param: " + *name + " is not ode.growth.<species> or ode.interaction.<species>.<species>";
+            return false;
+        }
+        if (name->compare(0, kResourcePrefix.size(), kResourcePrefix) == 0) {
+            ResourceParams params;
+            float intake = 0.0f;
+            double low = 0.0;
+            double high = 0.0;
+            if (!resourceParam(*name, params, intake, low, high)) {
+                error = "set_param: " + *name + " is not resource.growth, resource.diffusion, resource.capacity or "
+                                                "resource.intake";
+                return false;
+            }
+            if (number < low || number > high) {
+                error = "set_param: " + *name + " out of range";
+                return false;
+            }
+        }
+        out = WorldCommand::setParam(internParam(*name), number);
+    } else if (command == "apply_shock") {
+        auto strength = findParam(params, "strength");
+        double value = 0.0;
+        if (!strength || !parseReal(*strength, value) || value < 0.0 || value > 1.0) {
+            error = "apply_shock: strength must be a number in [0, 1]";
+            return false;
+        }
+        out = WorldCommand::applyShock(value);
+    } else if (command == "stop.at_tick") {
+        auto tick = findParam(params, "value");
+        std::int32_t value = 0;
+        if (!tick || !parseInt(*tick, value)) {
+            error = "stop.at_tick: value must be an integer";
+            return false;
+        }
+        out = WorldCommand::stopAtTick(value);
+    } else {
+        error = "unknown world command: " + command;
+        return false;
+    }
+    return true;
+}
+
+void SimulationWorld::enqueueCommands(const WorldCommand *commands, std::size_t count) {
+    pending_commands_.insert(pending_commands_.end(), commands, commands + count);
 }
 
 void SimulationWorld::enqueueCommand(const std::string &command, const std::map<std::string, std::string> &params) {
-    pending_commands_.push_back({command, params});
+    WorldCommand parsed;
+    std::string error;
+    if (!parseCommand(command, params, parsed, error)) {
+        context_.logger().log(LogChannel::System, "Rejected world command: " + error);
+        return;
+    }
+    enqueueCommands(&parsed, 1);
+}
+
+double SimulationWorld::param(const std::string &name) const {
+    for (std::size_t i = 0; i < param_names_.size(); ++i) {
+        if (param_names_[i] == name) {
+            return param_values_[i];
+        }
+    }
+    return 0.0;
+}
+
+void SimulationWorld::saveSnapshot(SnapshotWriter &out) const {
+    WorldSnapshotState state{};
+    state.tick = read_model_.tick;
+    state.seed = read_model_.seed;
+    state.stop_at_tick = stop_at_tick_;
+    state.extremes_stale = extremes_stale_ ? 1 : 0;
+    state.spawned = spawned_;
+    state.population_hash = population_hash_;
+    state.rng_seed = context_.random().seed();
+    state.rng_tick = context_.random().tick();
+    state.energy_sum = energy_sum_;
+    state.energy_low = energy_low_;
+    state.energy_high = energy_high_;
+    out.addValue("world.state", state);
+    out.addStrings("world.species", read_model_.species.names());
+    out.addArray("world.population", read_model_.population);
+    out.addArray("world.active_species", active_species_);
+    out.addStrings("world.param_names", param_names_);
+    out.addArray("world.param_values", param_values_);
+    out.addArray("world.pending_commands", pending_commands_);
+    out.add("world.intents", intents_.data(), intent_count_ * sizeof(AgentIntent));
+    out.addArray("world.densities", densities_);
+    out.addValue("world.ode_step", ode_.stepSize());
+    if (!resources_.empty()) {
+        out.addArray("world.resources", resources_.values());
+    }
+    agents_.saveSnapshot(out, "world.agents.");
+}
+
+// Replaces the current state wholesale; derived data (metabolism parameters, hash weights, read-model
+// aggregates, spatial index) is rebuilt from the restored fields rather than stored.
+bool SimulationWorld::restoreSnapshot(const SnapshotReader &in, std::string &error) {
+    WorldSnapshotState state{};
+    std::vector<std::string> species;
+    std::vector<std::string> params;
+    std::vector<int> population;
+    std::vector<std::uint8_t> active;
+    std::vector<double> values;
+    std::vector<WorldCommand> pending;
+    std::vector<double> densities;
+    double ode_step = 0.0;
+    if (!in.readValue("world.state", state) || !in.readStrings("world.species", species) ||
+        !in.readArray("world.population", population) || !in.readArray("world.active_species", active) ||
+        !in.readStrings("world.param_names", params) || !in.readArray("world.param_values", values) ||
+        !in.readArray("world.pending_commands", pending)) {
+        error = "world sections missing from snapshot";
+        return false;
+    }
+    // Written since the Ode dynamics mode; older snapshots are Agents-only.
+    if (in.has("world.densities") &&
+        (!in.readArray("world.densities", densities) || !in.readValue("world.ode_step", ode_step))) {
+        error = "world ode sections in snapshot are malformed";
+        return false;
+    }
+    std::vector<AgentIntent> intents;
+    // Written since behavior intents exist; older snapshots have none pending.
+    if (in.has("world.intents") && !in.readArray("world.intents", intents)) {
+        error = "world intents in snapshot are malformed";
+        return false;
+    }
+    std::vector<float> resources;
+    if (!resources_.empty() && (!in.readArray("world.resources", resources) ||
+                                resources.size() != resources_.cells() * resources_.cells())) {
+        error = "snapshot has no resource field of " + std::to_string(resources_.cells()) + " cells per side";
+        return false;
+    }
+    if (dynamics_ == WorldDynamics::Ode && densities.size() != species.size()) {
+        error = "snapshot has no densities for every species (taken in agents dynamics?)";
+        return false;
+    }
+    if (species.size() >= SpeciesRegistry::kInvalid || population.size() > species.size() ||
+        active.size() != species.size() || params.size() != values.size() || params.size() < kFirstCustomParam) {
+        error = "world tables in snapshot are inconsistent";
+        return false;
+    }
+    for (const auto &command : pending) {
+        if (command.type > WorldCommandType::StopAtTick ||
+            (command.type == WorldCommandType::Spawn && command.species >= species.size()) ||
+            (command.type == WorldCommandType::SetParam && command.param >= params.size())) {
+            error = "pending command in snapshot references an unknown id";
+            return false;
+        }
+    }
+    if (!agents_.restoreSnapshot(in, "world.agents.", error)) {
+        return false;
+    }
+    if (agents_.counts().size() > species.size()) {
+        agents_.clear();
+        error = "agent species in snapshot exceed the species table";
+        return false;
+    }
+
+    read_model_.species.clear();
+    population_fields_.clear();
+    active_species_.clear();
+    densities_.clear();
+    ode_.resize(0);
+    for (const auto &name : species) {
+        internSpecies(name);
+    }
+    active_species_ = std::move(active);
+    read_model_.population = std::move(population);
+    param_names_ = std::move(params);
+    param_values_ = std::move(values);
+    metabolism_.decay = static_cast<float>(param_values_[kParamMetabolism]);
+    metabolism_.max_age = static_cast<std::uint32_t>(param_values_[kParamMaxAge]);
+    pending_commands_ = std::move(pending);
+    intent_count_ = intents.size();
+    intents_ = std::move(intents);
+    resources_.setParams(defaultResourceParams());
+    resource_intake_ = kDefaultIntake;
+    for (std::size_t param = kFirstCustomParam; param < param_names_.size(); ++param) {
+        applyResourceParam(static_cast<std::uint16_t>(param));
+    }
+    resources_.assign(resources);
+    if (dynamics_ == WorldDynamics::Ode) {
+        densities_ = std::move(densities);
+        ode_.setStepSize(ode_step);
+        for (std::size_t param = kFirstCustomParam; param < param_names_.size(); ++param) {
+            applyOdeParam(static_cast<std::uint16_t>(param));
+        }
+    }
+
+    read_model_.tick = state.tick;
+    read_model_.seed = state.seed;
+    stop_at_tick_ = state.stop_at_tick;
+    extremes_stale_ = state.extremes_stale != 0;
+    spawned_ = state.spawned;
+    population_hash_ = state.population_hash;
+    context_.random().setSeed(state.rng_seed);
+    context_.random().setTick(state.rng_tick);
+    energy_sum_ = state.energy_sum;
+    energy_low_ = state.energy_low;
+    energy_high_ = state.energy_high;
+
+    publishAggregates();
+    rebuildIndex();
+    publisher_.publish(read_model_);
+    return true;
 }
 
+SpeciesId SimulationWorld::internSpecies(const std::string &name) {
+    auto id = read_model_.species.intern(name);
+    if (id != SpeciesRegistry::kInvalid && id == population_fields_.size()) {
+        population_fields_.push_back(context_.eventBus().fieldId("population." + name));
+        active_species_.push_back(0);
+        if (dynamics_ == WorldDynamics::Ode) {
+            densities_.push_back(0.0);
+            ode_.resize(densities_.size());
+        }
+    }
+    return id;
+}
+
+// "ode.growth.<species>" or "ode.interaction.<species>.<other>"; `other` is kNoSpecies for growth.
+// Interning at parse time gives the species ids before the command is applied.
+bool SimulationWorld::parseOdeParam(const std::string &name, bool intern, std::size_t &species, std::size_t &other) {
+    auto lookup = [this, intern](const std::string &species_name) -> std::size_t {
+        if (species_name.empty()) {
+            return kNoSpecies;
+        }
+        auto id = intern ? internSpecies(species_name) : read_model_.species.find(species_name);
+        return id < read_model_.species.size() ? id : kNoSpecies;
+    };
+    if (name.compare(0, kOdeGrowth.size(), kOdeGrowth) == 0) {
+        species = lookup(name.substr(kOdeGrowth.size()));
+        other = kNoSpecies;
+        return species != kNoSpecies;
+    }
+    if (name.compare(0, kOdeInteraction.size(), kOdeInteraction) == 0) {
+        auto dot = name.find('.', kOdeInteraction.size());
+        if (dot == std::string::npos) {
+            return false;
+        }
+        species = lookup(name.substr(kOdeInteraction.size(), dot - kOdeInteraction.size()));
+        other = lookup(name.substr(dot + 1));
+        return species != kNoSpecies && other != kNoSpecies;
+    }
+    return false;
+}
+
+void SimulationWorld::applyOdeParam(std::uint16_t param) {
+    std::size_t species = 0;
+    std::size_t other = 0;
+    if (dynamics_ != WorldDynamics::Ode || !parseOdeParam(param_names_[param], false, species, other)) {
+        return;
+    }
+    if (other == kNoSpecies) {
+        ode_.setGrowth(species, param_values_[param]);
+    } else {
+        ode_.setInteraction(species, other, param_values_[param]);
+    }
+}
+
+void SimulationWorld::applyResourceParam(std::uint16_t param) {
+    auto params = resources_.params();
+    double low = 0.0;
+    double high = 0.0;
+    if (float *field = resourceParam(param_names_[param], params, resource_intake_, low, high)) {
+        *field = static_cast<float>(param_values_[param]);
+        resources_.setParams(params);
+    }
+}
+
+std::uint16_t SimulationWorld::internParam(const std::string &name) {
+    for (std::size_t i = 0; i < param_names_.size(); ++i) {
+        if (param_names_[i] == name) {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+    param_names_.push_back(name);
+    param_values_.push_back(0.0);
+    return static_cast<std::uint16_t>(param_names_.size() - 1);
+}
+
+// Intents were decided on the state the commands are about to change, so they go first.
 void SimulationWorld::onPreTick() {
-    for (const auto &entry : pending_commands_) {
-        applyCommand(entry.first, entry.second);
+    if (pending_commands_.empty() && intent_count_ == 0) {
+        return;
+    }
+    applyIntents();
+    for (const auto &command : pending_commands_) {
+        applyCommand(command);
     }
     pending_commands_.clear();
+    publishAggregates();
+    rebuildIndex();
+    publisher_.publish(read_model_);
 }
 
 void SimulationWorld::onTick() {
     read_model_.tick += 1;
-    for (const auto &species : species_order_) {
-        auto &count = read_model_.population_by_species[species];
-        count += 1;
+    context_.random().setTick(static_cast<std::uint64_t>(read_model_.tick));
+    if (dynamics_ == WorldDynamics::Ode) {
+        integratePopulation();
+    } else {
+        consumeResources();
+        // The metabolism pass touches every agent anyway, so it yields the energy aggregates as well.
+        auto metabolism = runMetabolism();
+        energy_sum_ = metabolism.energy_total;
+        energy_low_ = metabolism.energy_min;
+        energy_high_ = metabolism.energy_max;
+        extremes_stale_ = false;
+        if (metabolism.deaths > 0) {
+            agents_.reapDead();
+        }
+        for (std::size_t species = 0; species < active_species_.size(); ++species) {
+            if (active_species_[species]) {
+                spawnAgents(static_cast<SpeciesId>(species), 1);
+            }
+        }
     }
-    read_model_.energy_total = 0;
-    for (const auto &pair : read_model_.population_by_species) {
-        read_model_.energy_total += pair.second * 2;
+    resources_.step();
+    refreshPopulation();
+    publishAggregates();
+    rebuildIndex();
+    if (checksum_stream_.isOpen()) {
+        auto digests = stateDigests();
+        checksum_stream_.write(static_cast<std::uint64_t>(read_model_.tick), digests.data());
     }
+    publisher_.publish(read_model_);
     emitTickEvent();
 }
 
-void SimulationWorld::applyCommand(const std::string &command, const std::map<std::string, std::string> &params) {
-    if (command == "world.reset") {
-        auto seed_it = params.find("seed");
-        if (seed_it != params.end()) {
-            read_model_.seed = std::stoi(seed_it->second);
+// Chunks run on the worker pool and touch only their own rows; deaths and energy are merged here in
+// chunk order.
+MetabolismResult SimulationWorld::runMetabolism() {
+    chunk_results_.resize(agents_.chunkCount());
+    context_.workers().parallelFor(chunk_results_.size(), [this](std::size_t chunk) {
+        chunk_results_[chunk] = metabolism_kernel_(agents_.energyChunk(chunk), agents_.ageChunk(chunk),
+                                                   agents_.aliveChunk(chunk), agents_.chunkRows(chunk), metabolism_);
+    });
+    MetabolismResult total;
+    for (const auto &chunk : chunk_results_) {
+        total.energy_total += chunk.energy_total;
+        total.energy_min = std::min(total.energy_min, chunk.energy_min);
+        total.energy_max = std::max(total.energy_max, chunk.energy_max);
+        total.deaths += chunk.deaths;
+    }
+    return total;
+}
+
+// Sequential in row order: agents sharing a cell compete for it, and row order settles who eats first.
+// Energy aggregates are refreshed by the metabolism pass that
+// follows.
+void SimulationWorld::consumeResources() {
+    if (resources_.empty() || resource_intake_ <= 0.0f) {
+        return;
+    }
+    for (std::size_t chunk = 0; chunk < agents_.chunkCount(); ++chunk) {
+        resources_.consume(agents_.x().chunk(chunk), agents_.y().chunk(chunk), agents_.alive().chunk(chunk),
+                           agents_.energyChunk(chunk), agents_.chunkRows(chunk), resource_intake_);
+    }
+}
+
+AgentIntent *SimulationWorld::beginIntents(std::size_t count) {
+    if (intents_.size() < count) {
+        intents_.resize(count);
+    }
+    intent_count_ = count;
+    return intents_.data();
+}
+
+float SimulationWorld::clampCoordinate(float value) const {
+    const float high = std::nextafter(world_size_, 0.0f);
+    return value > 0.0f ? (value < high ? value : high) : 0.0f;
+}
+
+namespace {
+bool displaces(const AgentIntent &intent) {
+    return intent.action == AgentAction::Move || intent.action == AgentAction::Forage ||
+           intent.action == AgentAction::Flee || intent.action == AgentAction::Hunt;
+}
+} // namespace
+
+// Intent i is normally about row i (nothing moves rows between the decision and this phase), and a
+// displacement touches only its own row, so those run per chunk on the pool.
+void SimulationWorld::moveAgents(std::size_t chunk) {
+    const std::size_t begin = chunk * AgentStore::kChunkRows;
+    const std::size_t end = std::min(begin + agents_.chunkRows(chunk), intent_count_);
+    if (begin >= end) {
+        return;
+    }
+    float *xs = agents_.xChunk(chunk);
+    float *ys = agents_.yChunk(chunk);
+    const std::uint8_t *alive = agents_.alive().chunk(chunk);
+    for (std::size_t row = begin; row < end; ++row) {
+        const AgentIntent &intent = intents_[row];
+        const std::size_t offset = row - begin;
+        if (displaces(intent) && alive[offset] && agents_.handle(row) == intent.agent) {
+            xs[offset] = clampCoordinate(xs[offset] + intent.dx);
+            ys[offset] = clampCoordinate(ys[offset] + intent.dy);
+        }
+    }
+}
+
+// Hunts, births and intents whose agent changed rows are applied in index order on this thread, which
+// settles conflicts (two hunters, one prey). Energy only moves between agents, so energy_sum_ is
+// unchanged.
+void SimulationWorld::applyIntents() {
+    if (intent_count_ == 0) {
+        return;
+    }
+    if (dynamics_ == WorldDynamics::Ode) {
+        intent_count_ = 0;
+        return;
+    }
+    context_.workers().parallelFor(agents_.chunkCount(), [this](std::size_t chunk) { moveAgents(chunk); });
+    constexpr std::size_t kRows = AgentStore::kChunkRows;
+    auto energyAt = [this](std::size_t row) -> float & { return agents_.energyChunk(row / kRows)[row % kRows]; };
+    bool killed = false;
+    for (std::size_t i = 0; i < intent_count_; ++i) {
+        const AgentIntent &intent = intents_[i];
+        if (intent.action == AgentAction::Rest) {
+            continue;
+        }
+        const bool in_place = i < agents_.size() && agents_.handle(i) == intent.agent;
+        if (!in_place && !agents_.valid(intent.agent)) {
+            continue;
+        }
+        const std::size_t row = in_place ? i : agents_.row(intent.agent);
+        if (!agents_.alive()[row]) {
+            continue;
+        }
+        if (!in_place && displaces(intent)) {
+            agents_.xChunk(row / kRows)[row % kRows] = clampCoordinate(agents_.x()[row] + intent.dx);
+            agents_.yChunk(row / kRows)[row % kRows] = clampCoordinate(agents_.y()[row] + intent.dy);
+        }
+        if (intent.action == AgentAction::Hunt && agents_.valid(intent.target)) {
+            const std::size_t prey = agents_.row(intent.target);
+            if (prey == row || !agents_.alive()[prey]) {
+                continue;
+            }
+            const float meal = agents_.energy()[prey];
+            float &energy = energyAt(row);
+            extremes_stale_ = extremes_stale_ || meal <= energy_low_ || energy <= energy_low_;
+            energy += meal;
+            energy_high_ = std::max(energy_high_, energy);
+            agents_.kill(prey);
+            killed = true;
+        } else if (intent.action == AgentAction::Reproduce) {
+            float &energy = energyAt(row);
+            const float whole = energy;
+            const float half = whole * 0.5f;
+            energy = half;
+            extremes_stale_ = extremes_stale_ || whole >= energy_high_;
+            energy_low_ = std::min(energy_low_, half);
+            agents_.spawn(agents_.species()[row], agents_.x()[row], agents_.y()[row], whole - half);
+            ++spawned_;
+        }
+    }
+    if (killed) {
+        agents_.compact();
+    }
+    intent_count_ = 0;
+    refreshPopulation();
+}
+
+// Agent rows are kept in cell order, so rebuilds and neighbour scans read the columns sequentially.
+// Reordering rewrites every column (and unshares every chunk of a fork), so it waits until the cell
+// order is fragmented rather than merely shifted by a few births.
+void SimulationWorld::rebuildIndex() {
+    grid_.rebuild(agents_, world_size_, cell_size_);
+    if (grid_.fragments() > agents_.size() / 8) {
+        agents_.reorder(grid_.order());
+        grid_.adoptOrder();
+    }
+}
+
+void SimulationWorld::queryRadius(float x, float y, float radius, std::vector<Neighbor> &out) const {
+    grid_.queryRadius(x, y, radius, out);
+}
+
+void SimulationWorld::queryNearest(float x, float y, std::size_t k, std::vector<Neighbor> &out) const {
+    grid_.queryNearest(x, y, k, out);
+}
+
+// Positions are drawn from the "world.spawn" stream keyed by spawn serial (not tick), so runs replay
+// identically.
+void SimulationWorld::spawnAgents(SpeciesId species, int count) {
+    auto rng = context_.random().stream(spawn_stream_, 0);
+    for (int i = 0; i < count; ++i) {
+        auto serial = spawned_++;
+        float x = rng.uniform(serial, 0) * world_size_;
+        float y = rng.uniform(serial, 1) * world_size_;
+        agents_.spawn(species, x, y, kAgentEnergy);
+    }
+    if (count > 0) {
+        energy_sum_ += static_cast<double>(kAgentEnergy) * count;
+        energy_low_ = std::min(energy_low_, kAgentEnergy);
+        energy_high_ = std::max(energy_high_, kAgentEnergy);
+    }
+}
+
+void SimulationWorld::integratePopulation() {
+    if (ode_method_ == OdeMethod::Rk4) {
+        ode_.stepRk4(densities_.data(), context_.config().dt);
+        return;
+    }
+    const double dt = context_.config().dt;
+    const double advanced = ode_.advanceRk45(densities_.data(), dt, ode_tolerance_);
+    if (advanced < dt) {
+        // The densities are not at the end of the tick; carrying on would count time that never passed.
+        context_.logger().log(LogChannel::System, "rk45 gave up at t = " + std::to_string(advanced) + " of dt = " +
+                                                      std::to_string(dt) + " in tick " +
+                                                      std::to_string(read_model_.tick) + ", stopping");
+        stop_at_tick_ = read_model_.tick;
+    }
+}
+
+// Rounded density in Ode mode, saturating at INT_MAX.
+int SimulationWorld::speciesCount(std::size_t species) const {
+    if (dynamics_ == WorldDynamics::Ode) {
+        const double density = species < densities_.size() ? densities_[species] : 0.0;
+        if (!(density > 0.0)) {
+            return 0;
         }
+        return density >= static_cast<double>(INT32_MAX) ? INT32_MAX : static_cast<int>(std::llround(density));
+    }
+    return static_cast<int>(agents_.count(static_cast<SpeciesId>(species)));
+}
+
+// Counts come from AgentStore, which keeps them per mutation. The population part of the hash is
+// sum(count[i] * 31^(n - 1 - i)); a change of one count adds delta * weight, and a new species
+// shifts the sum by one power.
+void SimulationWorld::refreshPopulation() {
+    auto &population = read_model_.population;
+    const std::size_t known = population.size();
+    const std::size_t species = read_model_.species.size();
+    while (hash_weights_.size() < species) {
+        hash_weights_.push_back(hash_weights_.empty() ? 1 : hash_weights_.back() * kHashBase);
+    }
+    for (std::size_t i = 0; i < known; ++i) {
+        auto count = speciesCount(i);
+        if (count != population[i]) {
+            auto delta = static_cast<std::uint64_t>(static_cast<std::int64_t>(count) - population[i]);
+            population_hash_ += delta * hash_weights_[known - 1 - i];
+            population[i] = count;
+        }
+    }
+    for (std::size_t i = known; i < species; ++i) {
+        auto count = speciesCount(i);
+        population.push_back(count);
+        population_hash_ = population_hash_ * kHashBase + static_cast<std::uint64_t>(static_cast<std::int64_t>(count));
+    }
+}
+
+void SimulationWorld::publishAggregates() {
+    if (extremes_stale_) {
+        energy_low_ = std::numeric_limits<float>::infinity();
+        energy_high_ = -std::numeric_limits<float>::infinity();
+        const auto &energy = agents_.energy();
+        for (std::size_t row = 0; row < agents_.size(); ++row) {
+            energy_low_ = std::min(energy_low_, energy[row]);
+            energy_high_ = std::max(energy_high_, energy[row]);
+        }
+        extremes_stale_ = false;
+    }
+    read_model_.agent_count = agents_.size();
+    read_model_.energy_sum = energy_sum_;
+    read_model_.energy_min = agents_.empty() ? 0.0f : energy_low_;
+    read_model_.energy_max = agents_.empty() ? 0.0f : energy_high_;
+    read_model_.energy_total = static_cast<int>(energy_sum_);
+    auto hash = population_hash_ * kHashBase + static_cast<std::uint64_t>(static_cast<std::int64_t>(read_model_.energy_total));
+    read_model_.state_hash = hash * kHashBase + static_cast<std::uint64_t>(static_cast<std::int64_t>(read_model_.seed));
+    if (verify_aggregates_) {
+        verifyAggregates();
+    }
+}
+
+// Debug mode: recomputes every aggregate from the agent columns and reports any difference.
+void SimulationWorld::verifyAggregates() {
+    std::vector<int> counts(read_model_.species.size(), 0);
+    double sum = 0.0;
+    float low = std::numeric_limits<float>::infinity();
+    float high = -std::numeric_limits<float>::infinity();
+    const auto &energy = agents_.energy();
+    const auto &species = agents_.species();
+    for (std::size_t i = 0; dynamics_ == WorldDynamics::Ode && i < counts.size(); ++i) {
+        counts[i] = speciesCount(i);
+    }
+    for (std::size_t row = 0; row < agents_.size(); ++row) {
+        ++counts[species[row]];
+        sum += energy[row];
+        low = std::min(low, energy[row]);
+        high = std::max(high, energy[row]);
+    }
+    std::uint64_t hash = 0;
+    for (int count : counts) {
+        hash = hash * kHashBase + static_cast<std::uint64_t>(static_cast<std::int64_t>(count));
+    }
+    hash = hash * kHashBase + static_cast<std::uint64_t>(static_cast<std::int64_t>(read_model_.energy_total));
+    hash = hash * kHashBase + static_cast<std::uint64_t>(static_cast<std::int64_t>(read_model_.seed));
+
+    const auto &model = read_model_;
+    bool matches = counts == model.population && model.agent_count == agents_.size() &&
+                   std::abs(sum - model.energy_sum) <= 1e-9 * std::max(1.0, std::abs(sum)) &&
+                   (agents_.empty() || (low == model.energy_min && high == model.energy_max)) &&
+                   hash == model.state_hash;
+    if (!matches) {
+        ++aggregate_mismatches_;
+        context_.logger().log(LogChannel::System, "Aggregate verification failed at tick " +
+                                                      std::to_string(model.tick) + ": energy_sum " +
+                                                      std::to_string(model.energy_sum) + " vs " + std::to_string(sum));
+    }
+    assert(matches && "incremental aggregates diverged from recomputation");
+}
+
+void SimulationWorld::applyCommand(const WorldCommand &command) {
+    switch (command.type) {
+    case WorldCommandType::Reset:
+        read_model_.seed = command.amount;
         read_model_.tick = 0;
-        read_model_.population_by_species.clear();
-        species_order_.clear();
+        context_.random().setSeed(static_cast<std::uint64_t>(read_model_.seed));
+        context_.random().setTick(0);
+        read_model_.population.clear();
+        std::fill(active_species_.begin(), active_species_.end(), 0);
+        agents_.clear();
+        energy_sum_ = 0.0;
+        energy_low_ = std::numeric_limits<float>::infinity();
+        energy_high_ = -std::numeric_limits<float>::infinity();
+        population_hash_ = 0;
+        spawned_ = 0;
+        std::fill(densities_.begin(), densities_.end(), 0.0);
+        ode_.setStepSize(0.0);
+        resources_.fill(resources_.params().capacity);
         context_.logger().log(LogChannel::System, "World reset with seed " + std::to_string(read_model_.seed));
-    } else if (command == "spawn") {
-        auto species_it = params.find("species");
-        auto count_it = params.find("count");
-        if (species_it != params.end() && count_it != params.end()) {
-            auto &count = read_model_.population_by_species[species_it->second];
-            if (count == 0) {
-                species_order_.push_back(species_it->second);
-            }
-            count += std::stoi(count_it->second);
+        break;
+    case WorldCommandType::Spawn:
+        active_species_[command.species] = 1;
+        if (dynamics_ == WorldDynamics::Ode) {
+            densities_[command.species] += command.amount;
+        } else {
+            spawnAgents(command.species, command.amount);
         }
-    } else if (command == "set_param") {
-        auto name_it = params.find("name");
-        auto value_it = params.find("value");
-        if (name_it != params.end() && value_it != params.end()) {
-            params_[name_it->second] = std::stod(value_it->second);
+        refreshPopulation();
+        break;
+    case WorldCommandType::SetParam:
+        param_values_[command.param] = command.value;
+        if (command.param == kParamMetabolism) {
+            metabolism_.decay = static_cast<float>(command.value);
+        } else if (command.param == kParamMaxAge) {
+            metabolism_.max_age = static_cast<std::uint32_t>(command.value);
+        } else {
+            applyOdeParam(command.param);
+            applyResourceParam(command.param);
         }
-    } else if (command == "apply_shock") {
-        auto strength_it = params.find("strength");
-        if (strength_it != params.end()) {
-            double strength = std::stod(strength_it->second);
-            for (const auto &species : species_order_) {
-                auto &count = read_model_.population_by_species[species];
-                count = static_cast<int>(count * (1.0 - strength));
+        break;
+    case WorldCommandType::ApplyShock: {
+        if (dynamics_ == WorldDynamics::Ode) {
+            for (auto &density : densities_) {
+                density *= 1.0 - command.value;
             }
+            refreshPopulation();
+            break;
         }
-    } else if (command == "stop.at_tick") {
-        auto tick_it = params.find("value");
-        if (tick_it != params.end()) {
-            stop_at_tick_ = std::stoi(tick_it->second);
+        std::vector<std::size_t> to_kill(read_model_.species.size());
+        for (std::size_t i = 0; i < to_kill.size(); ++i) {
+            auto count = agents_.count(static_cast<SpeciesId>(i));
+            auto survivors = static_cast<std::size_t>(static_cast<int>(count * (1.0 - command.value)));
+            to_kill[i] = count - std::min(count, survivors);
         }
+        const auto &species = agents_.species();
+        for (std::size_t row = 0, n = agents_.size(); row < n; ++row) {
+            if (to_kill[species[row]] > 0) {
+                --to_kill[species[row]];
+                float energy = agents_.energy()[row];
+                energy_sum_ -= energy;
+                extremes_stale_ = extremes_stale_ || energy <= energy_low_ || energy >= energy_high_;
+                agents_.kill(row);
+            }
+        }
+        agents_.compact();
+        refreshPopulation();
+        break;
+    }
+    case WorldCommandType::StopAtTick:
+        stop_at_tick_ = command.amount;
+        break;
     }
 }
 
 void SimulationWorld::emitTickEvent() {
-    SimulationEvent event;
-    event.type = "world.tick";
+    TypedEvent event(&context_.tickArena());
+    event.type = tick_event_type_;
     event.tick = read_model_.tick;
-    event.payload["seed"] = std::to_string(read_model_.seed);
-    event.payload["tick"] = std::to_string(read_model_.tick);
-    event.payload["energy_total"] = std::to_string(read_model_.energy_total);
-    for (const auto &pair : read_model_.population_by_species) {
-        event.payload["population." + pair.first] = std::to_string(pair.second);
+    const auto &population = read_model_.population;
+    event.fields.reserve(3 + population.size());
+    event.add(seed_field_, EventValue::ofInt(read_model_.seed));
+    event.add(tick_field_, EventValue::ofInt(read_model_.tick));
+    event.add(energy_field_, EventValue::ofInt(read_model_.energy_total));
+    for (std::size_t i = 0; i < population.size(); ++i) {
+        event.add(population_fields_[i], EventValue::ofInt(population[i]));
     }
-    context_.eventBus().emit(event);
-    context_.logger().log(LogChannel::Simulation,
-                          "Tick " + std::to_string(read_model_.tick) + " population=" +
-                              std::to_string(read_model_.population_by_species.size()));
+    context_.eventBus().emit(std::move(event));
+    char message[64];
+    std::snprintf(message, sizeof(message), "Tick %d population=%zu", read_model_.tick,
+                  population.size());
+    context_.logger().log(LogChannel::Simulation, message);
 }
 
 bool SimulationWorld::shouldStop() const {
     return stop_at_tick_ >= 0 && read_model_.tick >= stop_at_tick_;
 }
 
-std::string SimulationWorld::checksum() const {
-    long long total = 0;
-    for (const auto &pair : read_model_.population_by_species) {
-        total = total * 31 + pair.second;
+const std::array<const char *, SimulationWorld::kDigestCount> SimulationWorld::kDigestNames = {
+    "world", "population", "agents", "aggregates"};
+
+// Canonical state, in update order: scalar world state, populations by species id, the agent
+// columns in row order (hashed per chunk on the worker pool, chunk digests folded in order) and
+// the read-model aggregates.
+std::array<std::uint64_t, SimulationWorld::kDigestCount> SimulationWorld::stateDigests() const {
+    std::array<std::uint64_t, kDigestCount> digests{};
+
+    Hash64 world;
+    world.add(read_model_.tick);
+    world.add(read_model_.seed);
+    world.add(stop_at_tick_);
+    world.add(spawned_);
+    world.update(param_values_.data(), param_values_.size() * sizeof(double));
+    world.update(intents_.data(), intent_count_ * sizeof(AgentIntent));
+    if (!resources_.empty()) {
+        world.add(resources_.digest());
+    }
+    digests[0] = world.digest();
+
+    Hash64 population;
+    population.add(read_model_.population.size());
+    population.update(read_model_.population.data(), read_model_.population.size() * sizeof(int));
+    for (const auto &name : read_model_.species.names()) {
+        population.update(name.c_str(), name.size() + 1);
     }
-    total = total * 31 + read_model_.energy_total;
-    total = total * 31 + read_model_.seed;
-    return std::to_string(total);
+    population.update(densities_.data(), densities_.size() * sizeof(double));
+    digests[1] = population.digest();
+
+    const std::size_t rows = agents_.size();
+    chunk_hashes_.resize(agents_.chunkCount());
+    context_.workers().parallelFor(chunk_hashes_.size(), [this](std::size_t chunk) {
+        const std::size_t count = agents_.chunkRows(chunk);
+        Hash64 hash(chunk);
+        hash.update(agents_.species().chunk(chunk), count * sizeof(SpeciesId));
+        hash.update(agents_.x().chunk(chunk), count * sizeof(float));
+        hash.update(agents_.y().chunk(chunk), count * sizeof(float));
+        hash.update(agents_.energy().chunk(chunk), count * sizeof(float));
+        hash.update(agents_.age().chunk(chunk), count * sizeof(std::uint32_t));
+        hash.update(agents_.alive().chunk(chunk), count * sizeof(std::uint8_t));
+        chunk_hashes_[chunk] = hash.digest();
+    });
+    Hash64 agents;
+    agents.add(rows);
+    agents.update(chunk_hashes_.data(), chunk_hashes_.size() * sizeof(std::uint64_t));
+    digests[2] = agents.digest();
+
+    Hash64 aggregates;
+    aggregates.add(read_model_.agent_count);
+    aggregates.add(read_model_.energy_sum);
+    aggregates.add(read_model_.energy_min);
+    aggregates.add(read_model_.energy_max);
+    aggregates.add(read_model_.energy_total);
+    digests[3] = aggregates.digest();
+    return digests;
+}
+
+std::string SimulationWorld::checksum() const {
+    auto digests = stateDigests();
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx",
+                  static_cast<unsigned long long>(hash64(digests.data(), sizeof(digests))));
+    return text;
 }
 
 } // namespace ecosim
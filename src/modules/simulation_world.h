@@ -1,44 +1,161 @@
 #pragma once
 
+#include "core/checksum_stream.h"
 #include "core/module.h"
+#include "core/snapshot.h"
+#include "modules/agent_kernels.h"
+#include "modules/agent_store.h"
+#include "modules/population_ode.h"
+#include "modules/read_model_publisher.h"
+#include "modules/resource_field.h"
 #include "modules/world_port.h"
 
+#include <array>
+#include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace ecosim {
 
-class SimulationWorld : public IModule, public IWorldPort {
+// Agents: every agent is simulated (metabolism, births, spatial index). Ode: the species vector is
+// a set of continuous densities advanced by generalized Lotka-Volterra equations over dt per tick.
+enum class WorldDynamics { Agents, Ode };
+
+class SimulationWorld : public IModule, public IWorldPort, public ISnapshotable {
 public:
     SimulationWorld(const ModuleInstanceConfig &instance, ModuleContext &context);
 
+    // What-if branch of this world at the current tick boundary, living in `context` (its own bus,
+    // workers and random streams). Agent columns are shared copy-on-write, so the fork costs
+    // O(chunks) and each side only pays for the chunks it writes afterwards. The fork needs no
+    // onInit() and never writes a checksum stream.
+    std::unique_ptr<SimulationWorld> fork(ModuleContext &context) const;
+
     const std::string &typeId() const override { return type_id_; }
     const std::string &instanceId() const override { return instance_id_; }
 
     void onInit() override;
     void onPreTick() override;
     void onTick() override;
+    void onStop() override;
 
+    bool parseCommand(const std::string &command, const std::map<std::string, std::string> &params,
+                      WorldCommand &out, std::string &error) override;
+    void enqueueCommands(const WorldCommand *commands, std::size_t count) override;
     void enqueueCommand(const std::string &command,
                         const std::map<std::string, std::string> &params) override;
+    // Value of a set_param parameter, 0 if never set.
+    double param(const std::string &name) const;
+
+    // Full world state at a tick boundary: read model, species and parameter tables, agent columns,
+    // pending commands and the RNG seed/tick. Sections are named "world.*".
+    void saveSnapshot(SnapshotWriter &out) const override;
+    bool restoreSnapshot(const SnapshotReader &in, std::string &error) override;
 
     const ReadModel &readModel() const override { return read_model_; }
+    // Published after onInit(), after pre-tick commands, at the end of each onTick() and after a
+    // restore.
+    ReadModelSnapshot snapshot() const override { return publisher_.acquire(); }
+    const ReadModelPublisher &publisher() const { return publisher_; }
     bool shouldStop() const override;
+    void queryRadius(float x, float y, float radius, std::vector<Neighbor> &out) const override;
+    void queryNearest(float x, float y, std::size_t k, std::vector<Neighbor> &out) const override;
+
+    // XXH64 digests of the canonical world state, one per subsystem (kDigestNames order);
+    // checksum() is the hex digest over all of them. Like readModel(), only for the simulation thread
+    // between phases: both hash on the worker pool into shared scratch.
+    static constexpr std::size_t kDigestCount = 4;
+    static const std::array<const char *, kDigestCount> kDigestNames;
+    std::array<std::uint64_t, kDigestCount> stateDigests() const;
     std::string checksum() const;
+    const AgentStore &agents() const override { return agents_; }
+    AgentIntent *beginIntents(std::size_t count) override;
+    float worldSize() const override { return world_size_; }
+    const SpatialGrid &spatialIndex() const { return grid_; }
+    KernelPath kernelPath() const { return kernel_path_; }
+    WorldDynamics dynamics() const { return dynamics_; }
+    // Species densities in Ode mode (population is their rounded value); empty in Agents mode.
+    const std::vector<double> &densities() const { return densities_; }
+    // Empty unless the resource_cells instance parameter is set.
+    const ResourceField &resources() const override { return resources_; }
+    // Number of times verify mode found an incremental aggregate differing from a full recomputation.
+    std::size_t aggregateMismatches() const { return aggregate_mismatches_; }
 
 private:
-    void applyCommand(const std::string &command, const std::map<std::string, std::string> &params);
+    SimulationWorld(const SimulationWorld &parent, ModuleContext &context);
+
+    void registerEvents();
+    void applyCommand(const WorldCommand &command);
+    SpeciesId internSpecies(const std::string &name);
+    std::uint16_t internParam(const std::string &name);
     void emitTickEvent();
+    void spawnAgents(SpeciesId species, int count);
+    int speciesCount(std::size_t species) const;
+    void refreshPopulation();
+    void integratePopulation();
+    bool parseOdeParam(const std::string &name, bool intern, std::size_t &species, std::size_t &other);
+    void applyOdeParam(std::uint16_t param);
+    void applyResourceParam(std::uint16_t param);
+    void consumeResources();
+    void applyIntents();
+    void moveAgents(std::size_t chunk);
+    float clampCoordinate(float value) const;
+    void publishAggregates();
+    void verifyAggregates();
+    void rebuildIndex();
+    MetabolismResult runMetabolism();
 
     std::string type_id_;
     std::string instance_id_;
     ModuleContext &context_;
     ReadModel read_model_;
-    std::map<std::string, double> params_;
-    std::vector<std::string> species_order_;
-    std::vector<std::pair<std::string, std::map<std::string, std::string>>> pending_commands_;
+    ReadModelPublisher publisher_;
+    // set_param values by param id; names stay interned across world.reset, like species.
+    std::vector<std::string> param_names_{"metabolism", "max_age"};
+    std::vector<double> param_values_{0.0, 0.0};
+    std::vector<EventFieldId> population_fields_;
+    // Species spawned since the last reset; each gets one birth per tick.
+    std::vector<std::uint8_t> active_species_;
+    std::vector<WorldCommand> pending_commands_;
+    // Entries [0, intent_count_) are pending; the vector only grows, so refills do not allocate.
+    std::vector<AgentIntent> intents_;
+    std::size_t intent_count_ = 0;
+    AgentStore agents_;
+    std::uint64_t spawned_ = 0;
+    std::uint32_t spawn_stream_ = RandomStreams::streamId("world.spawn");
+    float world_size_ = 1000.0f;
+    SpatialGrid grid_;
+    float cell_size_ = 0.0f;
+    MetabolismParams metabolism_;
+    KernelPath kernel_path_ = KernelPath::Scalar;
+    MetabolismKernel metabolism_kernel_ = nullptr;
+    std::vector<MetabolismResult> chunk_results_;
+    mutable std::vector<std::uint64_t> chunk_hashes_;
+    ChecksumStreamWriter checksum_stream_;
+    std::string checksum_stream_path_;
+    double energy_sum_ = 0.0;
+    float energy_low_ = std::numeric_limits<float>::infinity();
+    float energy_high_ = -std::numeric_limits<float>::infinity();
+    // Set when an agent holding the minimum or maximum energy is removed.
+    bool extremes_stale_ = false;
+    std::uint64_t population_hash_ = 0;
+    std::vector<std::uint64_t> hash_weights_;
+    bool verify_aggregates_ = false;
+    std::size_t aggregate_mismatches_ = 0;
     int stop_at_tick_ = -1;
+    EventTypeId tick_event_type_ = 0;
+    EventFieldId seed_field_ = 0;
+    EventFieldId tick_field_ = 0;
+    EventFieldId energy_field_ = 0;
+    WorldDynamics dynamics_ = WorldDynamics::Agents;
+    OdeMethod ode_method_ = OdeMethod::Rk45;
+    double ode_tolerance_ = 1e-6;
+    PopulationOde ode_;
+    std::vector<double> densities_;
+    ResourceField resources_;
+    float resource_intake_ = 0.0f;
 };
 
 } // namespace ecosim
@@ -0,0 +1,173 @@
+#include "modules/spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ecosim {
+
+namespace {
+bool closer(const Neighbor &a, const Neighbor &b) {
+    return a.distance_sq != b.distance_sq ? a.distance_sq < b.distance_sq : a.row < b.row;
+}
+} // namespace
+
+void SpatialGrid::rebuild(const AgentStore &agents, float world_size, float cell_size) {
+    agents_ = &agents;
+    const std::size_t count = agents.size();
+    if (cell_size > 0.0f) {
+        side_ = static_cast<std::uint32_t>(std::min<double>(std::ceil(world_size / cell_size), kMaxCellsPerSide));
+    } else {
+        side_ = static_cast<std::uint32_t>(std::min<double>(std::ceil(std::sqrt(count / 2.0)), kMaxCellsPerSide));
+    }
+    side_ = std::max<std::uint32_t>(side_, 1);
+    cell_size_ = world_size / static_cast<float>(side_);
+    inv_cell_size_ = 1.0f / cell_size_;
+
+    const std::size_t cells = static_cast<std::size_t>(side_) * side_;
+    cell_start_.assign(cells + 1, 0);
+    cell_of_.resize(count);
+    rows_.resize(count);
+    xs_.resize(count);
+    ys_.resize(count);
+
+    for (std::size_t chunk = 0, base = 0; chunk < agents.chunkCount(); base += agents.chunkRows(chunk++)) {
+        const float *x = agents.x().chunk(chunk);
+        const float *y = agents.y().chunk(chunk);
+        for (std::size_t i = 0, rows = agents.chunkRows(chunk); i < rows; ++i) {
+            auto cell = cellCoord(y[i]) * side_ + cellCoord(x[i]);
+            cell_of_[base + i] = cell;
+            ++cell_start_[cell + 1];
+        }
+    }
+    for (std::size_t cell = 0; cell < cells; ++cell) {
+        cell_start_[cell + 1] += cell_start_[cell];
+    }
+    // Scatter with cell_start_[cell] as the write cursor, then shift the starts back by one cell.
+    for (std::size_t chunk = 0, base = 0; chunk < agents.chunkCount(); base += agents.chunkRows(chunk++)) {
+        const float *x = agents.x().chunk(chunk);
+        const float *y = agents.y().chunk(chunk);
+        for (std::size_t i = 0, rows = agents.chunkRows(chunk); i < rows; ++i) {
+            auto slot = cell_start_[cell_of_[base + i]]++;
+            rows_[slot] = static_cast<std::uint32_t>(base + i);
+            xs_[slot] = x[i];
+            ys_[slot] = y[i];
+        }
+    }
+    for (std::size_t cell = cells; cell > 0; --cell) {
+        cell_start_[cell] = cell_start_[cell - 1];
+    }
+    cell_start_[0] = 0;
+}
+
+std::size_t SpatialGrid::displaced() const {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < rows_.size(); ++i) {
+        count += rows_[i] != i;
+    }
+    return count;
+}
+
+std::size_t SpatialGrid::fragments() const {
+    std::size_t count = !rows_.empty() && rows_[0] != 0;
+    for (std::size_t i = 1; i < rows_.size(); ++i) {
+        count += rows_[i] != rows_[i - 1] + 1;
+    }
+    return count;
+}
+
+void SpatialGrid::adoptOrder() {
+    for (std::size_t i = 0; i < rows_.size(); ++i) {
+        rows_[i] = static_cast<std::uint32_t>(i);
+    }
+}
+
+std::uint32_t SpatialGrid::cellCoord(float value) const {
+    float cell = value * inv_cell_size_;
+    if (!(cell > 0.0f)) {
+        return 0;
+    }
+    return std::min(static_cast<std::uint32_t>(cell), side_ - 1);
+}
+
+void SpatialGrid::scanCell(std::uint32_t cx, std::uint32_t cy, float x, float y, float radius_sq,
+                           std::vector<Neighbor> &out) const {
+    auto cell = static_cast<std::size_t>(cy) * side_ + cx;
+    for (auto i = cell_start_[cell], end = cell_start_[cell + 1]; i < end; ++i) {
+        float dx = xs_[i] - x;
+        float dy = ys_[i] - y;
+        float distance_sq = dx * dx + dy * dy;
+        if (distance_sq <= radius_sq) {
+            out.push_back({agents_->handle(rows_[i]), rows_[i], distance_sq});
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(float x, float y, float radius, std::vector<Neighbor> &out) const {
+    if (rows_.empty() || radius < 0.0f) {
+        return;
+    }
+    auto x0 = cellCoord(x - radius);
+    auto x1 = cellCoord(x + radius);
+    auto y0 = cellCoord(y - radius);
+    auto y1 = cellCoord(y + radius);
+    for (auto cy = y0; cy <= y1; ++cy) {
+        for (auto cx = x0; cx <= x1; ++cx) {
+            scanCell(cx, cy, x, y, radius * radius, out);
+        }
+    }
+}
+
+// Scans square rings of cells around the query cell. Cells outside ring r are at least
+// r * cell_size away, so the search stops once the k-th candidate is closer than that.
+void SpatialGrid::queryNearest(float x, float y, std::size_t k, std::vector<Neighbor> &out) const {
+    out.clear();
+    if (rows_.empty() || k == 0) {
+        return;
+    }
+    const auto cx = static_cast<std::int64_t>(cellCoord(x));
+    const auto cy = static_cast<std::int64_t>(cellCoord(y));
+    const std::int64_t side = side_;
+    for (std::int64_t ring = 0; ring < side; ++ring) {
+        auto visit = [&](std::int64_t gx, std::int64_t gy) {
+            if (gx < 0 || gy < 0 || gx >= side || gy >= side) {
+                return;
+            }
+            auto cell = static_cast<std::size_t>(gy * side + gx);
+            for (auto i = cell_start_[cell], end = cell_start_[cell + 1]; i < end; ++i) {
+                float dx = xs_[i] - x;
+                float dy = ys_[i] - y;
+                Neighbor candidate{{}, rows_[i], dx * dx + dy * dy};
+                if (out.size() < k) {
+                    out.push_back(candidate);
+                    std::push_heap(out.begin(), out.end(), closer);
+                } else if (closer(candidate, out.front())) {
+                    std::pop_heap(out.begin(), out.end(), closer);
+                    out.back() = candidate;
+                    std::push_heap(out.begin(), out.end(), closer);
+                }
+            }
+        };
+        if (ring == 0) {
+            visit(cx, cy);
+        } else {
+            for (std::int64_t d = -ring; d <= ring; ++d) {
+                visit(cx + d, cy - ring);
+                visit(cx + d, cy + ring);
+            }
+            for (std::int64_t d = -ring + 1; d < ring; ++d) {
+                visit(cx - ring, cy + d);
+                visit(cx + ring, cy + d);
+            }
+        }
+        float reach = static_cast<float>(ring) * cell_size_;
+        if (out.size() == k && out.front().distance_sq <= reach * reach) {
+            break;
+        }
+    }
+    std::sort_heap(out.begin(), out.end(), closer);
+    for (auto &neighbor : out) {
+        neighbor.agent = agents_->handle(neighbor.row);
+    }
+}
+
+} // namespace ecosim
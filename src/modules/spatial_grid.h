@@ -0,0 +1,61 @@
+#pragma once
+
+#include "modules/agent_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecosim {
+
+struct Neighbor {
+    AgentHandle agent;
+    // Row in AgentStore; valid until the store is compacted or the grid is rebuilt.
+    std::uint32_t row = 0;
+    float distance_sq = 0.0f;
+};
+
+// Uniform grid over the square [0, world_size)^2. rebuild() buckets agents by cell with a counting
+// sort, so each cell's agents (and a copy of their positions) are contiguous.
+class SpatialGrid {
+public:
+    static constexpr std::uint32_t kMaxCellsPerSide = 4096;
+
+    // cell_size <= 0 picks a cell size giving about two agents per cell.
+    void rebuild(const AgentStore &agents, float world_size, float cell_size);
+
+    // Appends agents within `radius` of (x, y) to `out`, in cell order.
+    void queryRadius(float x, float y, float radius, std::vector<Neighbor> &out) const;
+    // Replaces `out` with the k nearest agents, closest first (ties by row).
+    void queryNearest(float x, float y, std::size_t k, std::vector<Neighbor> &out) const;
+
+    // Rows of the store in cell order, and how many of them are out of place.
+    const std::vector<std::uint32_t> &order() const { return rows_; }
+    std::size_t displaced() const;
+    // Breaks in order(): positions whose row does not follow the previous one. A few appended rows
+    // displace every row after their cells but add only two breaks each.
+    std::size_t fragments() const;
+    // Call after AgentStore::reorder(order()): rows now coincide with grid positions.
+    void adoptOrder();
+
+    std::uint32_t cellsPerSide() const { return side_; }
+    float cellSize() const { return cell_size_; }
+    std::size_t size() const { return rows_.size(); }
+
+private:
+    std::uint32_t cellCoord(float value) const;
+    void scanCell(std::uint32_t cx, std::uint32_t cy, float x, float y, float radius_sq,
+                  std::vector<Neighbor> &out) const;
+
+    const AgentStore *agents_ = nullptr;
+    float cell_size_ = 1.0f;
+    float inv_cell_size_ = 1.0f;
+    std::uint32_t side_ = 1;
+    std::vector<std::uint32_t> cell_start_;
+    std::vector<std::uint32_t> rows_;
+    std::vector<float> xs_;
+    std::vector<float> ys_;
+    std::vector<std::uint32_t> cell_of_;
+};
+
+} // namespace ecosim
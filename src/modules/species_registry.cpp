@@ -0,0 +1,29 @@
+#include "modules/species_registry.h"
+
+namespace ecosim {
+
+SpeciesId SpeciesRegistry::intern(const std::string &name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    if (names_.size() >= kInvalid) {
+        return kInvalid;
+    }
+    auto id = static_cast<SpeciesId>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(name, id);
+    return id;
+}
+
+SpeciesId SpeciesRegistry::find(const std::string &name) const {
+    auto it = ids_.find(name);
+    return it != ids_.end() ? it->second : kInvalid;
+}
+
+void SpeciesRegistry::clear() {
+    names_.clear();
+    ids_.clear();
+}
+
+} // namespace ecosim
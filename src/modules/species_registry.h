@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ecosim {
+
+using SpeciesId = std::uint16_t;
+
+// Interns species names to dense ids in order of first appearance. Names are only looked up at the
+// I/O edges (commands, output); everything per tick indexes by id.
+class SpeciesRegistry {
+public:
+    static constexpr SpeciesId kInvalid = 0xffff;
+
+    // Returns the existing id or assigns the next one; kInvalid once all ids are taken.
+    SpeciesId intern(const std::string &name);
+    SpeciesId find(const std::string &name) const;
+    const std::string &name(SpeciesId id) const { return names_[id]; }
+    const std::vector<std::string> &names() const { return names_; }
+    std::size_t size() const { return names_.size(); }
+    void clear();
+
+private:
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, SpeciesId> ids_;
+};
+
+} // namespace ecosim
@@ -0,0 +1,66 @@
+#include "modules/world_branch.h"
+
+#include <algorithm>
+
+namespace ecosim {
+
+WorldBranch::WorldBranch(const SimulationWorld &parent, const AppConfig &config)
+    : logger_(log_), config_(config), context_(logger_, event_bus_, config_, workers_, tick_arena_),
+      world_(parent.fork(context_)) {}
+
+bool WorldBranch::schedule(const std::vector<ScenarioConfig::ScheduledAction> &actions, std::string &error) {
+    const int now = world_->readModel().tick;
+    for (const auto &action : actions) {
+        if (action.tick <= now) {
+            error = "branch action at tick " + std::to_string(action.tick) + " is not after the fork at tick " +
+                    std::to_string(now);
+            return false;
+        }
+        ScheduledCommand scheduled;
+        scheduled.tick = action.tick;
+        if (!world_->parseCommand(action.command, action.params, scheduled.command, error)) {
+            return false;
+        }
+        schedule_.push_back(scheduled);
+    }
+    std::stable_sort(schedule_.begin(), schedule_.end(),
+                     [](const ScheduledCommand &a, const ScheduledCommand &b) { return a.tick < b.tick; });
+    return true;
+}
+
+// The same phases as Application::runHeadless for a world without other modules.
+void WorldBranch::run(int ticks) {
+    tick_arena_.claimForCurrentThread();
+    for (int i = 0; i < ticks && !world_->shouldStop(); ++i) {
+        const int next_tick = world_->readModel().tick + 1;
+        batch_.clear();
+        while (cursor_ < schedule_.size() && schedule_[cursor_].tick == next_tick) {
+            batch_.push_back(schedule_[cursor_++].command);
+        }
+        if (!batch_.empty()) {
+            world_->enqueueCommands(batch_.data(), batch_.size());
+        }
+        world_->onPreTick();
+        world_->onTick();
+        event_bus_.deliverBuffered();
+        tick_arena_.nextTick();
+    }
+}
+
+std::vector<std::unique_ptr<WorldBranch>>
+runBranches(const SimulationWorld &parent, const AppConfig &config,
+            const std::vector<std::vector<ScenarioConfig::ScheduledAction>> &schedules, int ticks,
+            ThreadPool &workers, std::string &error) {
+    std::vector<std::unique_ptr<WorldBranch>> branches;
+    for (const auto &actions : schedules) {
+        branches.push_back(std::make_unique<WorldBranch>(parent, config));
+        if (!branches.back()->schedule(actions, error)) {
+            branches.clear();
+            return branches;
+        }
+    }
+    workers.parallelFor(branches.size(), [&branches, ticks](std::size_t i) { branches[i]->run(ticks); });
+    return branches;
+}
+
+} // namespace ecosim
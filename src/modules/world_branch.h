@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/config.h"
+#include "core/event_bus.h"
+#include "core/logger.h"
+#include "core/module.h"
+#include "core/thread_pool.h"
+#include "core/tick_arena.h"
+#include "modules/simulation_world.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ecosim {
+
+// A what-if branch: a fork of a running world with its own bus, log, tick arena and random streams,
+// driven by its own schedule of world commands. The branch owns no started worker pool, so its ticks
+// run on the calling thread and several branches can run side by side on a shared pool.
+class WorldBranch {
+public:
+    WorldBranch(const SimulationWorld &parent, const AppConfig &config);
+
+    WorldBranch(const WorldBranch &) = delete;
+    WorldBranch &operator=(const WorldBranch &) = delete;
+
+    // Parses actions like the scenario runner does; an action runs in the pre-tick of its tick, so
+    // ticks must lie after the fork point.
+    bool schedule(const std::vector<ScenarioConfig::ScheduledAction> &actions, std::string &error);
+    // Advances exactly `ticks` ticks, or fewer if the world's stop condition is reached.
+    void run(int ticks);
+
+    SimulationWorld &world() { return *world_; }
+    const SimulationWorld &world() const { return *world_; }
+    EventBus &eventBus() { return event_bus_; }
+    std::string log() const { return log_.str(); }
+
+private:
+    struct ScheduledCommand {
+        int tick = 0;
+        WorldCommand command;
+    };
+
+    std::ostringstream log_;
+    Logger logger_;
+    EventBus event_bus_;
+    AppConfig config_;
+    ThreadPool workers_;
+    TickArena tick_arena_;
+    ModuleContext context_;
+    std::unique_ptr<SimulationWorld> world_;
+    std::vector<ScheduledCommand> schedule_;
+    std::vector<WorldCommand> batch_;
+    std::size_t cursor_ = 0;
+};
+
+// Forks `parent` once per schedule on the calling thread, then runs the branches `ticks` ticks each
+// across `workers`. Returns no branches if any schedule fails to parse.
+std::vector<std::unique_ptr<WorldBranch>>
+runBranches(const SimulationWorld &parent, const AppConfig &config,
+            const std::vector<std::vector<ScenarioConfig::ScheduledAction>> &schedules, int ticks,
+            ThreadPool &workers, std::string &error);
+
+} // namespace ecosim
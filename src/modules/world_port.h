@@ -1,25 +1,125 @@
 #pragma once
 
+#include "modules/spatial_grid.h"
+#include "modules/species_registry.h"
+
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace ecosim {
 
+class ReadModelSnapshot;
+class ResourceField;
+
 struct ReadModel {
     int tick = 0;
     int seed = 0;
-    std::map<std::string, int> population_by_species;
+    // Alive agents per SpeciesId; `species` holds the name table for output.
+    std::vector<int> population;
+    SpeciesRegistry species;
     int energy_total = 0;
+    // Aggregates maintained by the world from per-mutation deltas; reading them is O(1). Min and max
+    // are 0 when there are no agents.
+    std::size_t agent_count = 0;
+    double energy_sum = 0.0;
+    float energy_min = 0.0f;
+    float energy_max = 0.0f;
+    // Rolling hash of populations (in id order), energy_total and seed; printed by checksum().
+    std::uint64_t state_hash = 0;
+
+    double energyMean() const { return agent_count != 0 ? energy_sum / static_cast<double>(agent_count) : 0.0; }
+    int populationOf(const std::string &name) const {
+        auto id = species.find(name);
+        return id < population.size() ? population[id] : 0;
+    }
+};
+
+// 16-bit so WorldCommand has no padding bytes (pending commands are written to snapshots).
+enum class WorldCommandType : std::uint16_t { Reset, Spawn, SetParam, ApplyShock, StopAtTick };
+
+// Well-known parameter ids; other set_param names get ids from kFirstCustomParam on.
+enum WorldParam : std::uint16_t { kParamMetabolism = 0, kParamMaxAge = 1, kFirstCustomParam = 2 };
+
+// A world command validated and parsed once (names interned, numbers converted), so applying it is
+// a switch on `type`. Trivially copyable; fields not used by a type stay zero.
+struct WorldCommand {
+    WorldCommandType type = WorldCommandType::Reset;
+    SpeciesId species = 0;      // Spawn
+    std::uint16_t param = 0;    // SetParam
+    std::uint16_t reserved = 0;
+    std::int32_t amount = 0;    // Spawn: count; Reset: seed; StopAtTick: tick
+    std::uint32_t reserved2 = 0;
+    double value = 0.0;         // SetParam: value; ApplyShock: strength
+
+    static WorldCommand reset(std::int32_t seed) { return {WorldCommandType::Reset, 0, 0, 0, seed, 0, 0.0}; }
+    static WorldCommand spawn(SpeciesId species, std::int32_t count) {
+        return {WorldCommandType::Spawn, species, 0, 0, count, 0, 0.0};
+    }
+    static WorldCommand setParam(std::uint16_t param, double value) {
+        return {WorldCommandType::SetParam, 0, param, 0, 0, 0, value};
+    }
+    static WorldCommand applyShock(double strength) {
+        return {WorldCommandType::ApplyShock, 0, 0, 0, 0, 0, strength};
+    }
+    static WorldCommand stopAtTick(std::int32_t tick) {
+        return {WorldCommandType::StopAtTick, 0, 0, 0, tick, 0, 0.0};
+    }
+};
+static_assert(sizeof(WorldCommand) == 24, "WorldCommand must have no padding bytes");
+
+// 32-bit so AgentIntent has no padding bytes (intents are hashed and written to snapshots).
+enum class AgentAction : std::uint32_t { Rest, Move, Forage, Flee, Hunt, Reproduce };
+
+// One agent's decision, applied by the world in its next onPreTick before queued commands. Move,
+// Forage, Flee and Hunt displace the agent by (dx, dy); Hunt then eats `target` (its energy goes to
+// the hunter) if both are still alive; Reproduce splits the agent's energy with a child spawned at
+// its position. Trivially copyable.
+struct AgentIntent {
+    AgentHandle agent;
+    AgentHandle target;
+    float dx = 0.0f;
+    float dy = 0.0f;
+    AgentAction action = AgentAction::Rest;
 };
 
 class IWorldPort {
 public:
     virtual ~IWorldPort() = default;
 
+    // Validates `command` with its string params and converts it to a WorldCommand, interning species
+    // and parameter names; on failure returns false with a reason in `error`. Call once at load time.
+    virtual bool parseCommand(const std::string &command, const std::map<std::string, std::string> &params,
+                              WorldCommand &out, std::string &error) = 0;
+    // Queues parsed commands for the next onPreTick, e.g. all of one tick's scenario actions at once.
+    virtual void enqueueCommands(const WorldCommand *commands, std::size_t count) = 0;
+    // Convenience: parseCommand + enqueueCommands; invalid commands are logged and dropped.
     virtual void enqueueCommand(const std::string &command,
                                 const std::map<std::string, std::string> &params) = 0;
+    // Live model; only for the simulation thread, between phases.
     virtual const ReadModel &readModel() const = 0;
+    // Latest version published at a tick boundary (read_model_publisher.h); safe from any thread,
+    // also while a tick runs.
+    virtual ReadModelSnapshot snapshot() const = 0;
     virtual bool shouldStop() const = 0;
+
+    // Neighbour queries over agent positions as of the last index rebuild (end of onPreTick
+    // commands and of onTick). Results reference agents by stable handle.
+    virtual void queryRadius(float x, float y, float radius, std::vector<Neighbor> &out) const = 0;
+    virtual void queryNearest(float x, float y, std::size_t k, std::vector<Neighbor> &out) const = 0;
+
+    // Agent columns as of the end of the last phase that changed them; read-only, and safe to read
+    // from several threads while no phase of the world runs.
+    virtual const AgentStore &agents() const = 0;
+    // Intent buffer for the next onPreTick: `count` entries owned by the world, which the caller
+    // fills before that phase (distinct entries may be written in parallel). Entries are applied in
+    // index order and agents that died meanwhile are skipped. Replaces intents not yet applied.
+    virtual AgentIntent *beginIntents(std::size_t count) = 0;
+    // Side of the square world; positions lie in [0, worldSize()).
+    virtual float worldSize() const = 0;
+    // Resource grid (empty when the world has none); read-only, like agents().
+    virtual const ResourceField &resources() const = 0;
 };
 
 } // namespace ecosim
@@ -0,0 +1,40 @@
+#include "core/checksum_stream.h"
+
+#include <iostream>
+
+// Compares two per-tick checksum streams written by simulation_world (param checksum_stream).
+// Exit code: 0 identical, 1 diverged, 2 unreadable input.
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "usage: ecosim_checksum_diff <left.ecsum> <right.ecsum>\n";
+        return 2;
+    }
+    ecosim::ChecksumStream left;
+    ecosim::ChecksumStream right;
+    std::string error;
+    if (!ecosim::readChecksumStream(argv[1], left, error) || !ecosim::readChecksumStream(argv[2], right, error)) {
+        std::cerr << error << "\n";
+        return 2;
+    }
+
+    auto diff = ecosim::diffChecksumStreams(left, right);
+    if (!diff.diverged) {
+        std::cout << "identical: " << left.ticks.size() << " ticks\n";
+        return 0;
+    }
+    std::cout << "first divergence at tick " << diff.tick;
+    if (!diff.subsystems.empty()) {
+        std::cout << " in subsystem " << diff.subsystems.front();
+        for (std::size_t i = 1; i < diff.subsystems.size(); ++i) {
+            std::cout << (i == 1 ? " (also " : ", ") << diff.subsystems[i];
+        }
+        if (diff.subsystems.size() > 1) {
+            std::cout << ")";
+        }
+    }
+    if (!diff.note.empty()) {
+        std::cout << ": " << diff.note;
+    }
+    std::cout << "\n";
+    return 1;
+}
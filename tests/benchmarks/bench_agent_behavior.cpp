@@ -0,0 +1,135 @@
+#include "benchmarks/bench_framework.h"
+
+#include "integration/test_framework.h"
+#include "modules/agent_behavoir.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace ecosim_bench {
+
+namespace {
+const char *kBuiltInRules = "prey > 0 -> hunt; threats > 0 -> flee; energy >= 4 -> reproduce; "
+                            "predator -> move; true -> forage";
+
+// Runs onTick until about 0.2 s have passed; returns seconds per tick. The world does
+// not advance, so every pass decides for the same agents.
+double secondsPerDecision(ecosim::AgentBehavoir &behavior) {
+    Stopwatch watch;
+    std::size_t passes = 0;
+    do {
+        behavior.onTick();
+        ++passes;
+    } while (watch.seconds() < 0.2);
+    return watch.seconds() / static_cast<double>(passes);
+}
+
+// Only the decision step, cycling over 16 batches of random features; in onTick the features are
+// written by the sensing step just before, so they are in cache as well. Returns ns per agent.
+double nsPerDecision(const ecosim::AgentBehavoir &behavior) {
+    using ecosim::BehaviorFeature;
+    using ecosim::BehaviorProgram;
+    constexpr std::size_t kBatches = 16;
+    const std::size_t registers = std::max(BehaviorProgram::kFeatureCount, behavior.rules().registerCount());
+    std::vector<float> features(kBatches * registers * BehaviorProgram::kLanes);
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> value(0.0f, 8.0f);
+    for (std::size_t batch = 0; batch < kBatches; ++batch) {
+        float *base = features.data() + batch * registers * BehaviorProgram::kLanes;
+        for (std::size_t i = 0; i < BehaviorProgram::kLanes; ++i) {
+            BehaviorProgram::feature(base, BehaviorFeature::Energy)[i] = value(random);
+            BehaviorProgram::feature(base, BehaviorFeature::Prey)[i] = value(random) > 7.0f ? 1.0f : 0.0f;
+            BehaviorProgram::feature(base, BehaviorFeature::Threats)[i] = value(random) > 6.0f ? 1.0f : 0.0f;
+            BehaviorProgram::feature(base, BehaviorFeature::Predator)[i] = value(random) > 7.0f ? 1.0f : 0.0f;
+        }
+    }
+    std::vector<ecosim::AgentAction> actions(BehaviorProgram::kLanes);
+    Stopwatch watch;
+    std::size_t passes = 0;
+    do {
+        for (std::size_t batch = 0; batch < kBatches; ++batch) {
+            behavior.decide(features.data() + batch * registers * BehaviorProgram::kLanes, BehaviorProgram::kLanes,
+                            actions.data());
+            doNotOptimize(actions[0]);
+        }
+        ++passes;
+    } while (watch.seconds() < 0.2);
+    return watch.seconds() * 1e9 / static_cast<double>(passes * kBatches * BehaviorProgram::kLanes);
+}
+} // namespace
+
+class AgentBehaviorBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "behavior.decide"; }
+
+    // Density is fixed at 4 agents per unit^2 (one wolf per ten agents), so the neighbourhood each
+    // decision scans does not grow with N and time per agent should stay flat.
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        const std::size_t threads = ecosim::ThreadPool::defaultConcurrency();
+
+        ecosim_integration::WorldHarness rules_harness;
+        ecosim::AgentBehavoir native({"agent_behavoir", "native", true, {}}, rules_harness.context);
+        ecosim::AgentBehavoir compiled({"agent_behavoir", "compiled", true, {{"rules", kBuiltInRules}}},
+                                       rules_harness.context);
+        compiled.onInit();
+        const double native_ns = nsPerDecision(native);
+        const double compiled_ns = nsPerDecision(compiled);
+        results.push_back({"decision step built-in C++", native_ns, "ns/agent"});
+        results.push_back({"decision step rule bytecode", compiled_ns, "ns/agent"});
+        results.push_back({"decision step bytecode / C++", compiled_ns / native_ns, "x"});
+
+        for (std::size_t agents : {100000u, 1000000u, 10000000u}) {
+            const std::string label = agents >= 1000000 ? std::to_string(agents / 1000000) + "M"
+                                                        : std::to_string(agents / 1000) + "k";
+            const auto world_size = std::to_string(std::sqrt(static_cast<double>(agents) / 4.0));
+            ecosim_integration::WorldHarness harness(
+                {{"world_size", world_size}, {"reserve_agents", std::to_string(agents)}}, threads);
+            auto &world = harness.world;
+            world.enqueueCommand("spawn", {{"species", "deer"}, {"count", std::to_string(agents - agents / 10)}});
+            world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", std::to_string(agents / 10)}});
+            world.onPreTick();
+            world.onTick();
+
+            ecosim::ThreadPool inline_pool;
+            ecosim::ModuleContext single_context(harness.logger, harness.bus, harness.config, inline_pool,
+                                                 harness.arena);
+            ecosim::AgentBehavoir single({"agent_behavoir", "single", true, {}}, single_context);
+            single.setWorld(&world);
+            const double single_seconds = secondsPerDecision(single);
+            auto &pooled_context = harness.context;
+            ecosim::AgentBehavoir pooled({"agent_behavoir", "pooled", true, {}}, pooled_context);
+            pooled.setWorld(&world);
+            const double pooled_seconds = secondsPerDecision(pooled);
+            doNotOptimize(pooled.actionCounts()[0]);
+
+            const double count = static_cast<double>(world.agents().size());
+            results.push_back({"decide " + label + " single thread", single_seconds * 1e9 / count, "ns/agent"});
+            results.push_back({"decide " + label + " " + std::to_string(threads) + " threads",
+                               pooled_seconds * 1e9 / count, "ns/agent"});
+            results.push_back({"decide " + label + " throughput", count / pooled_seconds / 1e6, "Mdecisions/s"});
+            results.push_back({"decide " + label + " speedup", single_seconds / pooled_seconds, "x"});
+            if (agents == 1000000) {
+                ecosim::AgentBehavoir rules({"agent_behavoir", "rules", true, {{"rules", kBuiltInRules}}},
+                                            pooled_context);
+                rules.onInit();
+                rules.setWorld(&world);
+                results.push_back({"decide " + label + " rule bytecode", secondsPerDecision(rules) * 1e9 / count,
+                                   "ns/agent"});
+            }
+
+            Stopwatch watch;
+            world.onPreTick();
+            results.push_back({"apply " + label, watch.seconds() * 1e9 / count, "ns/agent"});
+        }
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeAgentBehaviorBenchmark() {
+    return std::make_unique<AgentBehaviorBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,35 @@
+#include "benchmarks/bench_cases.h"
+
+#include <memory>
+
+namespace ecosim_bench {
+
+std::unique_ptr<IBenchmark> makeEventDeliveryBenchmark();
+std::unique_ptr<IBenchmark> makeTickAllocationBenchmark();
+std::unique_ptr<IBenchmark> makeWorldTickBenchmark();
+std::unique_ptr<IBenchmark> makeSpatialGridBenchmark();
+std::unique_ptr<IBenchmark> makeMetabolismKernelBenchmark();
+std::unique_ptr<IBenchmark> makeRandomBenchmark();
+std::unique_ptr<IBenchmark> makeWorldForkBenchmark();
+std::unique_ptr<IBenchmark> makePopulationOdeBenchmark();
+std::unique_ptr<IBenchmark> makeResourceFieldBenchmark();
+std::unique_ptr<IBenchmark> makeAgentBehaviorBenchmark();
+std::unique_ptr<IBenchmark> makeFlowFieldBenchmark();
+
+std::vector<std::unique_ptr<IBenchmark>> buildBenchmarks() {
+    std::vector<std::unique_ptr<IBenchmark>> benchmarks;
+    benchmarks.push_back(makeEventDeliveryBenchmark());
+    benchmarks.push_back(makeTickAllocationBenchmark());
+    benchmarks.push_back(makeWorldTickBenchmark());
+    benchmarks.push_back(makeSpatialGridBenchmark());
+    benchmarks.push_back(makeMetabolismKernelBenchmark());
+    benchmarks.push_back(makeRandomBenchmark());
+    benchmarks.push_back(makeWorldForkBenchmark());
+    benchmarks.push_back(makePopulationOdeBenchmark());
+    benchmarks.push_back(makeResourceFieldBenchmark());
+    benchmarks.push_back(makeAgentBehaviorBenchmark());
+    benchmarks.push_back(makeFlowFieldBenchmark());
+    return benchmarks;
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "benchmarks/bench_framework.h"
+
+#include <memory>
+#include <vector>
+
+namespace ecosim_bench {
+
+std::vector<std::unique_ptr<IBenchmark>> buildBenchmarks();
+
+} // namespace ecosim_bench
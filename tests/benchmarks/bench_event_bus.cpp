@@ -0,0 +1,150 @@
+#include "benchmarks/bench_framework.h"
+
+#include "core/event_bus.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace ecosim_bench {
+
+namespace {
+constexpr int kTicks = 5;
+
+// Copy-then-lookup delivery as EventBus did it before double buffering; kept as the baseline.
+class CopyingBus {
+public:
+    void subscribe(ecosim::EventTypeId type, ecosim::EventBus::TypedHandler handler) {
+        subscribers_[type].push_back(std::move(handler));
+    }
+    void emit(ecosim::TypedEvent event) { buffer_.push_back(std::move(event)); }
+    void deliverBuffered() {
+        auto to_deliver = buffer_;
+        buffer_.clear();
+        for (const auto &event : to_deliver) {
+            auto it = subscribers_.find(event.type);
+            if (it == subscribers_.end()) {
+                continue;
+            }
+            for (const auto &handler : it->second) {
+                handler(event);
+            }
+        }
+    }
+
+private:
+    std::unordered_map<ecosim::EventTypeId, std::vector<ecosim::EventBus::TypedHandler>> subscribers_;
+    std::vector<ecosim::TypedEvent> buffer_;
+};
+
+ecosim::TypedEvent makeEvent(ecosim::EventTypeId type, int tick, int i) {
+    ecosim::TypedEvent event;
+    event.type = type;
+    event.tick = tick;
+    event.fields.reserve(3);
+    event.add(0, ecosim::EventValue::ofInt(tick));
+    event.add(1, ecosim::EventValue::ofInt(i));
+    event.add(2, ecosim::EventValue::ofReal(i * 0.5));
+    return event;
+}
+
+template <typename Bus>
+double deliveryRate(Bus &bus, ecosim::EventTypeId type, int events_per_tick) {
+    std::int64_t sum = 0;
+    bus.subscribe(type, [&sum](const ecosim::TypedEvent &event) { sum += event.fields[1].value.int_value; });
+    double seconds = 0.0;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        for (int i = 0; i < events_per_tick; ++i) {
+            bus.emit(makeEvent(type, tick, i));
+        }
+        Stopwatch watch;
+        bus.deliverBuffered();
+        seconds += watch.seconds();
+    }
+    doNotOptimize(sum);
+    return static_cast<double>(events_per_tick) * kTicks / seconds;
+}
+
+double batchDeliveryRate(int events_per_tick) {
+    ecosim::EventBus bus;
+    auto type = bus.typeId("bench.event");
+    std::int64_t sum = 0;
+    bus.subscribeBatch(type, [&sum](ecosim::EventSpan events) {
+        for (const auto &event : events) {
+            sum += event.fields[1].value.int_value;
+        }
+    });
+    double seconds = 0.0;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        for (int i = 0; i < events_per_tick; ++i) {
+            bus.emit(makeEvent(type, tick, i));
+        }
+        Stopwatch watch;
+        bus.deliverBuffered();
+        seconds += watch.seconds();
+    }
+    doNotOptimize(sum);
+    return static_cast<double>(events_per_tick) * kTicks / seconds;
+}
+
+// String subscriber that needs every 10th event: filtering in the handler vs. a stride on the bus.
+double sampledDeliveryRate(int events_per_tick, bool filter_on_bus) {
+    ecosim::EventBus bus;
+    auto type = bus.typeId("bench.event");
+    for (const char *field : {"tick", "index", "half"}) {
+        bus.fieldId(field);
+    }
+    std::size_t seen = 0;
+    std::size_t kept = 0;
+    ecosim::SubscribeOptions options;
+    if (filter_on_bus) {
+        options.stride = 10;
+    }
+    bus.subscribe("bench.event", [&seen, &kept, filter_on_bus](const ecosim::SimulationEvent &event) {
+        if (filter_on_bus || seen++ % 10 == 0) {
+            kept += event.payload.size();
+        }
+    }, options);
+    double seconds = 0.0;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        for (int i = 0; i < events_per_tick; ++i) {
+            bus.emit(makeEvent(type, tick, i));
+        }
+        Stopwatch watch;
+        bus.deliverBuffered();
+        seconds += watch.seconds();
+    }
+    doNotOptimize(kept);
+    return static_cast<double>(events_per_tick) * kTicks / seconds;
+}
+} // namespace
+
+class EventDeliveryBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "event_bus.deliver_buffered"; }
+
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        for (int events : {10000, 100000, 1000000}) {
+            CopyingBus before;
+            results.push_back({"copying " + std::to_string(events) + "/tick", deliveryRate(before, 0, events),
+                               "events/s"});
+            ecosim::EventBus after;
+            auto type = after.typeId("bench.event");
+            results.push_back({"double-buffered " + std::to_string(events) + "/tick",
+                               deliveryRate(after, type, events), "events/s"});
+            results.push_back({"batch span " + std::to_string(events) + "/tick", batchDeliveryRate(events),
+                               "events/s"});
+            results.push_back({"every 10th, handler filter " + std::to_string(events) + "/tick",
+                               sampledDeliveryRate(events, false), "events/s"});
+            results.push_back({"every 10th, bus stride " + std::to_string(events) + "/tick",
+                               sampledDeliveryRate(events, true), "events/s"});
+        }
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeEventDeliveryBenchmark() {
+    return std::make_unique<EventDeliveryBenchmark>();
+}
+
+} // namespace ecosim_bench
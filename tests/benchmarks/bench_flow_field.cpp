@@ -0,0 +1,176 @@
+#include "benchmarks/bench_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/flow_field.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace ecosim_bench {
+
+namespace {
+constexpr std::size_t kCells = 256;
+constexpr std::size_t kAgents = 4096;
+
+// What each agent would do without the field: a breadth-first search over the 8-connected grid
+// from its cell to the nearest source, returning the first step. Visited marks and the queue are
+// reused between agents, so only the search itself is measured.
+class NearestSourceSearch {
+public:
+    explicit NearestSourceSearch(const std::vector<std::uint8_t> &sources)
+        : sources_(sources), visited_(sources.size(), 0), first_step_(sources.size(), 0) {
+        queue_.reserve(sources.size());
+    }
+
+    std::uint8_t firstStep(std::size_t start) {
+        static constexpr int kDx[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+        static constexpr int kDy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+        if (++stamp_ == 0) {
+            std::fill(visited_.begin(), visited_.end(), 0);
+            stamp_ = 1;
+        }
+        queue_.clear();
+        queue_.push_back(static_cast<std::uint32_t>(start));
+        visited_[start] = stamp_;
+        for (std::size_t head = 0; head < queue_.size(); ++head) {
+            const std::size_t cell = queue_[head];
+            if (sources_[cell]) {
+                return first_step_[cell];
+            }
+            const int x = static_cast<int>(cell % kCells);
+            const int y = static_cast<int>(cell / kCells);
+            for (std::uint8_t k = 0; k < 8; ++k) {
+                const int nx = x + kDx[k];
+                const int ny = y + kDy[k];
+                if (nx < 0 || ny < 0 || nx >= static_cast<int>(kCells) || ny >= static_cast<int>(kCells)) {
+                    continue;
+                }
+                const auto next = static_cast<std::size_t>(ny) * kCells + static_cast<std::size_t>(nx);
+                if (visited_[next] != stamp_) {
+                    visited_[next] = stamp_;
+                    first_step_[next] = cell == start ? k : first_step_[cell];
+                    queue_.push_back(static_cast<std::uint32_t>(next));
+                }
+            }
+        }
+        return 8;
+    }
+
+private:
+    const std::vector<std::uint8_t> &sources_;
+    std::vector<std::uint32_t> visited_;
+    std::vector<std::uint8_t> first_step_;
+    std::vector<std::uint32_t> queue_;
+    std::uint32_t stamp_ = 0;
+};
+
+std::vector<std::uint8_t> lattice(std::size_t spacing) {
+    std::vector<std::uint8_t> sources(kCells * kCells, 0);
+    for (std::size_t y = spacing / 2; y < kCells; y += spacing) {
+        for (std::size_t x = spacing / 2; x < kCells; x += spacing) {
+            sources[y * kCells + x] = 1;
+        }
+    }
+    return sources;
+}
+
+template <typename Step>
+double nsPerAgent(const std::vector<float> &positions, Step step) {
+    Stopwatch watch;
+    std::size_t passes = 0;
+    do {
+        for (std::size_t i = 0; i < kAgents; ++i) {
+            step(positions[2 * i], positions[2 * i + 1]);
+        }
+        ++passes;
+    } while (watch.seconds() < 0.2);
+    return watch.seconds() * 1e9 / static_cast<double>(passes * kAgents);
+}
+
+template <typename Update>
+double millisecondsPer(Update update) {
+    Stopwatch watch;
+    std::size_t passes = 0;
+    do {
+        update();
+        ++passes;
+    } while (watch.seconds() < 0.2);
+    return watch.seconds() * 1e3 / static_cast<double>(passes);
+}
+} // namespace
+
+class FlowFieldBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "behavior.flow"; }
+
+    // Sources on a square lattice; the wider the spacing, the longer the path from a random agent to
+    // the nearest source. The search cost grows with the path, sampling the field does not.
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        std::mt19937 random(25);
+        std::uniform_real_distribution<float> coordinate(0.0f, static_cast<float>(kCells));
+        std::vector<float> positions(2 * kAgents);
+        for (auto &position : positions) {
+            position = coordinate(random);
+        }
+
+        for (std::size_t spacing : {4u, 8u, 16u, 24u}) {
+            const std::string label = "spacing " + std::to_string(spacing);
+            const auto sources = lattice(spacing);
+            ecosim::FlowField field;
+            field.resize(kCells, static_cast<float>(kCells));
+            field.assignSources(sources);
+            field.update();
+            NearestSourceSearch search(sources);
+            float sum = 0.0f;
+            const double search_ns = nsPerAgent(positions, [&](float x, float y) {
+                sum += static_cast<float>(search.firstStep(field.cellAt(x, y)));
+            });
+            const double flow_ns = nsPerAgent(positions, [&](float x, float y) { sum += field.sample(x, y).dx; });
+            doNotOptimize(sum);
+            results.push_back({label + " per-agent search", search_ns, "ns/agent"});
+            results.push_back({label + " flow field sample", flow_ns, "ns/agent"});
+            results.push_back({label + " search / flow", search_ns / flow_ns, "x"});
+        }
+
+        // Keeping the field current: a handful of changed sources per tick against a full rebuild.
+        auto sources = lattice(8);
+        ecosim::FlowField field;
+        field.resize(kCells, static_cast<float>(kCells));
+        field.assignSources(sources);
+        field.update();
+        std::uniform_int_distribution<std::size_t> cell(0, kCells * kCells - 1);
+        std::size_t recomputed = 0;
+        std::size_t updates = 0;
+        const double incremental_ms = millisecondsPer([&] {
+            for (int change = 0; change < 4; ++change) {
+                auto &source = sources[cell(random)];
+                source = source ? 0 : 1;
+            }
+            field.assignSources(sources);
+            recomputed += field.update();
+            ++updates;
+        });
+        const double full_ms = millisecondsPer([&] { field.rebuild(); });
+        ecosim::ThreadPool pool;
+        const std::size_t threads = ecosim::ThreadPool::defaultConcurrency();
+        pool.start(threads);
+        field.setWorkers(&pool);
+        const double pooled_ms = millisecondsPer([&] { field.rebuild(); });
+        results.push_back({"update 4 changed sources", incremental_ms, "ms"});
+        results.push_back({"update tiles recomputed", static_cast<double>(recomputed) / static_cast<double>(updates),
+                           "tiles"});
+        results.push_back({"rebuild " + std::to_string(field.tileCount()) + " tiles", full_ms, "ms"});
+        results.push_back({"rebuild " + std::to_string(threads) + " threads", pooled_ms, "ms"});
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeFlowFieldBenchmark() {
+    return std::make_unique<FlowFieldBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ecosim_bench {
+
+struct BenchResult {
+    std::string case_name;
+    double value = 0.0;
+    std::string unit;
+};
+
+class IBenchmark {
+public:
+    virtual ~IBenchmark() = default;
+    virtual std::string name() const = 0;
+    virtual std::vector<BenchResult> run() = 0;
+};
+
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+        return elapsed.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Number of global operator new calls so far (counted by bench_alloc_counter.cpp).
+std::size_t allocationCount();
+
+template <typename T>
+void doNotOptimize(const T &value) {
+    static volatile const void *sink;
+    sink = &value;
+    (void)sink;
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,45 @@
+#include "benchmarks/bench_framework.h"
+
+#include "modules/agent_kernels.h"
+
+#include <memory>
+
+namespace ecosim_bench {
+
+class MetabolismKernelBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "world.metabolism_kernel"; }
+
+    std::vector<BenchResult> run() override {
+        constexpr int kPasses = 10;
+        std::vector<BenchResult> results;
+        for (std::size_t count : {1000000u, 10000000u}) {
+            for (auto path : {ecosim::KernelPath::Scalar, ecosim::KernelPath::Avx2, ecosim::KernelPath::Avx512}) {
+                auto kernel = ecosim::metabolismKernel(path);
+                if (!kernel) {
+                    continue;
+                }
+                std::vector<float> energy(count, 1.0e6f);
+                std::vector<std::uint32_t> age(count, 0);
+                std::vector<std::uint8_t> alive(count, 1);
+                ecosim::MetabolismParams params{0.5f, 0};
+                double total = 0.0;
+                Stopwatch watch;
+                for (int pass = 0; pass < kPasses; ++pass) {
+                    total += kernel(energy.data(), age.data(), alive.data(), count, params).energy_total;
+                }
+                double seconds = watch.seconds();
+                doNotOptimize(total);
+                results.push_back({std::string(ecosim::kernelPathName(path)) + " " + std::to_string(count) + " agents",
+                                   count * kPasses / seconds, "agents/s"});
+            }
+        }
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeMetabolismKernelBenchmark() {
+    return std::make_unique<MetabolismKernelBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,95 @@
+#include "benchmarks/bench_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/population_ode.h"
+
+#include <memory>
+#include <random>
+
+namespace ecosim_bench {
+
+namespace {
+// Self-limited species with weak random interactions, so every size stays bounded and RK45 takes
+// comparable steps.
+std::vector<double> community(ecosim::PopulationOde &ode, std::size_t species) {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<double> coefficient(-1.0, 1.0);
+    ode.resize(species);
+    std::vector<double> densities(species);
+    for (std::size_t i = 0; i < species; ++i) {
+        ode.setGrowth(i, 0.5 + 0.5 * coefficient(random));
+        for (std::size_t j = 0; j < species; ++j) {
+            ode.setInteraction(i, j, i == j ? -1.0 : 0.5 * coefficient(random) / static_cast<double>(species));
+        }
+        densities[i] = 0.5 + 0.25 * coefficient(random);
+    }
+    return densities;
+}
+
+// Repeats `step` until about 0.2 s have passed; returns calls per second.
+template <typename Step>
+double callsPerSecond(Step step) {
+    Stopwatch watch;
+    std::size_t calls = 0;
+    do {
+        step();
+        ++calls;
+    } while (watch.seconds() < 0.2);
+    return static_cast<double>(calls) / watch.seconds();
+}
+} // namespace
+
+class PopulationOdeBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "population.ode"; }
+
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        ecosim::ThreadPool pool;
+        pool.start(ecosim::ThreadPool::defaultConcurrency());
+        constexpr std::size_t kKernelRows = 1000;
+        const std::size_t stride = 1000;
+        std::vector<double> matrix(kKernelRows * stride, 0.5);
+        std::vector<double> x(stride, 0.25);
+        std::vector<double> out(kKernelRows);
+        for (auto path : {ecosim::KernelPath::Scalar, ecosim::KernelPath::Avx2, ecosim::KernelPath::Avx512}) {
+            auto kernel = ecosim::interactionKernel(path);
+            if (!kernel) {
+                continue;
+            }
+            double rate = callsPerSecond([&]() { kernel(matrix.data(), stride, kKernelRows, x.data(), out.data()); });
+            doNotOptimize(out[0]);
+            results.push_back({std::string("A*x kernel 1000 species ") + ecosim::kernelPathName(path),
+                               rate * 2.0 * static_cast<double>(kKernelRows * stride) / 1e9, "GFLOP/s"});
+        }
+
+        for (std::size_t species : {10u, 1000u, 10000u}) {
+            const std::string label = std::to_string(species) + " species";
+            ecosim::PopulationOde ode;
+            ode.setWorkers(&pool);
+            auto densities = community(ode, species);
+            double rate = callsPerSecond([&]() { ode.stepRk4(densities.data(), 0.01); });
+            doNotOptimize(densities[0]);
+            results.push_back({"rk4 step " + label, rate, "steps/s"});
+
+            densities = community(ode, species);
+            std::size_t substeps = 0;
+            std::size_t calls = 0;
+            rate = callsPerSecond([&]() {
+                ode.advanceRk45(densities.data(), 0.1, 1e-6);
+                substeps += ode.acceptedSteps();
+                ++calls;
+            });
+            doNotOptimize(densities[0]);
+            results.push_back({"rk45 dt=0.1 " + label, rate, "ticks/s"});
+            results.push_back({"rk45 substeps per tick " + label, static_cast<double>(substeps) / calls, "steps"});
+        }
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makePopulationOdeBenchmark() {
+    return std::make_unique<PopulationOdeBenchmark>();
+}
+
+} // namespace ecosim_bench
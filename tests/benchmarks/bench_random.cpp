@@ -0,0 +1,61 @@
+#include "benchmarks/bench_framework.h"
+
+#include "core/random.h"
+
+#include <memory>
+
+namespace ecosim_bench {
+
+class RandomBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "core.counter_rng"; }
+
+    std::vector<BenchResult> run() override {
+        constexpr std::size_t kCount = 1000000;
+        constexpr int kPasses = 10;
+        std::vector<BenchResult> results;
+        std::vector<float> column(kCount);
+        for (bool simd : {false, true}) {
+            ecosim::RandomStreams streams(simd);
+            if (simd && !streams.vectorized()) {
+                continue;
+            }
+            auto rng = streams.stream(ecosim::RandomStreams::streamId("bench"));
+            const std::string path = simd ? "avx2" : "scalar";
+
+            Stopwatch watch;
+            for (int pass = 0; pass < kPasses; ++pass) {
+                rng.fillUniform(0, kCount, column.data(), static_cast<std::uint32_t>(pass));
+            }
+            double seconds = watch.seconds();
+            doNotOptimize(column[kCount - 1]);
+            results.push_back({"fillUniform " + path, kCount * kPasses / seconds, "values/s"});
+
+            watch = Stopwatch();
+            for (int pass = 0; pass < kPasses; ++pass) {
+                rng.fillNormal(0, kCount, column.data(), static_cast<std::uint32_t>(pass));
+            }
+            seconds = watch.seconds();
+            doNotOptimize(column[kCount - 1]);
+            results.push_back({"fillNormal " + path, kCount * kPasses / seconds, "values/s"});
+        }
+
+        ecosim::RandomStreams streams;
+        auto rng = streams.stream(ecosim::RandomStreams::streamId("bench"));
+        float sum = 0.0f;
+        Stopwatch watch;
+        for (std::size_t i = 0; i < kCount; ++i) {
+            sum += rng.uniform(i);
+        }
+        double seconds = watch.seconds();
+        doNotOptimize(sum);
+        results.push_back({"uniform per entity", kCount / seconds, "values/s"});
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeRandomBenchmark() {
+    return std::make_unique<RandomBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,99 @@
+#include "benchmarks/bench_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/resource_field.h"
+
+#include <memory>
+#include <random>
+
+namespace ecosim_bench {
+
+namespace {
+ecosim::ResourceParams benchParams() {
+    ecosim::ResourceParams params;
+    params.growth = 0.05f;
+    params.diffusion = 0.1f;
+    params.capacity = 1.0f;
+    return params;
+}
+
+// Steps `field` until about 0.2 s have passed (at least twice); returns seconds per step.
+double secondsPerStep(ecosim::ResourceField &field) {
+    Stopwatch watch;
+    std::size_t steps = 0;
+    do {
+        field.step();
+        ++steps;
+    } while (steps < 2 || watch.seconds() < 0.2);
+    return watch.seconds() / static_cast<double>(steps);
+}
+} // namespace
+
+class ResourceFieldBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "world.resources"; }
+
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        ecosim::ThreadPool pool;
+        pool.start(ecosim::ThreadPool::defaultConcurrency());
+
+        for (auto path : {ecosim::KernelPath::Scalar, ecosim::KernelPath::Avx2, ecosim::KernelPath::Avx512}) {
+            if (!ecosim::resourceKernel(path)) {
+                continue;
+            }
+            ecosim::ResourceField field(path);
+            field.setParams(benchParams());
+            field.resize(2048, 1000.0f);
+            double seconds = secondsPerStep(field);
+            doNotOptimize(field.values()[0]);
+            results.push_back({std::string("step 2048^2 single thread ") + ecosim::kernelPathName(path),
+                               2048.0 * 2048.0 / seconds / 1e9, "Gcells/s"});
+        }
+
+        for (std::size_t side : {1024u, 4096u, 16384u}) {
+            const std::string label = std::to_string(side) + "^2";
+            ecosim::ResourceField field;
+            field.setParams(benchParams());
+            field.resize(side, 1000.0f);
+            field.setWorkers(&pool);
+            double seconds = secondsPerStep(field);
+            doNotOptimize(field.values()[0]);
+            results.push_back({"step " + label, seconds * 1e3, "ms"});
+            results.push_back({"step " + label + " throughput", static_cast<double>(side * side) / seconds / 1e9,
+                               "Gcells/s"});
+            results.push_back({"memory " + label, static_cast<double>(field.memoryBytes()) / (1024.0 * 1024.0),
+                               "MiB"});
+        }
+
+        constexpr std::size_t kAgents = 1000000;
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+        std::vector<float> x(kAgents);
+        std::vector<float> y(kAgents);
+        std::vector<float> energy(kAgents, 1.0f);
+        std::vector<std::uint8_t> alive(kAgents, 1);
+        for (std::size_t i = 0; i < kAgents; ++i) {
+            x[i] = position(random);
+            y[i] = position(random);
+        }
+        ecosim::ResourceField field;
+        field.setParams(benchParams());
+        field.resize(4096, 1000.0f);
+        Stopwatch watch;
+        std::size_t passes = 0;
+        do {
+            doNotOptimize(field.consume(x.data(), y.data(), alive.data(), energy.data(), kAgents, 0.01f));
+            ++passes;
+        } while (watch.seconds() < 0.2);
+        results.push_back({"consume 1M agents on 4096^2", static_cast<double>(kAgents * passes) / watch.seconds() / 1e6,
+                           "Magents/s"});
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeResourceFieldBenchmark() {
+    return std::make_unique<ResourceFieldBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,94 @@
+#include "benchmarks/bench_framework.h"
+
+#include "modules/spatial_grid.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace ecosim_bench {
+
+namespace {
+constexpr float kWorld = 1000.0f;
+constexpr int kQueries = 100000;
+constexpr int kRebuilds = 3;
+}
+
+class SpatialGridBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "world.spatial_grid"; }
+
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        for (std::size_t count : {100000u, 1000000u, 10000000u}) {
+            std::mt19937 random(11);
+            std::uniform_real_distribution<float> coord(0.0f, kWorld);
+            ecosim::AgentStore agents;
+            agents.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                agents.spawn(0, coord(random), coord(random), 1.0f);
+            }
+            auto label = std::to_string(count) + " agents";
+
+            ecosim::SpatialGrid grid;
+            Stopwatch rebuild_watch;
+            for (int i = 0; i < kRebuilds; ++i) {
+                grid.rebuild(agents, kWorld, 0.0f);
+            }
+            results.push_back({"rebuild " + label + ", random rows", rebuild_watch.seconds() / kRebuilds * 1000.0,
+                               "ms"});
+            // What SimulationWorld does: keep rows in cell order, so later rebuilds stream through memory.
+            agents.reorder(grid.order());
+            grid.adoptOrder();
+            Stopwatch ordered_watch;
+            for (int i = 0; i < kRebuilds; ++i) {
+                grid.rebuild(agents, kWorld, 0.0f);
+            }
+            results.push_back({"rebuild " + label + ", cell-ordered rows",
+                               ordered_watch.seconds() / kRebuilds * 1000.0, "ms"});
+
+            // Radius chosen so that a query sees about 16 agents on average.
+            float radius = std::sqrt(16.0f * kWorld * kWorld / (3.14159265f * static_cast<float>(count)));
+            std::vector<ecosim::Neighbor> found;
+            std::size_t hits = 0;
+            Stopwatch radius_watch;
+            for (int q = 0; q < kQueries; ++q) {
+                found.clear();
+                grid.queryRadius(coord(random), coord(random), radius, found);
+                hits += found.size();
+            }
+            results.push_back({"radius query " + label, kQueries / radius_watch.seconds(), "queries/s"});
+
+            Stopwatch nearest_watch;
+            for (int q = 0; q < kQueries; ++q) {
+                grid.queryNearest(coord(random), coord(random), 8, found);
+                hits += found.size();
+            }
+            results.push_back({"8-nearest query " + label, kQueries / nearest_watch.seconds(), "queries/s"});
+
+            if (count == 100000u) {
+                constexpr int kNaiveQueries = 200;
+                Stopwatch naive_watch;
+                for (int q = 0; q < kNaiveQueries; ++q) {
+                    float x = coord(random);
+                    float y = coord(random);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        float dx = agents.x()[i] - x;
+                        float dy = agents.y()[i] - y;
+                        hits += dx * dx + dy * dy <= radius * radius;
+                    }
+                }
+                results.push_back({"naive radius scan " + label, kNaiveQueries / naive_watch.seconds(),
+                                   "queries/s"});
+            }
+            doNotOptimize(hits);
+        }
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeSpatialGridBenchmark() {
+    return std::make_unique<SpatialGridBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,79 @@
+#include "benchmarks/bench_framework.h"
+
+#include "core/app.h"
+#include "modules/recorder_csv.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+namespace ecosim_bench {
+
+namespace {
+std::filesystem::path writeRunFiles(int max_ticks) {
+    auto dir = std::filesystem::temp_directory_path() / "ecosim_bench_alloc";
+    for (const char *module : {"simulation_world", "scenario", "recorder"}) {
+        std::filesystem::create_directories(dir / "modules" / module);
+        std::ofstream manifest(dir / "modules" / module / "manifest.toml", std::ios::trunc);
+        manifest << "id = \"" << module << "\"\nversion = \"0.1.0\"\n";
+        manifest << "dependencies = [" << (std::string(module) == "simulation_world" ? "" : "\"simulation_world\"")
+                 << "]\ncriticality = \"Critical\"\n";
+    }
+    {
+        std::ofstream scenario(dir / "scenario.toml", std::ios::trunc);
+        scenario << "seed = 42\nstop_at_tick = " << max_ticks << "\nrequires = [\"simulation_world\"]\n";
+        scenario << "schedule = [\n  { tick = 1, command = \"spawn\", species = \"rabbit\", count = 30 },\n"
+                 << "  { tick = 2, command = \"spawn\", species = \"fox\", count = 4 },\n"
+                 << "  { tick = 3, command = \"set_param\", name = \"growth\", value = 0.5 }\n]\n";
+    }
+    auto config = dir / "app.toml";
+    std::ofstream app(config, std::ios::trunc);
+    app << "mode = \"headless\"\nmodules_dir = \"modules\"\nscenario_path = \"scenario.toml\"\n";
+    app << "output_dir = \"output\"\nmax_ticks = " << max_ticks << "\nworker_threads = 1\n";
+    app << "instances = [\n  { type = \"simulation_world\", id = \"default\", enable = true },\n"
+        << "  { type = \"scenario\", id = \"default\", enable = true },\n"
+        << "  { type = \"recorder\", id = \"csv\", enable = true, params = { sink = \"csv\" } }\n]\n";
+    return config;
+}
+
+std::size_t allocationsForRun(int ticks) {
+    std::ostream null_stream(nullptr);
+    ecosim::Logger logger(null_stream);
+    ecosim::Application app(logger);
+    app.registry().registerFactory("recorder", [](const ecosim::ModuleInstanceConfig &instance,
+                                                  ecosim::ModuleContext &context) {
+        return std::make_unique<ecosim::RecorderCsv>(instance, context);
+    });
+    if (!app.initialize(writeRunFiles(ticks).string()) || !app.startModules()) {
+        throw std::runtime_error("failed to start allocation benchmark run");
+    }
+    auto before = allocationCount();
+    app.runHeadless();
+    auto allocations = allocationCount() - before;
+    app.shutdown();
+    return allocations;
+}
+} // namespace
+
+class TickAllocationBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "app.tick_allocations"; }
+
+    std::vector<BenchResult> run() override {
+        constexpr int kShort = 50;
+        constexpr int kLong = 5050;
+        auto short_run = allocationsForRun(kShort);
+        auto long_run = allocationsForRun(kLong);
+        double steady = static_cast<double>(long_run - short_run) / (kLong - kShort);
+        return {{"warm-up allocations (" + std::to_string(kShort) + " ticks)", static_cast<double>(short_run),
+                 "allocs"},
+                {"steady-state heap allocations per tick", steady, "allocs/tick"}};
+    }
+};
+
+std::unique_ptr<IBenchmark> makeTickAllocationBenchmark() {
+    return std::make_unique<TickAllocationBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,60 @@
+#include "benchmarks/bench_framework.h"
+
+#include "integration/test_framework.h"
+#include "modules/world_branch.h"
+
+#include <memory>
+
+namespace ecosim_bench {
+
+namespace {
+constexpr std::size_t kAgents = 1000000;
+constexpr int kTicks = 10;
+constexpr double kMiB = 1024.0 * 1024.0;
+} // namespace
+
+class WorldForkBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "world.fork"; }
+
+    std::vector<BenchResult> run() override {
+        ecosim_integration::WorldHarness harness({}, ecosim::ThreadPool::defaultConcurrency());
+        auto &world = harness.world;
+        const auto &config = harness.config;
+        world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.01"}});
+        world.enqueueCommand("spawn", {{"species", "deer"}, {"count", std::to_string(kAgents / 2)}});
+        world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", std::to_string(kAgents / 2)}});
+        harness.tick();
+
+        std::vector<BenchResult> results;
+        Stopwatch watch;
+        auto branch = std::make_unique<ecosim::WorldBranch>(world, config);
+        results.push_back({"fork 1M agents (with spatial index)", watch.seconds() * 1000.0, "ms"});
+        auto memory = branch->world().agents().memory();
+        results.push_back({"agent columns, full copy", memory.bytes / kMiB, "MiB"});
+        branch->run(kTicks);
+        memory = branch->world().agents().memory();
+        results.push_back({"branch private columns after 10 ticks", (memory.bytes - memory.shared_bytes) / kMiB,
+                           "MiB"});
+        branch.reset();
+
+        const int fork_tick = world.readModel().tick;
+        std::vector<std::vector<ecosim::ScenarioConfig::ScheduledAction>> schedules;
+        for (int i = 0; i < 4; ++i) {
+            schedules.push_back({{fork_tick + 1, "apply_shock", {{"strength", std::to_string(0.1 * i)}}}});
+        }
+        std::string error;
+        watch = Stopwatch();
+        auto branches = ecosim::runBranches(world, config, schedules, kTicks, harness.pool, error);
+        double seconds = watch.seconds();
+        doNotOptimize(branches.size());
+        results.push_back({"4 branches x 10 ticks", 4.0 * kAgents * kTicks / seconds, "agents/s"});
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeWorldForkBenchmark() {
+    return std::make_unique<WorldForkBenchmark>();
+}
+
+} // namespace ecosim_bench
@@ -0,0 +1,59 @@
+#include "benchmarks/bench_framework.h"
+
+#include "integration/test_framework.h"
+
+#include <memory>
+
+namespace ecosim_bench {
+
+namespace {
+constexpr int kTicks = 10;
+
+struct WorldFixture {
+    explicit WorldFixture(std::size_t agents) : harness({{"reserve_agents", std::to_string(agents + 64)}}) {
+        const char *species[] = {"deer", "boar", "hare", "wolf"};
+        for (const char *name : species) {
+            world.enqueueCommand("spawn", {{"species", name}, {"count", std::to_string(agents / 4)}});
+        }
+        world.onPreTick();
+    }
+
+    ecosim_integration::WorldHarness harness;
+    ecosim::SimulationWorld &world = harness.world;
+};
+} // namespace
+
+class WorldTickBenchmark : public IBenchmark {
+public:
+    std::string name() const override { return "world.on_tick"; }
+
+    std::vector<BenchResult> run() override {
+        std::vector<BenchResult> results;
+        for (std::size_t agents : {100000u, 1000000u, 10000000u}) {
+            auto fixture = std::make_unique<WorldFixture>(agents);
+            Stopwatch watch;
+            for (int tick = 0; tick < kTicks; ++tick) {
+                fixture->world.onTick();
+                fixture->harness.bus.clear();
+            }
+            double seconds = watch.seconds();
+            doNotOptimize(fixture->world.readModel().energy_total);
+            results.push_back({std::to_string(agents) + " agents", agents * kTicks / seconds, "agents/s"});
+
+            watch = Stopwatch();
+            for (int tick = 0; tick < kTicks; ++tick) {
+                doNotOptimize(fixture->world.stateDigests()[2]);
+            }
+            seconds = watch.seconds();
+            results.push_back({"state digest " + std::to_string(agents) + " agents", agents * kTicks / seconds,
+                               "agents/s"});
+        }
+        return results;
+    }
+};
+
+std::unique_ptr<IBenchmark> makeWorldTickBenchmark() {
+    return std::make_unique<WorldTickBenchmark>();
+}
+
+} // namespace ecosim_bench
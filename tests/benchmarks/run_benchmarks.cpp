@@ -0,0 +1,25 @@
+#include "benchmarks/bench_cases.h"
+
+#include <iomanip>
+#include <iostream>
+
+int main(int argc, char **argv) {
+    std::string filter = argc > 1 ? argv[1] : "";
+    try {
+        auto benchmarks = ecosim_bench::buildBenchmarks();
+        for (auto &benchmark : benchmarks) {
+            if (!filter.empty() && benchmark->name().find(filter) == std::string::npos) {
+                continue;
+            }
+            std::cout << "== " << benchmark->name() << std::endl;
+            for (const auto &result : benchmark->run()) {
+                std::cout << "  " << std::left << std::setw(48) << result.case_name << std::right << std::setw(16)
+                          << std::fixed << std::setprecision(1) << result.value << ' ' << result.unit << std::endl;
+            }
+        }
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "Benchmarks crashed: " << ex.what() << std::endl;
+        return 1;
+    }
+}
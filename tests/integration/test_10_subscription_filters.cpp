@@ -0,0 +1,73 @@
+#include "integration/test_framework.h"
+
+#include "core/event_bus.h"
+
+#include <memory>
+
+namespace ecosim_integration {
+
+class SubscriptionFiltersTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.10 subscription filters";
+        constexpr int kTicks = 20;
+
+        ecosim::EventBus bus;
+        auto type = bus.typeId("test.sample");
+        auto value_field = bus.fieldId("value");
+        auto phase_field = bus.fieldId("phase");
+
+        ecosim::SubscribeOptions where;
+        where.where.push_back({value_field, ecosim::FieldPredicate::Op::GreaterEqual, ecosim::EventValue::ofInt(15)});
+        std::vector<std::int64_t> high;
+        bus.subscribe(type, [&high, value_field](const ecosim::TypedEvent &event) {
+            high.push_back(event.find(value_field)->value.asInt());
+        }, where);
+
+        ecosim::SubscribeOptions sampled;
+        sampled.stride = 4;
+        std::vector<std::int64_t> every_fourth;
+        bus.subscribeBatch(type, [&every_fourth](ecosim::EventSpan events) {
+            for (const auto &event : events) {
+                every_fourth.push_back(event.tick);
+            }
+        }, sampled);
+
+        ecosim::SubscribeOptions changes;
+        changes.on_change.push_back(phase_field);
+        std::vector<std::string> phases;
+        bus.subscribe("test.sample", [&phases](const ecosim::SimulationEvent &event) {
+            phases.push_back(event.payload.at("phase"));
+        }, changes);
+
+        for (int tick = 1; tick <= kTicks; ++tick) {
+            ecosim::TypedEvent event;
+            event.type = type;
+            event.tick = tick;
+            event.add(value_field, ecosim::EventValue::ofInt(tick));
+            event.add(phase_field, ecosim::EventValue::ofInt(tick / 8));
+            bus.emit(std::move(event));
+            if (tick % 2 == 0) {
+                bus.deliverBuffered();
+            }
+        }
+
+        if (high != std::vector<std::int64_t>{15, 16, 17, 18, 19, 20}) {
+            return {name, false, "предикат по полю пропустил лишние события или потерял нужные"};
+        }
+        if (every_fourth != std::vector<std::int64_t>{1, 5, 9, 13, 17}) {
+            return {name, false, "выборка каждого N-го события не сохраняется между тиками"};
+        }
+        if (phases != std::vector<std::string>{"0", "1", "2"}) {
+            return {name, false, "доставка по изменению поля пропускает изменения или повторяет значения"};
+        }
+
+        return {name, true, "предикаты, выборка и доставка по изменению применяются до вызова обработчиков"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeSubscriptionFiltersTest() {
+    return std::make_unique<SubscriptionFiltersTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,95 @@
+#include "integration/test_framework.h"
+
+#include "core/event_bus.h"
+
+#include <memory>
+
+namespace ecosim_integration {
+
+class BoundedBuffersTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.11 bounded event buffers";
+
+        ecosim::EventBus bus;
+        auto item_field = bus.fieldId("item");
+        auto agent_field = bus.fieldId("agent");
+        auto newest = bus.typeId("test.drop_newest");
+        auto oldest = bus.typeId("test.drop_oldest");
+        auto latest = bus.typeId("test.coalesce");
+        auto flushed = bus.typeId("test.flush_early");
+
+        bus.setBufferPolicy(newest, {3, ecosim::BufferPolicy::Overflow::DropNewest, 0});
+        bus.setBufferPolicy(oldest, {3, ecosim::BufferPolicy::Overflow::DropOldest, 0});
+        bus.setBufferPolicy(latest, {0, ecosim::BufferPolicy::Overflow::Coalesce, agent_field});
+        bus.setBufferPolicy(flushed, {4, ecosim::BufferPolicy::Overflow::FlushEarly, 0});
+
+        std::map<ecosim::EventTypeId, std::vector<std::int64_t>> received;
+        for (auto type : {newest, oldest, latest, flushed}) {
+            bus.subscribe(type, [&received, item_field](const ecosim::TypedEvent &event) {
+                received[event.type].push_back(event.find(item_field)->value.asInt());
+            });
+        }
+
+        auto emit = [&bus, item_field, agent_field](ecosim::EventTypeId type, int item, int agent) {
+            ecosim::TypedEvent event;
+            event.type = type;
+            event.tick = 1;
+            event.add(item_field, ecosim::EventValue::ofInt(item));
+            event.add(agent_field, ecosim::EventValue::ofInt(agent));
+            bus.emit(std::move(event));
+        };
+        for (int i = 0; i < 10; ++i) {
+            emit(newest, i, 0);
+            emit(oldest, i, 0);
+        }
+        const int agents[] = {0, 1, 0, 2, 1};
+        for (int i = 0; i < 5; ++i) {
+            emit(latest, i, agents[i]);
+        }
+        for (int i = 0; i < 10; ++i) {
+            emit(flushed, i, 0);
+        }
+        emit(bus.typeId("test.unsubscribed"), 0, 0);
+        if (bus.stats(flushed).early_flushes != 1 || !bus.flushRequested() || !received[flushed].empty()) {
+            return {name, false, "flush-early должен запросить доставку при переполнении, не вызывая подписчиков из emit"};
+        }
+        bus.deliverBuffered();
+        if (bus.flushRequested()) {
+            return {name, false, "доставка должна снимать запрос flush-early"};
+        }
+
+        if (received[newest] != std::vector<std::int64_t>{0, 1, 2} || bus.stats(newest).dropped != 7) {
+            return {name, false, "drop-newest должен сохранять первые события и считать отброшенные"};
+        }
+        if (received[oldest] != std::vector<std::int64_t>{7, 8, 9} || bus.stats(oldest).dropped != 7 ||
+            bus.stats(oldest).peak_buffered > 6) {
+            return {name, false, "drop-oldest должен сохранять последние события в пределах 2x ёмкости"};
+        }
+        if (received[latest] != std::vector<std::int64_t>{2, 3, 4} || bus.stats(latest).coalesced != 2) {
+            return {name, false, "coalesce должен оставлять последнее событие на ключ"};
+        }
+        std::vector<std::int64_t> all_items;
+        for (int i = 0; i < 10; ++i) {
+            all_items.push_back(i);
+        }
+        if (received[flushed] != all_items) {
+            return {name, false, "flush-early потерял события или нарушил порядок"};
+        }
+
+        const auto &stats = bus.stats();
+        if (stats.emitted != 36 || stats.dropped != 14 || stats.coalesced != 2 ||
+            stats.delivered != stats.emitted - stats.dropped - stats.coalesced - 1 || bus.bufferedCount() != 0) {
+            return {name, false, "счётчики шины не согласованы: emitted " + std::to_string(stats.emitted) +
+                                     ", delivered " + std::to_string(stats.delivered)};
+        }
+
+        return {name, true, "политики переполнения ограничивают буфер, счётчики emitted/delivered/dropped согласованы"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeBoundedBuffersTest() {
+    return std::make_unique<BoundedBuffersTest>();
+}
+
+} // namespace ecosim_integration
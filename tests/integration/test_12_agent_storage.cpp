@@ -0,0 +1,70 @@
+#include "integration/test_framework.h"
+
+#include "modules/agent_store.h"
+
+#include <memory>
+
+namespace ecosim_integration {
+
+class AgentStorageTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.12 agent storage";
+
+        ecosim::AgentStore store;
+        std::vector<ecosim::AgentHandle> handles;
+        for (int i = 0; i < 8; ++i) {
+            handles.push_back(store.spawn(static_cast<std::uint32_t>(i % 2), static_cast<float>(i), 0.0f, 1.0f));
+        }
+        store.remove(handles[1]);
+        store.kill(store.row(handles[4]));
+        store.kill(store.row(handles[6]));
+        store.compact();
+        if (store.size() != 5 || store.count(0) != 2 || store.count(1) != 3) {
+            return {name, false, "swap-remove нарушил размер или счётчики по видам"};
+        }
+        for (int i : {1, 4, 6}) {
+            if (store.valid(handles[i])) {
+                return {name, false, "хэндл удалённого агента остался действительным"};
+            }
+        }
+        for (int i : {0, 2, 3, 5, 7}) {
+            if (!store.valid(handles[i]) || store.x()[store.row(handles[i])] != static_cast<float>(i)) {
+                return {name, false, "хэндл живого агента указывает на чужую строку после компактизации"};
+            }
+        }
+        auto reused = store.spawn(0, 42.0f, 0.0f, 1.0f);
+        if (!store.valid(reused) || store.valid(handles[1]) || store.valid(handles[4]) || store.valid(handles[6])) {
+            return {name, false, "повторно использованный слот не сменил поколение"};
+        }
+
+        WorldHarness harness;
+        auto &world = harness.world;
+        world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "10"}});
+        world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "3"}});
+        harness.tick();
+        world.enqueueCommand("apply_shock", {{"strength", "0.5"}});
+        harness.tick();
+
+        const auto &state = world.readModel();
+        // deer: 10 + 1 birth -> shock to 5 -> + 1 birth; wolf: 3 + 1 -> 2 -> 3.
+        if (state.populationOf("deer") != 6 || state.populationOf("wolf") != 3 ||
+            world.agents().size() != 9 || state.energy_total != 18) {
+            return {name, false, "spawn/apply_shock поверх агентов изменили прежнюю семантику счётчиков"};
+        }
+        for (std::size_t row = 0; row < world.agents().size(); ++row) {
+            auto x = world.agents().x()[row];
+            if (!world.agents().alive()[row] || x < 0.0f || x >= 1000.0f) {
+                return {name, false, "в колонках остались мёртвые агенты или позиция вне мира"};
+            }
+        }
+
+        return {name, true, "SoA-хранилище: стабильные хэндлы, swap-remove, счётчики ReadModel выводятся из агентов"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeAgentStorageTest() {
+    return std::make_unique<AgentStorageTest>();
+}
+
+} // namespace ecosim_integration
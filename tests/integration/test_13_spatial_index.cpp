@@ -0,0 +1,103 @@
+#include "integration/test_framework.h"
+
+#include "modules/spatial_grid.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace ecosim_integration {
+
+namespace {
+std::vector<std::uint32_t> bruteRadius(const ecosim::AgentStore &agents, float x, float y, float radius) {
+    std::vector<std::uint32_t> rows;
+    for (std::size_t i = 0; i < agents.size(); ++i) {
+        float dx = agents.x()[i] - x;
+        float dy = agents.y()[i] - y;
+        if (dx * dx + dy * dy <= radius * radius) {
+            rows.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    return rows;
+}
+
+std::vector<std::uint32_t> bruteNearest(const ecosim::AgentStore &agents, float x, float y, std::size_t k) {
+    std::vector<std::pair<float, std::uint32_t>> all;
+    for (std::size_t i = 0; i < agents.size(); ++i) {
+        float dx = agents.x()[i] - x;
+        float dy = agents.y()[i] - y;
+        all.push_back({dx * dx + dy * dy, static_cast<std::uint32_t>(i)});
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<std::uint32_t> rows;
+    for (std::size_t i = 0; i < std::min(k, all.size()); ++i) {
+        rows.push_back(all[i].second);
+    }
+    return rows;
+}
+} // namespace
+
+class SpatialIndexTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.13 spatial index queries";
+        constexpr float kWorld = 100.0f;
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> coord(0.0f, kWorld);
+        ecosim::AgentStore agents;
+        for (int i = 0; i < 3000; ++i) {
+            agents.spawn(0, coord(random), coord(random), 1.0f);
+        }
+
+        ecosim::SpatialGrid grid;
+        std::vector<ecosim::Neighbor> found;
+        for (float cell_size : {0.0f, 3.0f, 40.0f}) {
+            grid.rebuild(agents, kWorld, cell_size);
+            for (int q = 0; q < 50; ++q) {
+                float x = coord(random);
+                float y = coord(random);
+                found.clear();
+                grid.queryRadius(x, y, 6.5f, found);
+                std::vector<std::uint32_t> rows;
+                for (const auto &neighbor : found) {
+                    rows.push_back(neighbor.row);
+                    if (!agents.valid(neighbor.agent) || agents.row(neighbor.agent) != neighbor.row) {
+                        return {name, false, "хэндл соседа не соответствует строке агента"};
+                    }
+                }
+                std::sort(rows.begin(), rows.end());
+                if (rows != bruteRadius(agents, x, y, 6.5f)) {
+                    return {name, false, "запрос по радиусу расходится с полным перебором"};
+                }
+                grid.queryNearest(x, y, 7, found);
+                rows.clear();
+                for (const auto &neighbor : found) {
+                    rows.push_back(neighbor.row);
+                }
+                if (rows != bruteNearest(agents, x, y, 7)) {
+                    return {name, false, "k ближайших расходятся с полным перебором (cell_size " +
+                                             std::to_string(cell_size) + ")"};
+                }
+            }
+        }
+
+        WorldHarness harness;
+        auto &world = harness.world;
+        world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "200"}});
+        harness.tick();
+        ecosim::IWorldPort &port = world;
+        port.queryNearest(500.0f, 500.0f, 201, found);
+        if (found.size() != world.agents().size()) {
+            return {name, false, "IWorldPort::queryNearest не видит всех агентов мира"};
+        }
+
+        return {name, true, "запросы по радиусу и k ближайших совпадают с полным перебором"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeSpatialIndexTest() {
+    return std::make_unique<SpatialIndexTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,81 @@
+#include "integration/test_framework.h"
+
+#include "modules/agent_kernels.h"
+
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace ecosim_integration {
+
+namespace {
+struct Columns {
+    std::vector<float> energy;
+    std::vector<std::uint32_t> age;
+    std::vector<std::uint8_t> alive;
+};
+
+std::string runWorld(const std::string &simd) {
+    WorldHarness harness({{"simd", simd}});
+    auto &world = harness.world;
+    world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "1000"}});
+    world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.37"}});
+    world.enqueueCommand("set_param", {{"name", "max_age"}, {"value", "4"}});
+    for (int tick = 0; tick < 6; ++tick) {
+        harness.tick();
+    }
+    return world.checksum() + "/" + std::to_string(world.agents().size());
+}
+} // namespace
+
+class SimdKernelsTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.14 SIMD kernels are bit-identical";
+        constexpr std::size_t kCount = 100003;
+
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> energy(-0.5f, 3.0f);
+        std::uniform_int_distribution<std::uint32_t> age(0, 12);
+        Columns input;
+        for (std::size_t i = 0; i < kCount; ++i) {
+            input.energy.push_back(energy(random));
+            input.age.push_back(age(random));
+            input.alive.push_back(i % 7 == 0 ? 0 : 1);
+        }
+        const ecosim::MetabolismParams params{0.25f, 10};
+
+        Columns reference = input;
+        auto expected = ecosim::metabolismKernel(ecosim::KernelPath::Scalar)(
+            reference.energy.data(), reference.age.data(), reference.alive.data(), kCount, params);
+        std::string checked = "scalar";
+        for (auto path : {ecosim::KernelPath::Avx2, ecosim::KernelPath::Avx512}) {
+            auto kernel = ecosim::metabolismKernel(path);
+            if (!kernel) {
+                continue;
+            }
+            Columns columns = input;
+            auto result = kernel(columns.energy.data(), columns.age.data(), columns.alive.data(), kCount, params);
+            if (std::memcmp(&result.energy_total, &expected.energy_total, sizeof(double)) != 0 ||
+                result.deaths != expected.deaths ||
+                std::memcmp(columns.energy.data(), reference.energy.data(), kCount * sizeof(float)) != 0 ||
+                columns.age != reference.age || columns.alive != reference.alive) {
+                return {name, false, std::string("путь ") + ecosim::kernelPathName(path) +
+                                         " расходится со скалярным побитово"};
+            }
+            checked += std::string(", ") + ecosim::kernelPathName(path);
+        }
+
+        if (runWorld("scalar") != runWorld("auto")) {
+            return {name, false, "мир с векторным ядром расходится со скалярным"};
+        }
+
+        return {name, true, "побитово совпадают пути: " + checked};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeSimdKernelsTest() {
+    return std::make_unique<SimdKernelsTest>();
+}
+
+} // namespace ecosim_integration
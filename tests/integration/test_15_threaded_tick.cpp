@@ -0,0 +1,62 @@
+#include "integration/test_framework.h"
+
+#include <cstring>
+#include <memory>
+
+namespace ecosim_integration {
+
+namespace {
+std::uint64_t hashColumns(const ecosim::AgentStore &agents) {
+    std::uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void *data, std::size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    };
+    for (std::size_t chunk = 0; chunk < agents.chunkCount(); ++chunk) {
+        const std::size_t rows = agents.chunkRows(chunk);
+        mix(agents.energy().chunk(chunk), rows * sizeof(float));
+        mix(agents.age().chunk(chunk), rows * sizeof(std::uint32_t));
+        mix(agents.x().chunk(chunk), rows * sizeof(float));
+        mix(agents.species().chunk(chunk), rows * sizeof(ecosim::SpeciesId));
+    }
+    return hash;
+}
+
+std::string runWorld(std::size_t threads) {
+    WorldHarness harness({}, threads);
+    auto &world = harness.world;
+    world.enqueueCommand("world.reset", {{"seed", "9"}});
+    world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.3"}});
+    world.onPreTick();
+    for (int tick = 0; tick < 12; ++tick) {
+        world.enqueueCommand("spawn", {{"species", tick % 2 ? "deer" : "wolf"}, {"count", "20000"}});
+        harness.tick();
+    }
+    return world.checksum() + "/" + std::to_string(world.agents().size()) + "/" +
+           std::to_string(hashColumns(world.agents()));
+}
+} // namespace
+
+class ThreadedTickTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.15 threaded world tick determinism";
+        auto expected = runWorld(1);
+        for (std::size_t threads : {2u, 8u, 64u}) {
+            auto actual = runWorld(threads);
+            if (actual != expected) {
+                return {name, false, "состояние мира на " + std::to_string(threads) +
+                                         " потоках отличается от однопоточного: " + actual + " vs " + expected};
+            }
+        }
+        return {name, true, "checksum и колонки агентов совпадают для 1, 2, 8 и 64 потоков"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeThreadedTickTest() {
+    return std::make_unique<ThreadedTickTest>();
+}
+
+} // namespace ecosim_integration
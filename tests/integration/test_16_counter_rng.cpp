@@ -0,0 +1,113 @@
+#include "integration/test_framework.h"
+
+#include "core/random.h"
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace ecosim_integration {
+
+class CounterRngTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.16 counter-based rng streams";
+        // Known-answer vectors of Philox4x32-10 from the Random123 distribution.
+        struct Vector {
+            ecosim::CounterRng::Block counter;
+            std::array<std::uint32_t, 2> key;
+            ecosim::CounterRng::Block expected;
+        };
+        const Vector vectors[] = {
+            {{0, 0, 0, 0}, {0, 0}, {0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}},
+            {{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+             {0xffffffffu, 0xffffffffu},
+             {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}},
+            {{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+             {0xa4093822u, 0x299f31d0u},
+             {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}},
+        };
+        for (const auto &vector : vectors) {
+            if (ecosim::CounterRng::philox(vector.counter, vector.key) != vector.expected) {
+                return {name, false, "Philox4x32-10 не совпадает с эталонным вектором"};
+            }
+        }
+
+        ecosim::RandomStreams streams;
+        ecosim::RandomStreams scalar(false);
+        streams.setSeed(42);
+        scalar.setSeed(42);
+        streams.setTick(7);
+        auto rng = streams.stream(ecosim::RandomStreams::streamId("test.agents"));
+        auto reference = scalar.stream(ecosim::RandomStreams::streamId("test.agents"), 7);
+
+        // Start near a 2^32 boundary so that batches straddle the high entity word.
+        constexpr std::size_t kCount = 100003;
+        const std::uint64_t first = 0xfffffff0ULL - 50000;
+        std::vector<float> uniforms(kCount);
+        std::vector<float> normals(kCount);
+        std::vector<float> expected_uniforms(kCount);
+        std::vector<float> expected_normals(kCount);
+        rng.fillUniform(first, kCount, uniforms.data(), 5);
+        rng.fillNormal(first, kCount, normals.data(), 1);
+        reference.fillUniform(first, kCount, expected_uniforms.data(), 5);
+        for (std::size_t i = 0; i < kCount; ++i) {
+            expected_normals[i] = reference.normal(first + i, 1);
+            if (reference.uniform(first + i, 5) != expected_uniforms[i]) {
+                return {name, false, "пакетная генерация расходится с поштучной"};
+            }
+        }
+        if (std::memcmp(uniforms.data(), expected_uniforms.data(), kCount * sizeof(float)) != 0 ||
+            std::memcmp(normals.data(), expected_normals.data(), kCount * sizeof(float)) != 0) {
+            return {name, false, "векторный путь не совпадает со скалярным"};
+        }
+
+        // Chunks filled in parallel, in any order, reproduce the serial column.
+        ecosim::ThreadPool pool;
+        pool.start(4);
+        std::vector<float> parallel(kCount);
+        constexpr std::size_t kChunk = 1000;
+        pool.parallelFor((kCount + kChunk - 1) / kChunk, [&](std::size_t chunk) {
+            std::size_t begin = chunk * kChunk;
+            rng.fillNormal(first + begin, std::min(kChunk, kCount - begin), parallel.data() + begin, 1);
+        });
+        if (std::memcmp(parallel.data(), normals.data(), kCount * sizeof(float)) != 0) {
+            return {name, false, "параллельное заполнение зависит от разбиения"};
+        }
+
+        double mean = 0.0;
+        double normal_mean = 0.0;
+        double normal_var = 0.0;
+        for (std::size_t i = 0; i < kCount; ++i) {
+            if (uniforms[i] < 0.0f || uniforms[i] >= 1.0f) {
+                return {name, false, "равномерное значение вне [0, 1)"};
+            }
+            mean += uniforms[i];
+            normal_mean += normals[i];
+            normal_var += static_cast<double>(normals[i]) * normals[i];
+        }
+        mean /= kCount;
+        normal_mean /= kCount;
+        normal_var = normal_var / kCount - normal_mean * normal_mean;
+        if (std::abs(mean - 0.5) > 0.01 || std::abs(normal_mean) > 0.02 || std::abs(normal_var - 1.0) > 0.03) {
+            return {name, false, "моменты распределений вне допуска"};
+        }
+
+        auto other_tick = streams.stream(ecosim::RandomStreams::streamId("test.agents"), 8);
+        auto other_stream = streams.stream(ecosim::RandomStreams::streamId("test.other"));
+        if (other_tick.bits(first) == rng.bits(first) || other_stream.bits(first) == rng.bits(first)) {
+            return {name, false, "разные такты или потоки дали одинаковые числа"};
+        }
+        return {name, true,
+                std::string("Philox совпадает с эталоном, пакетный путь (") +
+                    (streams.vectorized() ? "avx2" : "scalar") + ") и параллельное заполнение воспроизводимы"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeCounterRngTest() {
+    return std::make_unique<CounterRngTest>();
+}
+
+} // namespace ecosim_integration
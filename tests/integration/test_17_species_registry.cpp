@@ -0,0 +1,58 @@
+#include "integration/test_framework.h"
+
+#include <memory>
+
+namespace ecosim_integration {
+
+class SpeciesRegistryTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.17 species registry";
+        ecosim::SpeciesRegistry registry;
+        if (registry.intern("wolf") != 0 || registry.intern("deer") != 1 || registry.intern("wolf") != 0 ||
+            registry.find("hare") != ecosim::SpeciesRegistry::kInvalid || registry.name(1) != "deer") {
+            return {name, false, "идентификаторы видов не плотные или не стабильные"};
+        }
+        for (std::size_t i = registry.size(); i < ecosim::SpeciesRegistry::kInvalid; ++i) {
+            registry.intern("species_" + std::to_string(i));
+        }
+        if (registry.intern("one_too_many") != ecosim::SpeciesRegistry::kInvalid ||
+            registry.size() != ecosim::SpeciesRegistry::kInvalid) {
+            return {name, false, "переполнение uint16 не обнаружено"};
+        }
+
+        WorldHarness harness;
+        auto &world = harness.world;
+        auto &bus = harness.bus;
+        std::vector<ecosim::TypedEvent> events;
+        bus.subscribe(bus.typeId("world.tick"), [&events](const ecosim::TypedEvent &event) { events.push_back(event); });
+        world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "2"}});
+        world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "5"}});
+        world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "1"}});
+        world.onPreTick();
+        world.onTick();
+        bus.deliverBuffered();
+
+        const auto &state = world.readModel();
+        if (state.species.names() != std::vector<std::string>{"wolf", "deer"} || state.population.size() != 2 ||
+            state.population[0] != 4 || state.population[1] != 6 || state.populationOf("deer") != 6 ||
+            world.agents().count(0) != 4 || world.agents().count(1) != 6) {
+            return {name, false, "плотный массив популяций не совпадает с ожидаемым"};
+        }
+        if (events.size() != 1) {
+            return {name, false, "ожидалось одно событие world.tick"};
+        }
+        auto wolves = events[0].find(bus.fieldId("population.wolf"));
+        auto deer = events[0].find(bus.fieldId("population.deer"));
+        if (!wolves || !deer || wolves->value.asInt() != 4 || deer->value.asInt() != 6) {
+            return {name, false, "поля population.<вид> события не совпадают с массивом"};
+        }
+        return {name, true, "виды интернированы в uint16, популяции и события индексируются по id"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeSpeciesRegistryTest() {
+    return std::make_unique<SpeciesRegistryTest>();
+}
+
+} // namespace ecosim_integration
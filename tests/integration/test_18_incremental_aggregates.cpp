@@ -0,0 +1,80 @@
+#include "integration/test_framework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace ecosim_integration {
+
+namespace {
+struct Outcome {
+    std::string error;
+    std::string summary;
+};
+
+Outcome runWorld(const std::string &simd) {
+    WorldHarness harness({{"simd", simd}, {"verify_aggregates", "true"}});
+    auto &world = harness.world;
+    world.enqueueCommand("world.reset", {{"seed", "5"}});
+    world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.25"}});
+    world.enqueueCommand("set_param", {{"name", "max_age"}, {"value", "9"}});
+    std::string summary;
+    for (int tick = 0; tick < 14; ++tick) {
+        if (tick % 3 == 0) {
+            world.enqueueCommand("spawn", {{"species", tick % 2 ? "deer" : "wolf"}, {"count", "300"}});
+        }
+        if (tick == 7) {
+            world.enqueueCommand("apply_shock", {{"strength", "0.4"}});
+        }
+        harness.tick();
+
+        const auto &state = world.readModel();
+        const auto &agents = world.agents();
+        const auto &energy = agents.energy();
+        double sum = 0.0;
+        float low = agents.empty() ? 0.0f : energy[0];
+        float high = low;
+        for (std::size_t row = 0; row < agents.size(); ++row) {
+            sum += energy[row];
+            low = std::min(low, energy[row]);
+            high = std::max(high, energy[row]);
+        }
+        if (state.agent_count != agents.size() || state.energy_min != low || state.energy_max != high ||
+            std::abs(state.energyMean() * static_cast<double>(agents.size()) - sum) > 1e-6) {
+            return {"агрегаты ReadModel расходятся с колонками на тике " + std::to_string(state.tick), {}};
+        }
+        summary += world.checksum() + ":" + std::to_string(state.energy_min) + ":" + std::to_string(state.energy_max) + ";";
+    }
+    if (world.aggregateMismatches() != 0) {
+        return {"режим проверки нашёл расхождения: " + std::to_string(world.aggregateMismatches()), {}};
+    }
+    return {{}, summary};
+}
+} // namespace
+
+class IncrementalAggregatesTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.18 incremental aggregates";
+        auto expected = runWorld("scalar");
+        if (!expected.error.empty()) {
+            return {name, false, expected.error};
+        }
+        for (const char *simd : {"avx2", "avx512"}) {
+            auto actual = runWorld(simd);
+            if (!actual.error.empty()) {
+                return {name, false, actual.error};
+            }
+            if (actual.summary != expected.summary) {
+                return {name, false, std::string("агрегаты пути ") + simd + " отличаются от скалярного"};
+            }
+        }
+        return {name, true, "инкрементальные totals, min/max/mean и хэш совпадают с полным пересчётом"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeIncrementalAggregatesTest() {
+    return std::make_unique<IncrementalAggregatesTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,82 @@
+#include "integration/test_framework.h"
+
+#include <memory>
+#include <type_traits>
+
+namespace ecosim_integration {
+
+class TypedCommandsTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.19 typed world commands";
+        static_assert(std::is_trivially_copyable<ecosim::WorldCommand>::value && sizeof(ecosim::WorldCommand) == 24,
+                      "commands are copied and snapshotted as raw values without padding");
+
+        WorldHarness typed;
+        const std::vector<std::pair<std::string, std::map<std::string, std::string>>> invalid = {
+            {"spawn", {{"species", "deer"}, {"count", "ten"}}},
+            {"spawn", {{"count", "3"}}},
+            {"spawn", {{"species", "deer"}, {"count", "-1"}}},
+            {"set_param", {{"name", "metabolism"}, {"value", "fast"}}},
+            {"apply_shock", {{"strength", "1.5"}}},
+            {"stop.at_tick", {{"value", "2.5"}}},
+            {"world.explode", {}},
+        };
+        for (const auto &command : invalid) {
+            ecosim::WorldCommand parsed;
+            std::string error;
+            if (typed.world.parseCommand(command.first, command.second, parsed, error) || error.empty()) {
+                return {name, false, "некорректная команда " + command.first + " прошла проверку"};
+            }
+        }
+
+        std::vector<ecosim::WorldCommand> batch(4);
+        std::string error;
+        bool parsed = typed.world.parseCommand("world.reset", {{"seed", "11"}}, batch[0], error) &&
+                      typed.world.parseCommand("spawn", {{"species", "deer"}, {"count", "40"}}, batch[1], error) &&
+                      typed.world.parseCommand("spawn", {{"species", "wolf"}, {"count", "7"}}, batch[2], error) &&
+                      typed.world.parseCommand("set_param", {{"name", "growth"}, {"value", "0.5"}}, batch[3], error);
+        if (!parsed || batch[1].type != ecosim::WorldCommandType::Spawn || batch[1].amount != 40 ||
+            batch[2].species != typed.world.readModel().species.find("wolf")) {
+            return {name, false, "разбор корректных команд не удался: " + error};
+        }
+        typed.world.enqueueCommands(batch.data(), batch.size());
+        typed.tick();
+        auto shock = ecosim::WorldCommand::applyShock(0.5);
+        typed.world.enqueueCommands(&shock, 1);
+        typed.tick();
+
+        WorldHarness legacy;
+        legacy.world.enqueueCommand("world.reset", {{"seed", "11"}});
+        legacy.world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "40"}});
+        legacy.world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "7"}});
+        legacy.world.enqueueCommand("set_param", {{"name", "growth"}, {"value", "0.5"}});
+        legacy.tick();
+        legacy.world.enqueueCommand("apply_shock", {{"strength", "0.5"}});
+        legacy.tick();
+
+        if (typed.world.checksum() != legacy.world.checksum() ||
+            typed.world.readModel().populationOf("deer") != legacy.world.readModel().populationOf("deer") ||
+            typed.world.param("growth") != 0.5) {
+            return {name, false, "пакетная и строковая очереди дали разные состояния"};
+        }
+
+        // Ids parsed before a reset stay valid after it.
+        auto wolf = typed.world.readModel().species.find("wolf");
+        auto reset = ecosim::WorldCommand::reset(3);
+        auto spawn = ecosim::WorldCommand::spawn(wolf, 5);
+        typed.world.enqueueCommands(&reset, 1);
+        typed.world.enqueueCommands(&spawn, 1);
+        typed.world.onPreTick();
+        if (typed.world.readModel().populationOf("wolf") != 5 || typed.world.readModel().populationOf("deer") != 0) {
+            return {name, false, "идентификаторы видов не пережили world.reset"};
+        }
+        return {name, true, "команды проверяются один раз, применяются через switch, пакет равен строковому пути"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeTypedCommandsTest() {
+    return std::make_unique<TypedCommandsTest>();
+}
+
+} // namespace ecosim_integration
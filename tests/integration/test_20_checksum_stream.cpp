@@ -0,0 +1,96 @@
+#include "integration/test_framework.h"
+
+#include "core/checksum_stream.h"
+#include "core/state_hash.h"
+
+#include <cstring>
+#include <memory>
+
+namespace ecosim_integration {
+
+namespace {
+std::string runWorld(const std::filesystem::path &dir, const std::string &file, std::size_t threads, int extra_spawn_tick) {
+    ecosim::AppConfig config;
+    config.output_dir = dir.string();
+    WorldHarness harness({{"checksum_stream", file}}, threads, config);
+    auto &world = harness.world;
+    world.enqueueCommand("world.reset", {{"seed", "21"}});
+    world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.2"}});
+    world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "40000"}});
+    world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "500"}});
+    for (int tick = 1; tick <= 10; ++tick) {
+        if (tick == extra_spawn_tick) {
+            world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "1"}});
+        }
+        harness.tick();
+    }
+    world.onStop();
+    return world.checksum();
+}
+} // namespace
+
+class ChecksumStreamTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.20 checksum stream divergence";
+        const std::pair<const char *, std::uint64_t> vectors[] = {
+            {"", 0xef46db3751d8e999ULL},
+            {"a", 0xd24ec4f1a98c6e5bULL},
+            {"abc", 0x44bc2cf5ad770999ULL},
+            {"Nobody inspects the spammish repetition", 0xfbcea83c8a378bf1ULL},
+        };
+        for (const auto &vector : vectors) {
+            ecosim::Hash64 streaming;
+            for (const char *c = vector.first; *c; ++c) {
+                streaming.update(c, 1);
+            }
+            if (ecosim::hash64(vector.first, std::strlen(vector.first)) != vector.second ||
+                streaming.digest() != vector.second) {
+                return {name, false, "XXH64 не совпадает с эталоном"};
+            }
+        }
+
+        auto dir = std::filesystem::temp_directory_path() / "ecosim_checksum_stream_test";
+        std::filesystem::remove_all(dir);
+        auto serial = runWorld(dir, "serial.ecsum", 1, 0);
+        auto parallel = runWorld(dir, "parallel.ecsum", 8, 0);
+        auto perturbed = runWorld(dir, "perturbed.ecsum", 8, 6);
+        if (serial != parallel || serial == perturbed) {
+            return {name, false, "checksum не различает состояния или зависит от числа потоков"};
+        }
+
+        ecosim::ChecksumStream left;
+        ecosim::ChecksumStream right;
+        ecosim::ChecksumStream changed;
+        std::string error;
+        if (!ecosim::readChecksumStream((dir / "serial.ecsum").string(), left, error) ||
+            !ecosim::readChecksumStream((dir / "parallel.ecsum").string(), right, error) ||
+            !ecosim::readChecksumStream((dir / "perturbed.ecsum").string(), changed, error)) {
+            return {name, false, "поток контрольных сумм не прочитан: " + error};
+        }
+        if (left.ticks.size() != 10 || left.subsystems.size() != ecosim::SimulationWorld::kDigestCount) {
+            return {name, false, "ожидалось 10 записей по 4 подсистемы"};
+        }
+        if (ecosim::diffChecksumStreams(left, right).diverged) {
+            return {name, false, "потоки 1 и 8 потоков различаются"};
+        }
+        auto diff = ecosim::diffChecksumStreams(left, changed);
+        if (!diff.diverged || diff.tick != 6 || diff.subsystems.empty() || diff.subsystems.front() != "world") {
+            return {name, false, "расхождение должно найтись на тике 6 в подсистеме world"};
+        }
+        left.ticks.pop_back();
+        left.digests.resize(left.ticks.size() * left.subsystems.size());
+        auto truncated = ecosim::diffChecksumStreams(left, right);
+        if (!truncated.diverged || truncated.tick != 10 || truncated.note.empty()) {
+            return {name, false, "обрезанный поток не обнаружен"};
+        }
+        std::filesystem::remove_all(dir);
+        return {name, true, "XXH64 совпадает с эталоном, поток тиков находит первый расходящийся тик и подсистему"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeChecksumStreamTest() {
+    return std::make_unique<ChecksumStreamTest>();
+}
+
+} // namespace ecosim_integration
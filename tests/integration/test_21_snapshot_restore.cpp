@@ -0,0 +1,153 @@
+#include "integration/test_framework.h"
+
+#include "modules/simulation_world.h"
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace ecosim_integration {
+
+namespace {
+struct RunResult {
+    bool ok = false;
+    int tick = 0;
+    std::string checksum;
+    std::string log;
+};
+
+// `scenario_first` lists the scenario before the world it depends on. `wolf_first` swaps the two tick-1
+// spawns, so the process interns wolf before deer: resuming a checkpoint taken without it only works if
+// the world restores its tables before the scenario re-parses its schedule against them.
+std::filesystem::path writeConfig(const std::filesystem::path &checkpoints, bool scenario_first = false,
+                                  bool wolf_first = false) {
+    std::vector<std::map<std::string, std::string>> schedule{
+        {{"tick", "1"}, {"command", "spawn"}, {"species", "deer"}, {"count", "3000"}},
+        {{"tick", "1"}, {"command", "spawn"}, {"species", "wolf"}, {"count", "50"}},
+        {{"tick", "1"}, {"command", "set_param"}, {"name", "metabolism"}, {"value", "0.15"}},
+        {{"tick", "8"}, {"command", "spawn"}, {"species", "boar"}, {"count", "200"}},
+        {{"tick", "9"}, {"command", "apply_shock"}, {"strength", "0.3"}},
+        {{"tick", "10"}, {"command", "spawn"}, {"species", "wolf"}, {"count", "40"}}};
+    std::vector<std::map<std::string, std::string>> modules{{{"type", "simulation_world"}, {"enable", "true"}},
+                                                            {{"type", "scenario"}, {"enable", "true"}}};
+    if (wolf_first) {
+        std::swap(schedule[0], schedule[1]);
+    }
+    if (scenario_first) {
+        std::swap(modules[0], modules[1]);
+    }
+    const std::string suffix = std::string(scenario_first ? "_scenario_first" : "") + (wolf_first ? "_wolf_first" : "");
+    auto scenario =
+        writeScenarioFile("scenario_test_21" + suffix + ".toml", 37, 14, {"simulation_world"}, schedule);
+    auto config = writeAppConfigFile("app_test_21" + suffix + ".toml", scenario, 20, modules);
+    std::ofstream file(config, std::ios::app);
+    file << "checkpoint_interval = 4\n";
+    file << "checkpoint_dir = \"" << checkpoints.generic_string() << "\"\n";
+    file << "checkpoint_keep = 2\n";
+    return config;
+}
+
+RunResult run(const std::filesystem::path &config, const std::filesystem::path &resume) {
+    std::ostringstream log_stream;
+    RunResult result;
+    {
+        ecosim::Logger logger(log_stream);
+        ecosim::Application app(logger);
+        if (app.initialize(config.string()) && app.startModules() &&
+            (resume.empty() || app.restoreSnapshot(resume.string()))) {
+            app.runHeadless();
+            auto *world = dynamic_cast<ecosim::SimulationWorld *>(app.moduleManager().findModule("simulation_world"));
+            result.ok = world != nullptr;
+            if (world) {
+                result.tick = world->readModel().tick;
+                result.checksum = world->checksum();
+            }
+        }
+        app.shutdown();
+    }
+    result.log = log_stream.str();
+    return result;
+}
+
+std::string readFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::filesystem::path &path, const std::string &bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+} // namespace
+
+class SnapshotRestoreTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.21 snapshot restore";
+        auto dir = std::filesystem::temp_directory_path() / "ecosim_snapshot_test";
+        std::filesystem::remove_all(dir);
+        auto checkpoints = dir / "checkpoints";
+        auto config = writeConfig(checkpoints);
+
+        auto full = ecosim_integration::run(config, {});
+        if (!full.ok || full.tick != 14) {
+            return {name, false, "полный запуск не дошёл до тика 14"};
+        }
+        auto at8 = checkpoints / "checkpoint_000000008.ecsnap";
+        auto at12 = checkpoints / "checkpoint_000000012.ecsnap";
+        if (std::filesystem::exists(checkpoints / "checkpoint_000000004.ecsnap") || !std::filesystem::exists(at8) ||
+            !std::filesystem::exists(at12)) {
+            return {name, false, "ожидались контрольные точки 8 и 12 (checkpoint_keep = 2)"};
+        }
+        auto original12 = readFile(at12);
+        auto saved8 = dir / "saved_8.ecsnap";
+        std::filesystem::copy_file(at8, saved8);
+
+        auto resumed = ecosim_integration::run(config, saved8);
+        if (!resumed.ok || !containsText(resumed.log, "Resumed from") || resumed.tick != full.tick ||
+            resumed.checksum != full.checksum) {
+            return {name, false, "продолжение с тика 8 не совпало с непрерывным запуском"};
+        }
+        if (readFile(at12) != original12) {
+            return {name, false, "контрольная точка тика 12 после продолжения отличается побайтно"};
+        }
+
+        // Config order also sets the phase order, so the baseline lists the scenario first as well.
+        auto scenario_first = ecosim_integration::run(writeConfig(dir / "scenario_first", true), {});
+        auto scenario_first8 = dir / "scenario_first" / "checkpoint_000000008.ecsnap";
+        auto reordered = ecosim_integration::run(writeConfig(dir / "wolf_first", true, true), scenario_first8);
+        if (!scenario_first.ok || !reordered.ok || !containsText(reordered.log, "Resumed from") ||
+            reordered.tick != scenario_first.tick || reordered.checksum != scenario_first.checksum) {
+            return {name, false, "при сценарии перед миром в конфигурации расписание разобрано не по восстановленным таблицам"};
+        }
+
+        auto bytes = readFile(saved8);
+        auto corrupted = dir / "corrupted.ecsnap";
+        auto flipped = bytes;
+        // Padding between sections is under 64 bytes, so 64 flipped bytes always hit a payload.
+        for (std::size_t i = flipped.size() / 2; i < flipped.size() / 2 + 64; ++i) {
+            flipped[i] ^= 0x5a;
+        }
+        writeFile(corrupted, flipped);
+        auto bad_hash = ecosim_integration::run(config, corrupted);
+        writeFile(corrupted, bytes.substr(0, bytes.size() / 2));
+        auto truncated = ecosim_integration::run(config, corrupted);
+        auto future = bytes;
+        future[8] = 2;
+        writeFile(corrupted, future);
+        auto bad_version = ecosim_integration::run(config, corrupted);
+        if (bad_hash.ok || !containsText(bad_hash.log, "corrupted") || truncated.ok ||
+            !containsText(truncated.log, "truncated") || bad_version.ok || !containsText(bad_version.log, "version")) {
+            return {name, false, "повреждённый, обрезанный или чужой версии снимок не отклонён"};
+        }
+
+        std::filesystem::remove_all(dir);
+        return {name, true, "продолжение с контрольной точки даёт тот же checksum и побайтно те же снимки, повреждения обнаруживаются"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeSnapshotRestoreTest() {
+    return std::make_unique<SnapshotRestoreTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,88 @@
+#include "integration/test_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/world_branch.h"
+
+#include <memory>
+
+namespace ecosim_integration {
+
+namespace {
+using Schedule = std::vector<ecosim::ScenarioConfig::ScheduledAction>;
+
+std::vector<Schedule> whatIfSchedules(int fork_tick) {
+    return {{},
+            {{fork_tick + 2, "apply_shock", {{"strength", "0.5"}}}},
+            {{fork_tick + 1, "set_param", {{"name", "metabolism"}, {"value", "0.4"}}}}};
+}
+
+std::vector<std::string> checksums(const std::vector<std::unique_ptr<ecosim::WorldBranch>> &branches) {
+    std::vector<std::string> result;
+    for (const auto &branch : branches) {
+        result.push_back(branch->world().checksum());
+    }
+    return result;
+}
+} // namespace
+
+class WorldForkTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.22 copy-on-write world fork";
+        constexpr int kBranchTicks = 6;
+        WorldHarness harness({}, 4);
+        auto &world = harness.world;
+        auto &pool = harness.pool;
+        world.enqueueCommand("world.reset", {{"seed", "21"}});
+        world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.05"}});
+        world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "40000"}});
+        world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "20000"}});
+        for (int tick = 0; tick < 5; ++tick) {
+            harness.tick();
+        }
+        const int fork_tick = world.readModel().tick;
+        const auto before = world.checksum();
+
+        std::string error;
+        auto parallel = ecosim::runBranches(world, harness.config, whatIfSchedules(fork_tick), kBranchTicks, pool, error);
+        if (parallel.size() != 3) {
+            return {name, false, "ветки не созданы: " + error};
+        }
+        if (world.checksum() != before || world.readModel().tick != fork_tick) {
+            return {name, false, "прогон веток изменил родительский мир"};
+        }
+        auto results = checksums(parallel);
+        if (results[1] == results[0] || results[2] == results[0] ||
+            parallel[1]->world().agents().size() >= parallel[0]->world().agents().size()) {
+            return {name, false, "расписания веток не повлияли на их состояние"};
+        }
+        auto memory = parallel[0]->world().agents().memory();
+        if (memory.shared_bytes * 2 < memory.bytes) {
+            return {name, false, "ветка без команд скопировала больше половины колонок: " +
+                                     std::to_string(memory.shared_bytes) + " из " + std::to_string(memory.bytes) +
+                                     " байт общие"};
+        }
+
+        ecosim::ThreadPool inline_pool;
+        auto sequential = ecosim::runBranches(world, harness.config, whatIfSchedules(fork_tick), kBranchTicks, inline_pool, error);
+        if (checksums(sequential) != results) {
+            return {name, false, "параллельный и последовательный прогон веток дают разные checksum"};
+        }
+        parallel.clear();
+        sequential.clear();
+
+        for (int tick = 0; tick < kBranchTicks; ++tick) {
+            harness.tick();
+        }
+        if (world.checksum() != results[0]) {
+            return {name, false, "ветка без команд разошлась с продолжением родителя"};
+        }
+        return {name, true, "ветки делят колонки копированием при записи, не меняют родителя и совпадают при параллельном прогоне"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeWorldForkTest() {
+    return std::make_unique<WorldForkTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,175 @@
+#include "integration/test_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/population_ode.h"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace ecosim_integration {
+
+namespace {
+// Logistic growth x' = x (1 - x / 100) from 10; exact solution at t.
+double logistic(double t) {
+    return 100.0 / (1.0 + 9.0 * std::exp(-t));
+}
+
+// Prey-predator x' = x (1 - 0.1 y), y' = y (-1 + 0.075 x) conserves this quantity.
+double lotkaVolterraInvariant(const std::vector<double> &x) {
+    return 0.075 * x[0] - std::log(x[0]) + 0.1 * x[1] - std::log(x[1]);
+}
+
+ecosim::PopulationOde predatorPrey() {
+    ecosim::PopulationOde ode;
+    ode.resize(2);
+    ode.setGrowth(0, 1.0);
+    ode.setGrowth(1, -1.0);
+    ode.setInteraction(0, 1, -0.1);
+    ode.setInteraction(1, 0, 0.075);
+    return ode;
+}
+
+std::vector<double> randomCommunity(ecosim::PopulationOde &ode, std::size_t species) {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> coefficient(-1.0, 1.0);
+    ode.resize(species);
+    std::vector<double> densities;
+    for (std::size_t i = 0; i < species; ++i) {
+        ode.setGrowth(i, 0.5 + 0.5 * coefficient(random));
+        for (std::size_t j = 0; j < species; ++j) {
+            ode.setInteraction(i, j, i == j ? -1.0 : 0.5 * coefficient(random) / static_cast<double>(species));
+        }
+        densities.push_back(0.5 + 0.25 * coefficient(random));
+    }
+    return densities;
+}
+
+std::string kernelMismatch() {
+    constexpr std::size_t kRows = 37;
+    constexpr std::size_t kStride = 40;
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> value(-3.0, 3.0);
+    std::vector<double> matrix(kRows * kStride);
+    std::vector<double> x(kStride);
+    for (auto &entry : matrix) {
+        entry = value(random);
+    }
+    for (auto &entry : x) {
+        entry = value(random);
+    }
+    std::vector<double> reference(kRows);
+    ecosim::interactionKernel(ecosim::KernelPath::Scalar)(matrix.data(), kStride, kRows, x.data(), reference.data());
+    for (auto path : {ecosim::KernelPath::Avx2, ecosim::KernelPath::Avx512}) {
+        auto kernel = ecosim::interactionKernel(path);
+        if (!kernel) {
+            continue;
+        }
+        std::vector<double> out(kRows);
+        kernel(matrix.data(), kStride, kRows, x.data(), out.data());
+        if (std::memcmp(out.data(), reference.data(), sizeof(double) * kRows) != 0) {
+            return ecosim::kernelPathName(path);
+        }
+    }
+    return {};
+}
+
+struct WorldResult {
+    int population = 0;
+    double density = 0.0;
+    std::size_t agents = 0;
+    std::string checksum;
+};
+
+WorldResult runOdeWorld(std::size_t threads) {
+    ecosim::AppConfig config;
+    config.dt = 0.5;
+    WorldHarness harness({{"dynamics", "ode"}, {"integrator", "rk45"}, {"ode_tolerance", "1e-10"}}, threads, config);
+    auto &world = harness.world;
+    world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "10"}});
+    world.enqueueCommand("set_param", {{"name", "ode.growth.deer"}, {"value", "1"}});
+    world.enqueueCommand("set_param", {{"name", "ode.interaction.deer.deer"}, {"value", "-0.01"}});
+    for (int tick = 0; tick < 10; ++tick) {
+        harness.tick();
+    }
+    WorldResult result;
+    result.population = world.readModel().populationOf("deer");
+    result.density = world.densities().empty() ? 0.0 : world.densities()[0];
+    result.agents = world.agents().size();
+    result.checksum = world.checksum();
+    return result;
+}
+} // namespace
+
+class PopulationOdeTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.23 population ODE integrators";
+
+        ecosim::PopulationOde logistic_ode;
+        logistic_ode.resize(1);
+        logistic_ode.setGrowth(0, 1.0);
+        logistic_ode.setInteraction(0, 0, -0.01);
+        std::vector<double> rk4{10.0};
+        for (int step = 0; step < 500; ++step) {
+            logistic_ode.stepRk4(rk4.data(), 0.01);
+        }
+        std::vector<double> rk45{10.0};
+        const double integrated = logistic_ode.advanceRk45(rk45.data(), 5.0, 1e-10);
+        std::vector<double> stalled{10.0};
+        if (integrated != 5.0 || logistic_ode.advanceRk45(stalled.data(), 5.0, 0.0) != 0.0 || stalled[0] != 10.0) {
+            return {name, false, "rk45 должен сообщать пройденное время и не шагать при допуске 0"};
+        }
+        if (std::abs(rk4[0] - logistic(5.0)) > 1e-6 || std::abs(rk45[0] - logistic(5.0)) > 1e-6) {
+            return {name, false, "логистический рост расходится с точным решением: rk4 " + std::to_string(rk4[0]) +
+                                     ", rk45 " + std::to_string(rk45[0]) + ", ожидалось " +
+                                     std::to_string(logistic(5.0))};
+        }
+
+        auto cycle = predatorPrey();
+        std::vector<double> densities{10.0, 5.0};
+        const double invariant = lotkaVolterraInvariant(densities);
+        std::size_t substeps = 0;
+        for (int tick = 0; tick < 20; ++tick) {
+            cycle.advanceRk45(densities.data(), 1.0, 1e-10);
+            substeps += cycle.acceptedSteps();
+        }
+        if (std::abs(lotkaVolterraInvariant(densities) - invariant) > 1e-6 || substeps <= 20) {
+            return {name, false, "rk45 не сохраняет инвариант хищник-жертва или не дробит шаг"};
+        }
+
+        auto path = kernelMismatch();
+        if (!path.empty()) {
+            return {name, false, "ядро A·x " + path + " отличается от скалярного"};
+        }
+
+        ecosim::PopulationOde single;
+        auto one = randomCommunity(single, 600);
+        ecosim::PopulationOde pooled;
+        auto four = randomCommunity(pooled, 600);
+        ecosim::ThreadPool pool;
+        pool.start(4);
+        pooled.setWorkers(&pool);
+        single.advanceRk45(one.data(), 2.0, 1e-8);
+        pooled.advanceRk45(four.data(), 2.0, 1e-8);
+        if (std::memcmp(one.data(), four.data(), sizeof(double) * one.size()) != 0) {
+            return {name, false, "результат шага зависит от числа потоков"};
+        }
+
+        auto world = runOdeWorld(1);
+        auto threaded = runOdeWorld(4);
+        if (world.agents != 0 || world.population != static_cast<int>(std::lround(logistic(5.0))) ||
+            std::abs(world.density - logistic(5.0)) > 1e-6 || threaded.checksum != world.checksum) {
+            return {name, false, "мир в режиме ode: популяция " + std::to_string(world.population) + ", плотность " +
+                                     std::to_string(world.density) + ", агентов " + std::to_string(world.agents)};
+        }
+        return {name, true, "rk4 и rk45 совпадают с точными решениями, ядра и потоки дают одинаковые биты, мир шагает по dt"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makePopulationOdeTest() {
+    return std::make_unique<PopulationOdeTest>();
+}
+
+} // namespace ecosim_integration
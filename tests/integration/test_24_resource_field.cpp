@@ -0,0 +1,163 @@
+#include "integration/test_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/resource_field.h"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace ecosim_integration {
+
+namespace {
+ecosim::ResourceParams fieldParams(float growth) {
+    ecosim::ResourceParams params;
+    params.growth = growth;
+    params.diffusion = 0.2f;
+    params.capacity = 4.0f;
+    return params;
+}
+
+std::vector<float> randomCells(std::size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> value(0.0f, 4.0f);
+    std::vector<float> cells(count);
+    for (auto &cell : cells) {
+        cell = value(random);
+    }
+    return cells;
+}
+
+std::string kernelMismatch() {
+    constexpr std::size_t kWidth = 203;
+    auto rows = randomCells(3 * kWidth, 3);
+    const auto params = fieldParams(0.3f);
+    std::vector<float> reference(kWidth);
+    ecosim::resourceKernel(ecosim::KernelPath::Scalar)(rows.data(), rows.data() + kWidth, rows.data() + 2 * kWidth,
+                                                       reference.data(), kWidth, params);
+    for (auto path : {ecosim::KernelPath::Avx2, ecosim::KernelPath::Avx512}) {
+        auto kernel = ecosim::resourceKernel(path);
+        if (!kernel) {
+            continue;
+        }
+        std::vector<float> out(kWidth);
+        kernel(rows.data(), rows.data() + kWidth, rows.data() + 2 * kWidth, out.data(), kWidth, params);
+        if (std::memcmp(out.data(), reference.data(), sizeof(float) * kWidth) != 0) {
+            return ecosim::kernelPathName(path);
+        }
+    }
+    return {};
+}
+
+// Plain double-buffered sweep with the scalar kernel: what the tiled in-place step must reproduce.
+std::vector<float> referenceStep(const std::vector<float> &cells, std::size_t side,
+                                 const ecosim::ResourceParams &params) {
+    auto kernel = ecosim::resourceKernel(ecosim::KernelPath::Scalar);
+    std::vector<float> next(cells.size());
+    for (std::size_t row = 0; row < side; ++row) {
+        const float *above = cells.data() + (row > 0 ? row - 1 : row) * side;
+        const float *below = cells.data() + (row + 1 < side ? row + 1 : row) * side;
+        kernel(above, cells.data() + row * side, below, next.data() + row * side, side, params);
+    }
+    return next;
+}
+
+struct WorldResult {
+    double energy = 0.0;
+    double resources = 0.0;
+    std::string checksum;
+};
+
+WorldResult runWorld(const std::string &resource_cells, std::size_t threads) {
+    std::map<std::string, std::string> params{{"world_size", "100"}};
+    if (!resource_cells.empty()) {
+        params["resource_cells"] = resource_cells;
+    }
+    WorldHarness harness(params, threads);
+    auto &world = harness.world;
+    world.enqueueCommand("world.reset", {{"seed", "4"}});
+    world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.2"}});
+    world.enqueueCommand("set_param", {{"name", "resource.intake"}, {"value", "0.15"}});
+    world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "3000"}});
+    for (int tick = 0; tick < 8; ++tick) {
+        harness.tick();
+    }
+    return {world.readModel().energy_sum, world.resources().total(), world.checksum()};
+}
+} // namespace
+
+class ResourceFieldTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.24 tiled resource diffusion field";
+
+        auto path = kernelMismatch();
+        if (!path.empty()) {
+            return {name, false, "ядро ресурсного поля " + path + " отличается от скалярного"};
+        }
+
+        // 300 rows: two full tiles and a partial one.
+        constexpr std::size_t kSide = 300;
+        const auto params = fieldParams(0.1f);
+        auto start = randomCells(kSide * kSide, 9);
+        auto expected = start;
+        for (int step = 0; step < 3; ++step) {
+            expected = referenceStep(expected, kSide, params);
+        }
+        ecosim::ThreadPool pool;
+        pool.start(4);
+        for (ecosim::ThreadPool *workers : {static_cast<ecosim::ThreadPool *>(nullptr), &pool}) {
+            ecosim::ResourceField field;
+            field.setParams(params);
+            field.resize(kSide, 100.0f);
+            field.assign(start);
+            field.setWorkers(workers);
+            for (int step = 0; step < 3; ++step) {
+                field.step();
+            }
+            if (std::memcmp(field.values().data(), expected.data(), sizeof(float) * expected.size()) != 0) {
+                return {name, false, std::string("шаг по плиткам на месте расходится с двойной буферизацией") +
+                                         (workers ? " на 4 потоках" : "")};
+            }
+        }
+
+        ecosim::ResourceField diffusion;
+        diffusion.setParams(fieldParams(0.0f));
+        diffusion.resize(kSide, 100.0f);
+        diffusion.assign(start);
+        const double mass = diffusion.total();
+        for (int step = 0; step < 20; ++step) {
+            diffusion.step();
+        }
+        if (std::abs(diffusion.total() - mass) > 1e-5 * mass) {
+            return {name, false, "диффузия без роста не сохраняет массу: " + std::to_string(mass) + " -> " +
+                                     std::to_string(diffusion.total())};
+        }
+
+        WorldHarness oversized({{"resource_cells", "100000"}, {"world_size", "10O"}}, 0);
+        if (oversized.world.resources().cells() != 0 ||
+            oversized.log().find("Invalid resource_cells 100000") == std::string::npos ||
+            oversized.log().find("Invalid world_size 10O") == std::string::npos) {
+            return {name, false, "слишком большая сетка или опечатка в world_size не заменены значением по умолчанию"};
+        }
+
+        auto fed = runWorld("64", 1);
+        auto threaded = runWorld("64", 4);
+        auto starving = runWorld("", 1);
+        if (fed.checksum != threaded.checksum) {
+            return {name, false, "мир с ресурсным полем зависит от числа потоков"};
+        }
+        if (!(fed.energy > starving.energy) || !(fed.resources < 64.0 * 64.0)) {
+            return {name, false, "агенты не питаются из поля: энергия " + std::to_string(fed.energy) + " против " +
+                                     std::to_string(starving.energy) + ", ресурс " + std::to_string(fed.resources)};
+        }
+        return {name, true, "ядра и потоки дают одинаковые биты, шаг на месте совпадает с эталоном, агенты питаются"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeResourceFieldTest() {
+    return std::make_unique<ResourceFieldTest>();
+}
+
+} // namespace ecosim_integration
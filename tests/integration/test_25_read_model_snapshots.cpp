@@ -0,0 +1,115 @@
+#include "integration/test_framework.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace ecosim_integration {
+
+namespace {
+// The world's rolling hash recomputed from the published fields; a torn copy would not match.
+bool consistent(const ecosim::ReadModel &model) {
+    std::uint64_t hash = 0;
+    for (int count : model.population) {
+        hash = hash * 31 + static_cast<std::uint64_t>(static_cast<std::int64_t>(count));
+    }
+    hash = hash * 31 + static_cast<std::uint64_t>(static_cast<std::int64_t>(model.energy_total));
+    hash = hash * 31 + static_cast<std::uint64_t>(static_cast<std::int64_t>(model.seed));
+    return hash == model.state_hash && model.population.size() == model.species.size();
+}
+
+struct ReaderStats {
+    std::size_t reads = 0;
+    std::size_t torn = 0;
+    std::size_t out_of_order = 0;
+};
+
+void readUntil(const ecosim::SimulationWorld &world, const std::atomic<bool> &done, ReaderStats &stats) {
+    std::uint64_t last_version = 0;
+    int last_tick = 0;
+    while (!done.load()) {
+        auto snapshot = world.snapshot();
+        if (!snapshot) {
+            continue;
+        }
+        ++stats.reads;
+        stats.torn += consistent(snapshot.model()) ? 0 : 1;
+        if (snapshot.version() < last_version ||
+            (snapshot.version() > last_version && last_version != 0 && snapshot->tick < last_tick)) {
+            ++stats.out_of_order;
+        }
+        last_version = snapshot.version();
+        last_tick = snapshot->tick;
+    }
+}
+} // namespace
+
+class ReadModelSnapshotsTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.25 versioned read model snapshots";
+        WorldHarness harness;
+        auto &world = harness.world;
+        world.enqueueCommand("world.reset", {{"seed", "8"}});
+        world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.3"}});
+        world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "500"}});
+        world.onPreTick();
+
+        auto pinned = world.snapshot();
+        const int pinned_tick = pinned->tick;
+        const int pinned_deer = pinned->populationOf("deer");
+
+        std::atomic<bool> done{false};
+        ReaderStats stats[2];
+        std::thread readers[2];
+        for (int i = 0; i < 2; ++i) {
+            readers[i] = std::thread(readUntil, std::cref(world), std::cref(done), std::ref(stats[i]));
+        }
+        for (int tick = 0; tick < 300; ++tick) {
+            if (tick == 100) {
+                world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "50"}});
+            }
+            harness.tick();
+            if (tick % 16 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true);
+        for (auto &reader : readers) {
+            reader.join();
+        }
+
+        if (pinned->tick != pinned_tick || pinned->populationOf("deer") != pinned_deer || !consistent(pinned.model())) {
+            return {name, false, "закреплённая версия изменилась, пока мир шёл вперёд"};
+        }
+        for (const auto &reader : stats) {
+            if (reader.torn != 0 || reader.out_of_order != 0) {
+                return {name, false, "читатель увидел несогласованную модель (" + std::to_string(reader.torn) +
+                                         ") или версии не по порядку (" + std::to_string(reader.out_of_order) + ")"};
+            }
+        }
+        // Readers preempted while acquiring may have held back reuse; with them gone, a long-lived
+        // snapshot must pin only its own version.
+        auto latest = world.snapshot();
+        if (latest->tick != world.readModel().tick || latest->state_hash != world.readModel().state_hash ||
+            latest->populationOf("wolf") != world.readModel().populationOf("wolf")) {
+            return {name, false, "последняя версия не совпадает с живой моделью"};
+        }
+        const std::size_t versions = world.publisher().versionCount();
+        for (int tick = 0; tick < 100; ++tick) {
+            harness.tick();
+        }
+        if (world.publisher().versionCount() > versions + 2 || latest.version() + 100 != world.snapshot().version()) {
+            return {name, false, "версии не переиспользуются: " + std::to_string(versions) + " -> " +
+                                     std::to_string(world.publisher().versionCount())};
+        }
+        return {name, true, "читатели на других потоках видят согласованные версии по порядку, память переиспользуется (" +
+                                std::to_string(stats[0].reads + stats[1].reads) + " чтений)"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeReadModelSnapshotsTest() {
+    return std::make_unique<ReadModelSnapshotsTest>();
+}
+
+} // namespace ecosim_integration
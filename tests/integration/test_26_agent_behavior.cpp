@@ -0,0 +1,168 @@
+#include "integration/test_framework.h"
+
+#include "modules/agent_behavoir.h"
+
+#include <cmath>
+#include <memory>
+
+namespace ecosim_integration {
+
+namespace {
+using Params = std::map<std::string, std::string>;
+
+// World plus behaviour module on one context; the world's pre-tick applies the intents.
+struct BehaviorRun {
+    BehaviorRun(std::size_t threads, const Params &world_params, const Params &behavior_params)
+        : harness(world_params, threads), behavior({"agent_behavoir", "default", true, behavior_params},
+                                                   harness.context) {
+        behavior.setWorld(&world);
+        behavior.onInit();
+        world.enqueueCommand("world.reset", {{"seed", "26"}});
+    }
+
+    void tick() { harness.tick({&behavior}); }
+
+    std::size_t count(ecosim::AgentAction action) const {
+        return behavior.actionCounts()[static_cast<std::size_t>(action)];
+    }
+
+    WorldHarness harness;
+    ecosim::SimulationWorld &world = harness.world;
+    ecosim::AgentBehavoir behavior;
+};
+
+float maxEnergy(const ecosim::AgentStore &agents, ecosim::SpeciesId species) {
+    float high = 0.0f;
+    for (std::size_t row = 0; row < agents.size(); ++row) {
+        if (agents.species()[row] == species) {
+            high = std::max(high, agents.energy()[row]);
+        }
+    }
+    return high;
+}
+
+struct Position {
+    ecosim::AgentHandle agent;
+    ecosim::SpeciesId species = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+// By handle: applying intents may reorder the rows.
+std::vector<Position> positions(const ecosim::AgentStore &agents) {
+    std::vector<Position> out;
+    for (std::size_t row = 0; row < agents.size(); ++row) {
+        out.push_back({agents.handle(row), agents.species()[row], agents.x()[row], agents.y()[row]});
+    }
+    return out;
+}
+
+// Every deer must have moved away from the wolf nearest to it, by the configured speed.
+bool deerFled(const ecosim::AgentStore &agents, const std::vector<Position> &before, ecosim::SpeciesId deer) {
+    std::size_t fled = 0;
+    for (const auto &prey : before) {
+        if (prey.species != deer) {
+            continue;
+        }
+        float wolf_dx = 0.0f;
+        float wolf_dy = 0.0f;
+        float nearest = -1.0f;
+        for (const auto &other : before) {
+            if (other.species == deer) {
+                continue;
+            }
+            const float dx = other.x - prey.x;
+            const float dy = other.y - prey.y;
+            if (nearest < 0.0f || dx * dx + dy * dy < nearest) {
+                nearest = dx * dx + dy * dy;
+                wolf_dx = dx;
+                wolf_dy = dy;
+            }
+        }
+        const std::size_t row = agents.row(prey.agent);
+        const float moved_x = agents.x()[row] - prey.x;
+        const float moved_y = agents.y()[row] - prey.y;
+        if (moved_x * wolf_dx + moved_y * wolf_dy >= 0.0f ||
+            std::abs(std::sqrt(moved_x * moved_x + moved_y * moved_y) - 1.0f) > 1e-3f) {
+            return false;
+        }
+        ++fled;
+    }
+    return fled > 0;
+}
+
+std::string mixedChecksum(std::size_t threads, std::size_t &hunts) {
+    BehaviorRun run(threads, {{"world_size", "60"}}, {{"predators", "wolf"}, {"reproduce_energy", "3"}});
+    run.world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "4000"}});
+    run.world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "400"}});
+    run.world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.05"}});
+    hunts = 0;
+    for (int tick = 0; tick < 20; ++tick) {
+        run.tick();
+        hunts += run.count(ecosim::AgentAction::Hunt);
+    }
+    run.world.onPreTick();
+    return run.world.checksum();
+}
+} // namespace
+
+class AgentBehaviorTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.26 batched agent behavior";
+
+        BehaviorRun hunt(1, {{"world_size", "2"}}, {{"hunt_range", "3"}, {"reproduce_energy", "100"}});
+        hunt.world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "1"}});
+        hunt.world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "1"}});
+        hunt.tick();
+        const int deer_before = hunt.world.readModel().populationOf("deer");
+        const auto wolf = hunt.world.readModel().species.find("wolf");
+        const float wolf_energy = maxEnergy(hunt.world.agents(), wolf);
+        hunt.world.onPreTick();
+        if (hunt.count(ecosim::AgentAction::Hunt) == 0 ||
+            hunt.world.readModel().populationOf("deer") >= deer_before ||
+            maxEnergy(hunt.world.agents(), wolf) <= wolf_energy) {
+            return {name, false, "волк рядом с оленем не охотится: охот " +
+                                     std::to_string(hunt.count(ecosim::AgentAction::Hunt)) + ", оленей " +
+                                     std::to_string(hunt.world.readModel().populationOf("deer"))};
+        }
+
+        BehaviorRun flee(1, {{"world_size", "100"}}, {{"sense_radius", "200"}, {"hunt_range", "0"}});
+        flee.world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "3"}});
+        flee.world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "1"}});
+        flee.tick();
+        const auto before = positions(flee.world.agents());
+        flee.world.onPreTick();
+        if (flee.count(ecosim::AgentAction::Flee) == 0 ||
+            !deerFled(flee.world.agents(), before, flee.world.readModel().species.find("deer"))) {
+            return {name, false, "олени не убегают от ближайшего волка"};
+        }
+
+        BehaviorRun births(1, {}, {{"reproduce_energy", "1"}});
+        births.world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "50"}});
+        births.tick();
+        const int parents = births.world.readModel().populationOf("deer");
+        births.world.onPreTick();
+        if (births.count(ecosim::AgentAction::Reproduce) != static_cast<std::size_t>(parents) ||
+            births.world.readModel().populationOf("deer") != 2 * parents) {
+            return {name, false, "размножение: " + std::to_string(parents) + " родителей, стало " +
+                                     std::to_string(births.world.readModel().populationOf("deer"))};
+        }
+
+        std::size_t hunts_single = 0;
+        std::size_t hunts_pooled = 0;
+        const auto single = mixedChecksum(1, hunts_single);
+        const auto pooled = mixedChecksum(4, hunts_pooled);
+        if (single != pooled || hunts_single != hunts_pooled || hunts_single == 0) {
+            return {name, false, "решения зависят от числа потоков: охот " + std::to_string(hunts_single) + " и " +
+                                     std::to_string(hunts_pooled)};
+        }
+        return {name, true, "охота, бегство и размножение применяются миром, решения не зависят от числа потоков"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeAgentBehaviorTest() {
+    return std::make_unique<AgentBehaviorTest>();
+}
+
+} // namespace ecosim_integration
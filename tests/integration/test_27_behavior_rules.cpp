@@ -0,0 +1,142 @@
+#include "integration/test_framework.h"
+
+#include "modules/agent_behavoir.h"
+#include "modules/behavior_program.h"
+
+#include <memory>
+#include <random>
+
+namespace ecosim_integration {
+
+namespace {
+using ecosim::AgentAction;
+using ecosim::BehaviorFeature;
+using ecosim::BehaviorProgram;
+
+// The built-in decision list written as rules (reproduce_energy = 4).
+const char *kBuiltInRules = "prey > 0 -> hunt; threats > 0 -> flee; energy >= 4 -> reproduce\n"
+                            "predator -> move; true -> forage";
+
+void randomFeatures(std::vector<float> &registers, std::size_t lanes, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> count(0, 2);
+    std::uniform_real_distribution<float> value(0.0f, 8.0f);
+    for (std::size_t i = 0; i < lanes; ++i) {
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Energy)[i] = value(random);
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Age)[i] = static_cast<float>(count(random) * 10);
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Prey)[i] = static_cast<float>(count(random) / 2);
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Threats)[i] = static_cast<float>(count(random) / 2);
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Predator)[i] = static_cast<float>(count(random) % 2);
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Species)[i] = static_cast<float>(count(random));
+        BehaviorProgram::feature(registers.data(), BehaviorFeature::Random)[i] = value(random) / 8.0f;
+    }
+}
+
+std::string compileError(const std::string &source) {
+    BehaviorProgram program;
+    std::string error;
+    return program.compile(source, error) ? std::string() : error;
+}
+
+struct RunResult {
+    std::string checksum;
+    bool uses_rules = false;
+};
+
+RunResult runWorld(const std::map<std::string, std::string> &behavior_params) {
+    WorldHarness harness({{"world_size", "60"}}, 0);
+    auto &world = harness.world;
+    ecosim::AgentBehavoir behavior({"agent_behavoir", "default", true, behavior_params}, harness.context);
+    behavior.setWorld(&world);
+    behavior.onInit();
+    world.enqueueCommand("world.reset", {{"seed", "27"}});
+    world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "3000"}});
+    world.enqueueCommand("spawn", {{"species", "wolf"}, {"count", "300"}});
+    world.enqueueCommand("set_param", {{"name", "metabolism"}, {"value", "0.05"}});
+    for (int tick = 0; tick < 15; ++tick) {
+        harness.tick({&behavior});
+    }
+    world.onPreTick();
+    return {world.checksum(), behavior.usesRules()};
+}
+} // namespace
+
+class BehaviorRulesTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.27 behavior rule bytecode";
+
+        for (const char *broken : {"energy > -> rest", "hunger > 2 -> rest", "energy > 2 -> sleep", "energy > 2",
+                                   "(energy > 2 -> rest", "energy > 2 -> rest extra"}) {
+            if (compileError(broken).empty()) {
+                return {name, false, std::string("ошибочное правило скомпилировалось: ") + broken};
+            }
+        }
+
+        BehaviorProgram program;
+        std::string error;
+        if (!program.compile("energy * 2 - age / 10 > 3 and not predator -> reproduce; species.wolf || "
+                             "-energy < -7 -> hunt; (random < 0.5) == (age != 0) -> flee",
+                             error)) {
+            return {name, false, "правила не скомпилировались: " + error};
+        }
+        ecosim::SpeciesRegistry species;
+        species.intern("deer");
+        species.intern("wolf");
+        program.bindSpecies(species);
+        constexpr std::size_t kLanes = 200;
+        std::vector<float> registers(program.registerCount() * BehaviorProgram::kLanes);
+        randomFeatures(registers, kLanes, 5);
+        std::vector<AgentAction> actions(kLanes);
+        program.run(registers.data(), kLanes, actions.data());
+        for (std::size_t i = 0; i < kLanes; ++i) {
+            auto at = [&](BehaviorFeature feature) { return BehaviorProgram::feature(registers.data(), feature)[i]; };
+            AgentAction expected = AgentAction::Rest;
+            if (at(BehaviorFeature::Energy) * 2 - at(BehaviorFeature::Age) / 10 > 3 &&
+                at(BehaviorFeature::Predator) == 0.0f) {
+                expected = AgentAction::Reproduce;
+            } else if (at(BehaviorFeature::Species) == 1.0f || -at(BehaviorFeature::Energy) < -7.0f) {
+                expected = AgentAction::Hunt;
+            } else if ((at(BehaviorFeature::Random) < 0.5f) == (at(BehaviorFeature::Age) != 0.0f)) {
+                expected = AgentAction::Flee;
+            }
+            if (actions[i] != expected) {
+                return {name, false, "ВМ вычислила не то действие в строке " + std::to_string(i)};
+            }
+        }
+
+        WorldHarness harness;
+        auto &context = harness.context;
+        ecosim::AgentBehavoir built_in({"agent_behavoir", "built_in", true, {}}, context);
+        ecosim::AgentBehavoir compiled({"agent_behavoir", "compiled", true, {{"rules", kBuiltInRules}}}, context);
+        ecosim::AgentBehavoir broken({"agent_behavoir", "broken", true, {{"rules", "energy >"}}}, context);
+        built_in.onInit();
+        compiled.onInit();
+        broken.onInit();
+        if (!compiled.usesRules() || compiled.rules().ruleCount() != 5 || broken.usesRules()) {
+            return {name, false, "правила модуля: ошибочные должны отклоняться, верные — применяться"};
+        }
+        std::vector<float> features(compiled.rules().registerCount() * BehaviorProgram::kLanes);
+        randomFeatures(features, BehaviorProgram::kLanes, 9);
+        std::vector<AgentAction> native(BehaviorProgram::kLanes);
+        std::vector<AgentAction> interpreted(BehaviorProgram::kLanes);
+        built_in.decide(features.data(), BehaviorProgram::kLanes, native.data());
+        compiled.decide(features.data(), BehaviorProgram::kLanes, interpreted.data());
+        if (native != interpreted) {
+            return {name, false, "правила, повторяющие встроенные, дают другие решения"};
+        }
+
+        auto world_native = runWorld({});
+        auto world_rules = runWorld({{"rules", kBuiltInRules}});
+        if (!world_rules.uses_rules || world_native.checksum != world_rules.checksum) {
+            return {name, false, "мир с правилами из конфигурации расходится со встроенными правилами"};
+        }
+        return {name, true, "правила компилируются в байткод, ВМ совпадает с C++ и со встроенным поведением"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeBehaviorRulesTest() {
+    return std::make_unique<BehaviorRulesTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,142 @@
+#include "integration/test_framework.h"
+
+#include "core/thread_pool.h"
+#include "modules/agent_behavoir.h"
+#include "modules/flow_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace ecosim_integration {
+
+namespace {
+using ecosim::FlowField;
+
+// Worst alignment of the field with the exact direction to (or from) a single source, over the cells
+// well inside the reach; and whether every cell clearly out of reach has no direction.
+struct Alignment {
+    float worst = 1.0f;
+    bool quiet_outside = true;
+};
+
+Alignment singleSource(FlowField::Mode mode) {
+    constexpr std::size_t kCells = 96;
+    FlowField field(mode);
+    field.resize(kCells, static_cast<float>(kCells));
+    field.setSource(40 * kCells + 40, true);
+    field.update();
+    Alignment result;
+    for (std::size_t cell = 0; cell < kCells * kCells; ++cell) {
+        const float dx = 40.0f - static_cast<float>(cell % kCells);
+        const float dy = 40.0f - static_cast<float>(cell / kCells);
+        const float distance = std::sqrt(dx * dx + dy * dy);
+        const auto direction = field.direction(cell);
+        if (distance > 0.0f && distance < 14.0f) {
+            const float sign = mode == FlowField::Mode::Toward ? 1.0f : -1.0f;
+            result.worst = std::min(result.worst, sign * (direction.dx * dx + direction.dy * dy) / distance);
+        } else if (distance > 18.0f && (direction.dx != 0.0f || direction.dy != 0.0f)) {
+            result.quiet_outside = false;
+        }
+    }
+    return result;
+}
+
+bool sameField(const FlowField &a, const FlowField &b) {
+    for (std::size_t cell = 0; cell < a.cells() * a.cells(); ++cell) {
+        const auto da = a.direction(cell);
+        const auto db = b.direction(cell);
+        if (a.distance(cell) != b.distance(cell) || std::memcmp(&da, &db, sizeof(da)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Deer on a depleting resource grid (no regrowth, large bites); returns the energy they gathered.
+double foraged(std::size_t flow_cells) {
+    WorldHarness harness({{"world_size", "64"}, {"resource_cells", "64"}});
+    auto &world = harness.world;
+    ecosim::AgentBehavoir behavior(
+        {"agent_behavoir", "default", true, {{"flow_cells", std::to_string(flow_cells)}, {"reproduce_energy", "1e9"}}},
+        harness.context);
+    behavior.setWorld(&world);
+    world.enqueueCommand("world.reset", {{"seed", "28"}});
+    world.enqueueCommand("set_param", {{"name", "resource.growth"}, {"value", "0"}});
+    world.enqueueCommand("set_param", {{"name", "resource.diffusion"}, {"value", "0"}});
+    world.enqueueCommand("set_param", {{"name", "resource.intake"}, {"value", "1"}});
+    world.enqueueCommand("spawn", {{"species", "deer"}, {"count", "40"}});
+    const double initial = 64.0 * 64.0;
+    for (int tick = 0; tick < 40; ++tick) {
+        harness.tick({&behavior});
+    }
+    return initial - world.resources().total();
+}
+} // namespace
+
+class FlowFieldsTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.28 cached flow fields";
+
+        for (auto mode : {FlowField::Mode::Toward, FlowField::Mode::Away}) {
+            auto alignment = singleSource(mode);
+            if (alignment.worst < 0.9f || !alignment.quiet_outside) {
+                return {name, false, std::string(mode == FlowField::Mode::Toward ? "к источнику" : "от источника") +
+                                         ": худшее совпадение направления " + std::to_string(alignment.worst)};
+            }
+        }
+
+        constexpr std::size_t kCells = 100;
+        std::mt19937 random(28);
+        std::bernoulli_distribution sparse(0.02);
+        std::vector<std::uint8_t> sources(kCells * kCells);
+        for (auto &source : sources) {
+            source = sparse(random) ? 1 : 0;
+        }
+        FlowField incremental;
+        incremental.resize(kCells, 50.0f);
+        incremental.assignSources(sources);
+        incremental.update();
+        std::uniform_int_distribution<std::size_t> cell(0, kCells * kCells - 1);
+        for (int change = 0; change < 5; ++change) {
+            auto &source = sources[cell(random)];
+            source = source ? 0 : 1;
+        }
+        incremental.assignSources(sources);
+        const std::size_t recomputed = incremental.update();
+        FlowField full;
+        full.resize(kCells, 50.0f);
+        full.assignSources(sources);
+        full.rebuild();
+        ecosim::ThreadPool pool;
+        pool.start(4);
+        FlowField pooled;
+        pooled.setWorkers(&pool);
+        pooled.resize(kCells, 50.0f);
+        pooled.assignSources(sources);
+        pooled.rebuild();
+        if (recomputed > 5 * 9 || recomputed == 0 || !sameField(incremental, full) || !sameField(full, pooled)) {
+            return {name, false, "пересчёт грязных плиток (" + std::to_string(recomputed) +
+                                     ") или потоки дают другое поле, чем полный пересчёт"};
+        }
+
+        const double random_walk = foraged(0);
+        const double following = foraged(64);
+        if (following <= random_walk) {
+            return {name, false, "по полю еды собрано " + std::to_string(following) + ", случайным блужданием " +
+                                     std::to_string(random_walk)};
+        }
+        return {name, true, "поля указывают к источникам и от них, пересчитываются по грязным плиткам без "
+                            "расхождений, агенты по полю еды собирают больше (" +
+                                std::to_string(following) + " против " + std::to_string(random_walk) + ")"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeFlowFieldsTest() {
+    return std::make_unique<FlowFieldsTest>();
+}
+
+} // namespace ecosim_integration
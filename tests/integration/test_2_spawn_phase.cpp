@@ -30,14 +30,13 @@ public:
             return {name, false, "модуль simulation_world не найден"};
         }
 
-        if (!world->readModel().population_by_species.empty()) {
+        if (!world->readModel().population.empty()) {
             return {name, false, "до тика состояние мира должно быть пустым"};
         }
 
         app.runHeadless();
         auto state = world->readModel();
-        auto it = state.population_by_species.find("boar");
-        if (state.tick < 1 || it == state.population_by_species.end() || it->second != 3) {
+        if (state.tick < 1 || state.populationOf("boar") != 3) {
             return {name, false, "после первого тика ожидается boar=3 (2 spawn + 1 onTick)"};
         }
 
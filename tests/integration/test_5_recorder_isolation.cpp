@@ -46,7 +46,7 @@ Snapshot runScenario(bool with_recorder) {
     }
 
     auto state = world->readModel();
-    return {state.tick, state.energy_total, state.population_by_species.size(), world->checksum()};
+    return {state.tick, state.energy_total, state.population.size(), world->checksum()};
 }
 } // namespace
 
@@ -41,8 +41,8 @@ Snapshot runOnce(const std::string &suffix) {
     auto state = world->readModel();
     return {state.tick,
             state.energy_total,
-            state.population_by_species.count("boar") ? state.population_by_species.at("boar") : 0,
-            state.population_by_species.count("deer") ? state.population_by_species.at("deer") : 0,
+            state.populationOf("boar"),
+            state.populationOf("deer"),
             world->checksum()};
 }
 } // namespace
@@ -0,0 +1,69 @@
+#include "integration/test_framework.h"
+
+#include "modules/recorder_csv.h"
+#include "modules/simulation_world.h"
+
+#include <memory>
+
+namespace ecosim_integration {
+
+class TypedEventsTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.7 typed events and legacy payload";
+        std::ostringstream log_stream;
+        ecosim::Logger logger(log_stream);
+        ecosim::Application app(logger);
+
+        auto scenario = writeScenarioFile(
+            "scenario_test_7.toml", 5, 2, {"simulation_world"},
+            {{{"tick", "1"}, {"command", "spawn"}, {"species", "hare"}, {"count", "4"}}});
+        auto config = writeAppConfigFile("app_test_7.toml", scenario, 2,
+                                         {{{"type", "simulation_world"}, {"enable", "true"}},
+                                          {{"type", "scenario"}, {"enable", "true"}},
+                                          {{"type", "recorder"}, {"id", "csv"}, {"enable", "true"}, {"sink", "memory"}}});
+
+        if (!app.initialize(config.string()) || !app.startModules()) {
+            return {name, false, "не удалось инициализировать/запустить модули"};
+        }
+
+        auto *recorder = dynamic_cast<ecosim::RecorderCsv *>(app.moduleManager().findModule("recorder", "csv"));
+        if (!recorder) {
+            return {name, false, "модуль recorder не найден"};
+        }
+
+        std::vector<ecosim::SimulationEvent> legacy_events;
+        app.eventBus().subscribe("world.tick",
+                                 [&legacy_events](const ecosim::SimulationEvent &event) { legacy_events.push_back(event); });
+
+        app.runHeadless();
+
+        auto &bus = app.eventBus();
+        if (recorder->events().size() != 2 || legacy_events.size() != 2) {
+            return {name, false, "ожидалось по 2 события world.tick для typed и строковых подписчиков"};
+        }
+        const auto &typed = recorder->events().back();
+        auto energy = typed.find(bus.fieldId("energy_total"));
+        auto hares = typed.find(bus.fieldId("population.hare"));
+        if (!energy || !hares || hares->value.asInt() != 5) {
+            return {name, false, "typed-событие не содержит ожидаемых полей (hare=5)"};
+        }
+
+        const auto &legacy = legacy_events.back();
+        auto legacy_energy = legacy.payload.find("energy_total");
+        auto legacy_hares = legacy.payload.find("population.hare");
+        if (legacy.type != "world.tick" || legacy_energy == legacy.payload.end() ||
+            legacy_energy->second != std::to_string(energy->value.asInt()) ||
+            legacy_hares == legacy.payload.end() || legacy_hares->second != "5") {
+            return {name, false, "строковый payload не совпадает с typed-событием"};
+        }
+
+        return {name, true, "typed-события доставлены, строковый API получает эквивалентный payload"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeTypedEventsTest() {
+    return std::make_unique<TypedEventsTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,114 @@
+#include "integration/test_framework.h"
+
+#include "core/event_bus.h"
+
+#include <memory>
+#include <thread>
+
+namespace ecosim_integration {
+
+namespace {
+std::vector<std::int64_t> deliverFromThreads(int thread_count) {
+    constexpr int kItems = 4096;
+    ecosim::EventBus bus;
+    auto type = bus.typeId("test.item");
+    auto item_field = bus.fieldId("item");
+
+    std::vector<std::int64_t> delivered;
+    bus.subscribe(type, [&](const ecosim::TypedEvent &event) {
+        delivered.push_back(event.find(item_field)->value.asInt());
+    });
+
+    auto emitMarker = [&](std::int64_t value) {
+        bus.setCurrentProducer(1);
+        ecosim::TypedEvent marker;
+        marker.type = type;
+        marker.add(item_field, ecosim::EventValue::ofInt(value));
+        bus.emit(marker);
+    };
+    emitMarker(-1);
+
+    bus.setCurrentProducer(0);
+    std::vector<ecosim::EventBus::Lane *> lanes;
+    for (int t = 0; t < thread_count; ++t) {
+        lanes.push_back(&bus.lane(static_cast<std::uint32_t>(t)));
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thread_count; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int item = t; item < kItems; item += thread_count) {
+                ecosim::TypedEvent event;
+                event.type = type;
+                event.add(item_field, ecosim::EventValue::ofInt(item));
+                lanes[t]->emit(std::move(event), static_cast<std::uint64_t>(item));
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    emitMarker(-2);
+
+    bus.deliverBuffered();
+    return delivered;
+}
+
+// Main-thread events of two producers, emitted interleaved, with or without one lane event in between.
+std::vector<std::int64_t> deliverInterleaved(bool with_lane) {
+    ecosim::EventBus bus;
+    auto type = bus.typeId("test.item");
+    auto item_field = bus.fieldId("item");
+    std::vector<std::int64_t> delivered;
+    bus.subscribe(type, [&](const ecosim::TypedEvent &event) {
+        delivered.push_back(event.find(item_field)->value.asInt());
+    });
+    auto emit = [&](std::uint32_t producer, std::int64_t value) {
+        bus.setCurrentProducer(producer);
+        ecosim::TypedEvent event;
+        event.type = type;
+        event.add(item_field, ecosim::EventValue::ofInt(value));
+        bus.emit(std::move(event));
+    };
+    emit(0, 1);
+    emit(1, 2);
+    if (with_lane) {
+        ecosim::TypedEvent event;
+        event.type = type;
+        event.add(item_field, ecosim::EventValue::ofInt(100));
+        bus.lane(0).emit(std::move(event), 7);
+    }
+    emit(0, 3);
+    emit(1, 4);
+    bus.deliverBuffered();
+    return delivered;
+}
+} // namespace
+
+class MultiProducerEmitTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.8 multi-producer emit ordering";
+        auto reference = deliverFromThreads(1);
+        if (reference.size() != 4098 || reference[0] != -1 || reference[1] != 0 || reference.back() != -2) {
+            return {name, false, "события lanes должны доставляться там, где lane была получена"};
+        }
+        if (deliverInterleaved(false) != std::vector<std::int64_t>{1, 2, 3, 4} ||
+            deliverInterleaved(true) != std::vector<std::int64_t>{1, 2, 100, 3, 4}) {
+            return {name, false, "события главного потока должны доставляться в порядке публикации"};
+        }
+        for (int threads : {2, 8}) {
+            if (deliverFromThreads(threads) != reference) {
+                return {name, false, "порядок доставки зависит от числа потоков: " + std::to_string(threads)};
+            }
+        }
+
+        return {name, true, "порядок доставки совпадает для 1, 2 и 8 потоков-производителей"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeMultiProducerEmitTest() {
+    return std::make_unique<MultiProducerEmitTest>();
+}
+
+} // namespace ecosim_integration
@@ -0,0 +1,75 @@
+#include "integration/test_framework.h"
+
+#include "core/event_bus.h"
+#include "core/thread_pool.h"
+
+#include <memory>
+#include <thread>
+
+namespace ecosim_integration {
+
+class ParallelDispatchTest : public IIntegrationTest {
+public:
+    TestResult run() override {
+        const std::string name = "5.4.9 parallel subscriber dispatch";
+        constexpr int kEvents = 2000;
+        constexpr int kSubscribers = 4;
+
+        ecosim::ThreadPool pool;
+        pool.start(4);
+        ecosim::EventBus bus;
+        bus.setDispatchPool(&pool);
+        auto type = bus.typeId("test.item");
+        auto other = bus.typeId("test.other");
+        auto item_field = bus.fieldId("item");
+
+        std::vector<std::vector<std::int64_t>> streams(kSubscribers + 1);
+        ecosim::SubscribeOptions thread_safe;
+        thread_safe.thread_safe = true;
+        for (int s = 0; s < kSubscribers; ++s) {
+            bus.subscribe(type, [&streams, s, item_field](const ecosim::TypedEvent &event) {
+                if (s == 0) {
+                    std::this_thread::yield();
+                }
+                streams[s].push_back(event.find(item_field)->value.asInt());
+            }, thread_safe);
+        }
+        bus.subscribe(type, [&streams, item_field](const ecosim::TypedEvent &event) {
+            streams[kSubscribers].push_back(event.find(item_field)->value.asInt());
+        });
+
+        for (int tick = 1; tick <= 2; ++tick) {
+            for (int i = 0; i < kEvents; ++i) {
+                ecosim::TypedEvent event;
+                event.type = (i % 3 == 0) ? other : type;
+                event.tick = tick;
+                event.add(item_field, ecosim::EventValue::ofInt(tick * kEvents + i));
+                bus.emit(std::move(event));
+            }
+            bus.deliverBuffered();
+
+            std::vector<std::int64_t> expected;
+            for (int t = 1; t <= tick; ++t) {
+                for (int i = 0; i < kEvents; ++i) {
+                    if (i % 3 != 0) {
+                        expected.push_back(t * kEvents + i);
+                    }
+                }
+            }
+            for (const auto &stream : streams) {
+                if (stream != expected) {
+                    return {name, false, "поток событий подписчика неполон или нарушен порядок после тика " +
+                                             std::to_string(tick)};
+                }
+            }
+        }
+
+        return {name, true, "параллельные подписчики получают упорядоченные потоки, доставка ждёт всех"};
+    }
+};
+
+std::unique_ptr<IIntegrationTest> makeParallelDispatchTest() {
+    return std::make_unique<ParallelDispatchTest>();
+}
+
+} // namespace ecosim_integration
@@ -10,6 +10,28 @@ std::unique_ptr<IIntegrationTest> makeEventBufferingTest();
 std::unique_ptr<IIntegrationTest> makeStopConditionTest();
 std::unique_ptr<IIntegrationTest> makeRecorderIsolationTest();
 std::unique_ptr<IIntegrationTest> makeReproducibilityTest();
+std::unique_ptr<IIntegrationTest> makeTypedEventsTest();
+std::unique_ptr<IIntegrationTest> makeMultiProducerEmitTest();
+std::unique_ptr<IIntegrationTest> makeParallelDispatchTest();
+std::unique_ptr<IIntegrationTest> makeSubscriptionFiltersTest();
+std::unique_ptr<IIntegrationTest> makeBoundedBuffersTest();
+std::unique_ptr<IIntegrationTest> makeAgentStorageTest();
+std::unique_ptr<IIntegrationTest> makeSpatialIndexTest();
+std::unique_ptr<IIntegrationTest> makeSimdKernelsTest();
+std::unique_ptr<IIntegrationTest> makeThreadedTickTest();
+std::unique_ptr<IIntegrationTest> makeCounterRngTest();
+std::unique_ptr<IIntegrationTest> makeSpeciesRegistryTest();
+std::unique_ptr<IIntegrationTest> makeIncrementalAggregatesTest();
+std::unique_ptr<IIntegrationTest> makeTypedCommandsTest();
+std::unique_ptr<IIntegrationTest> makeChecksumStreamTest();
+std::unique_ptr<IIntegrationTest> makeSnapshotRestoreTest();
+std::unique_ptr<IIntegrationTest> makeWorldForkTest();
+std::unique_ptr<IIntegrationTest> makePopulationOdeTest();
+std::unique_ptr<IIntegrationTest> makeResourceFieldTest();
+std::unique_ptr<IIntegrationTest> makeReadModelSnapshotsTest();
+std::unique_ptr<IIntegrationTest> makeAgentBehaviorTest();
+std::unique_ptr<IIntegrationTest> makeBehaviorRulesTest();
+std::unique_ptr<IIntegrationTest> makeFlowFieldsTest();
 
 std::vector<std::unique_ptr<IIntegrationTest>> buildIntegrationTests() {
     std::vector<std::unique_ptr<IIntegrationTest>> tests;
@@ -19,6 +41,28 @@ std::vector<std::unique_ptr<IIntegrationTest>> buildIntegrationTests() {
     tests.push_back(makeStopConditionTest());
     tests.push_back(makeRecorderIsolationTest());
     tests.push_back(makeReproducibilityTest());
+    tests.push_back(makeTypedEventsTest());
+    tests.push_back(makeMultiProducerEmitTest());
+    tests.push_back(makeParallelDispatchTest());
+    tests.push_back(makeSubscriptionFiltersTest());
+    tests.push_back(makeBoundedBuffersTest());
+    tests.push_back(makeAgentStorageTest());
+    tests.push_back(makeSpatialIndexTest());
+    tests.push_back(makeSimdKernelsTest());
+    tests.push_back(makeThreadedTickTest());
+    tests.push_back(makeCounterRngTest());
+    tests.push_back(makeSpeciesRegistryTest());
+    tests.push_back(makeIncrementalAggregatesTest());
+    tests.push_back(makeTypedCommandsTest());
+    tests.push_back(makeChecksumStreamTest());
+    tests.push_back(makeSnapshotRestoreTest());
+    tests.push_back(makeWorldForkTest());
+    tests.push_back(makePopulationOdeTest());
+    tests.push_back(makeResourceFieldTest());
+    tests.push_back(makeReadModelSnapshotsTest());
+    tests.push_back(makeAgentBehaviorTest());
+    tests.push_back(makeBehaviorRulesTest());
+    tests.push_back(makeFlowFieldsTest());
     return tests;
 }
 
@@ -188,4 +188,26 @@ bool containsText(const std::string &log, const std::string &needle) {
     return log.find(needle) != std::string::npos;
 }
 
+WorldHarness::WorldHarness(const std::map<std::string, std::string> &params, std::size_t threads,
+                           const ecosim::AppConfig &app_config)
+    : config(app_config), world({"simulation_world", "default", true, params}, context) {
+    if (threads > 0) {
+        pool.start(threads);
+    }
+    world.onInit();
+}
+
+void WorldHarness::tick(std::initializer_list<ecosim::IModule *> modules) {
+    world.onPreTick();
+    for (auto module : modules) {
+        module->onPreTick();
+    }
+    world.onTick();
+    for (auto module : modules) {
+        module->onTick();
+    }
+    bus.clear();
+    arena.nextTick();
+}
+
 } // namespace ecosim_integration
@@ -2,8 +2,11 @@
 
 #include "core/app.h"
 #include "core/logger.h"
+#include "modules/simulation_world.h"
 
+#include <cstddef>
 #include <filesystem>
+#include <initializer_list>
 #include <map>
 #include <sstream>
 #include <string>
@@ -36,4 +39,27 @@ std::filesystem::path writeAppConfigFile(const std::string &file_name,
 
 bool containsText(const std::string &log, const std::string &needle);
 
+// A SimulationWorld with its own logger, bus, pool and tick arena, initialized and ready for commands.
+// `threads` = 0 leaves the pool unstarted, so parallel work runs inline.
+struct WorldHarness {
+    explicit WorldHarness(const std::map<std::string, std::string> &params = {}, std::size_t threads = 0,
+                          const ecosim::AppConfig &app_config = {});
+    WorldHarness(const WorldHarness &) = delete;
+    WorldHarness &operator=(const WorldHarness &) = delete;
+
+    // One tick in the phase order of Application::runHeadless: onPreTick of the world and then of
+    // `modules`, onTick likewise; the tick's events are dropped.
+    void tick(std::initializer_list<ecosim::IModule *> modules = {});
+    std::string log() const { return log_stream.str(); }
+
+    std::ostringstream log_stream;
+    ecosim::Logger logger{log_stream};
+    ecosim::EventBus bus;
+    ecosim::AppConfig config;
+    ecosim::ThreadPool pool;
+    ecosim::TickArena arena;
+    ecosim::ModuleContext context{logger, bus, config, pool, arena};
+    ecosim::SimulationWorld world;
+};
+
 } // namespace ecosim_integration